@@ -0,0 +1,20 @@
+// Package inprocess - движок оптимизации в процессе API без gRPC: для
+// размещения на одном хосте, где транспорт дороже самой оптимизации.
+// Собирается с тегом inprocess и требует cgo и библиотеку nelder_mead,
+// как сервис оптимизации; без тега Open возвращает ErrDisabled.
+package inprocess
+
+import (
+	"awesomeProject2/api/core"
+	"errors"
+)
+
+var ErrDisabled = errors.New("api is built without the inprocess tag")
+
+type Backend interface {
+	core.Optimizator
+	core.BatchOptimizator
+	core.JobOptimizator
+	core.IslandOptimizator
+	core.Pinger
+}
@@ -0,0 +1,9 @@
+//go:build !inprocess
+
+package inprocess
+
+import "log/slog"
+
+func Open(string, *slog.Logger) (Backend, func(), error) {
+	return nil, nil, ErrDisabled
+}
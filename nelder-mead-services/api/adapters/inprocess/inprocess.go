@@ -0,0 +1,183 @@
+//go:build inprocess
+
+package inprocess
+
+import (
+	"awesomeProject2/api/core"
+	"awesomeProject2/optimization/adapters/joblog"
+	"awesomeProject2/optimization/config"
+	optimization "awesomeProject2/optimization/core"
+	"context"
+	"errors"
+	"fmt"
+	"log/slog"
+
+	"github.com/ilyakaznacheev/cleanenv"
+)
+
+type Engine struct {
+	service *optimization.Service
+}
+
+var _ Backend = (*Engine)(nil)
+
+func New(service *optimization.Service) *Engine {
+	return &Engine{service: service}
+}
+
+// Open запускает движок с настройками из файла конфигурации сервиса
+// оптимизации, пустой путь - настройки по умолчанию
+func Open(configPath string, log *slog.Logger) (Backend, func(), error) {
+	var cfg config.Config
+	if configPath != "" {
+		cfg = config.MustLoad(configPath)
+	} else if err := cleanenv.ReadEnv(&cfg); err != nil {
+		return nil, nil, err
+	}
+
+	var jobs optimization.JobLog
+	var jobLog *joblog.Log
+	if cfg.JobLogPath != "" {
+		var err error
+		if jobLog, err = joblog.Open(cfg.JobLogPath); err != nil {
+			return nil, nil, fmt.Errorf("failed to open job log: %v", err)
+		}
+		jobs = jobLog
+	}
+
+	service, err := optimization.NewService(log, optimization.Options{
+		CacheEntries:        cfg.CacheEntries,
+		CacheNodes:          cfg.CacheNodes,
+		Polish:              cfg.Polish,
+		SearchRadius:        cfg.SearchRadius,
+		RacingStarts:        cfg.RacingStarts,
+		ScreenSamples:       cfg.ScreenSamples,
+		ScreenStarts:        cfg.ScreenStarts,
+		Workers:             cfg.Workers,
+		PinThreads:          cfg.PinThreads,
+		QueueLimit:          cfg.QueueLimit,
+		MaxJobCost:          cfg.MaxJobCost,
+		DeferCost:           cfg.DeferCost,
+		TimeSlice:           cfg.TimeSlice,
+		BatchWindow:         cfg.BatchWindow,
+		BatchSize:           cfg.BatchSize,
+		ProgressInterval:    cfg.ProgressInterval,
+		Jobs:                jobs,
+		JobRetention:        cfg.JobRetention,
+		JobSnapshotInterval: cfg.JobSnapshotInterval,
+	})
+	if err != nil {
+		if jobLog != nil {
+			jobLog.Close()
+		}
+		return nil, nil, err
+	}
+	return New(service), func() {
+		service.Close()
+		if jobLog != nil {
+			jobLog.Close()
+		}
+	}, nil
+}
+
+func (e *Engine) Ping(context.Context) error {
+	return nil
+}
+
+func (e *Engine) Optimization(ctx context.Context, function string, tolerance float64, maxIter int) (core.OptimizationReplay, error) {
+	replay, err := e.service.Optimization(ctx, makeQuery(function, tolerance, maxIter))
+	if err != nil {
+		return core.OptimizationReplay{}, err
+	}
+	return makeReplay(replay), nil
+}
+
+func (e *Engine) OptimizationBatch(ctx context.Context, tasks []core.OptimizationTask, report func(core.BatchResult)) error {
+	queries := make([]optimization.OptimizationQuery, len(tasks))
+	for i, task := range tasks {
+		queries[i] = makeQuery(task.Function, task.Tolerance, task.MaxIter)
+		queries[i].Priority = optimization.PriorityBatch
+	}
+	e.service.OptimizationBatch(ctx, queries, func(index int, replay optimization.OptimizationReplay, err error) {
+		result := core.BatchResult{Index: index}
+		if err != nil {
+			result.Err = err.Error()
+		} else {
+			result.Replay = makeReplay(replay)
+		}
+		report(result)
+	})
+	return nil
+}
+
+func (e *Engine) SubmitJob(_ context.Context, task core.OptimizationTask) (core.Job, error) {
+	return makeJob(e.service.SubmitJob(makeQuery(task.Function, task.Tolerance, task.MaxIter)))
+}
+
+func (e *Engine) Job(_ context.Context, id string) (core.Job, error) {
+	return makeJob(e.service.Job(id))
+}
+
+func (e *Engine) CancelJob(_ context.Context, id string) (core.Job, error) {
+	return makeJob(e.service.CancelJob(id))
+}
+
+// Islands выполняет все запуски одним островом: в процессе API экземпляр
+// один, и обмениваться точками не с кем
+func (e *Engine) Islands(ctx context.Context, task core.IslandTask) (core.IslandResult, error) {
+	var final optimization.IslandReport
+	err := e.service.Island(ctx, optimization.IslandTask{
+		Query:   makeQuery(task.Function, task.Tolerance, task.MaxIter),
+		Islands: 1,
+		Starts:  task.Starts,
+		Seed:    task.Seed,
+		Radius:  task.Radius,
+	}, nil, func(report optimization.IslandReport) {
+		final = report
+	})
+	if err != nil {
+		return core.IslandResult{}, err
+	}
+	if final.Best.Names == nil {
+		return core.IslandResult{}, optimization.ErrOptimizationFailed
+	}
+	replay := core.OptimizationReplay{Variable: make([]core.Variable, len(final.Best.Names)), FunctionValue: final.Best.Value}
+	for i, name := range final.Best.Names {
+		replay.Variable[i] = core.Variable{Name: name, Value: int64(final.Best.Point[i])}
+	}
+	return core.IslandResult{Replay: replay, Starts: final.Starts, Islands: 1}, nil
+}
+
+func makeQuery(function string, tolerance float64, maxIter int) optimization.OptimizationQuery {
+	return optimization.OptimizationQuery{Function: function, Tolerance: tolerance, MaxIter: int64(maxIter)}
+}
+
+func makeReplay(replay optimization.OptimizationReplay) core.OptimizationReplay {
+	variable := make([]core.Variable, 0, len(replay.Variable))
+	for _, item := range replay.Variable {
+		variable = append(variable, core.Variable{Name: item.Name, Value: item.Value})
+	}
+	return core.OptimizationReplay{Variable: variable, FunctionValue: replay.FunctionValue}
+}
+
+func makeJob(job optimization.JobStatus, err error) (core.Job, error) {
+	if errors.Is(err, optimization.ErrJobNotFound) {
+		return core.Job{}, core.ErrJobNotFound
+	}
+	if err != nil {
+		return core.Job{}, err
+	}
+	result := core.Job{
+		ID:          job.ID,
+		State:       string(job.State),
+		Iteration:   job.Progress.Iteration,
+		BestValue:   job.Progress.BestValue,
+		Evaluations: job.Progress.Evaluations,
+		Err:         job.Error,
+	}
+	if job.State == optimization.JobDone || job.State == optimization.JobCancelled && len(job.Replay.Variable) > 0 {
+		replay := makeReplay(job.Replay)
+		result.Replay = &replay
+	}
+	return result, nil
+}
@@ -0,0 +1,104 @@
+//go:build inprocess
+
+package inprocess
+
+import (
+	client "awesomeProject2/api/adapters/optimization"
+	apicore "awesomeProject2/api/core"
+	grpcserver "awesomeProject2/optimization/adapters/grpc"
+	optimization "awesomeProject2/optimization/core"
+	__ "awesomeProject2/proto/optimizator"
+	"context"
+	"fmt"
+	"io"
+	"log/slog"
+	"net"
+	"os"
+	"os/exec"
+	"path/filepath"
+	"testing"
+	"time"
+
+	"google.golang.org/grpc"
+)
+
+// islandServeEnv - адрес unix-сокета: тестовый бинарник, запущенный с этой
+// переменной, работает экземпляром сервиса оптимизации до закрытия stdin
+const islandServeEnv = "INPROCESS_TEST_SERVE"
+
+func TestMain(m *testing.M) {
+	if address := os.Getenv(islandServeEnv); address != "" {
+		serveInstance(address)
+		return
+	}
+	os.Exit(m.Run())
+}
+
+func serveInstance(address string) {
+	log := slog.New(slog.NewTextHandler(io.Discard, nil))
+	service, err := optimization.NewService(log, optimization.Options{Workers: 2})
+	if err != nil {
+		fmt.Fprintln(os.Stderr, err)
+		os.Exit(1)
+	}
+	defer service.Close()
+	listener, err := net.Listen("unix", address)
+	if err != nil {
+		fmt.Fprintln(os.Stderr, err)
+		os.Exit(1)
+	}
+	s := grpc.NewServer()
+	__.RegisterOptimizationServer(s, grpcserver.NewServer(service))
+	go s.Serve(listener)
+	io.Copy(io.Discard, os.Stdin)
+	s.Stop()
+}
+
+// TestIslandsProcesses - острова в отдельных процессах на одном хосте:
+// пул API координирует их по unix-сокетам
+func TestIslandsProcesses(t *testing.T) {
+	const instances = 3
+	dir := t.TempDir()
+	addresses := make([]string, instances)
+	for i := range addresses {
+		socket := filepath.Join(dir, fmt.Sprintf("island%d.sock", i))
+		cmd := exec.Command(os.Args[0], "-test.run=^$")
+		cmd.Env = append(os.Environ(), islandServeEnv+"="+socket)
+		cmd.Stderr = os.Stderr
+		stdin, err := cmd.StdinPipe()
+		if err != nil {
+			t.Fatal(err)
+		}
+		if err := cmd.Start(); err != nil {
+			t.Fatal(err)
+		}
+		t.Cleanup(func() {
+			stdin.Close()
+			cmd.Wait()
+		})
+		for start := time.Now(); ; time.Sleep(10 * time.Millisecond) {
+			if _, err := os.Stat(socket); err == nil {
+				break
+			}
+			if time.Since(start) > 10*time.Second {
+				t.Fatalf("instance %d did not start", i)
+			}
+		}
+		addresses[i] = "unix://" + socket
+	}
+
+	pool, err := client.NewPool(addresses, slog.New(slog.NewTextHandler(io.Discard, nil)))
+	if err != nil {
+		t.Fatal(err)
+	}
+	// Минимумы у x1 = 10 (значение -100) и у x1 = 1 (значение 0): из
+	// единиц метод находит только второй
+	task := apicore.IslandTask{Function: "(x1-1)^2*(x1-10)^2-x1^2+(x2-3)^2", Tolerance: 1e-10, MaxIter: 2000, Starts: 30, Radius: 12, Seed: 7}
+	result, err := pool.Islands(context.Background(), task)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if result.Islands != instances || result.Starts == 0 || result.Replay.FunctionValue > -99 {
+		t.Errorf("islands result %+v", result)
+	}
+}
@@ -0,0 +1,71 @@
+//go:build inprocess
+
+package inprocess
+
+import (
+	client "awesomeProject2/api/adapters/optimization"
+	apicore "awesomeProject2/api/core"
+	grpcserver "awesomeProject2/optimization/adapters/grpc"
+	optimization "awesomeProject2/optimization/core"
+	__ "awesomeProject2/proto/optimizator"
+	"context"
+	"io"
+	"log/slog"
+	"net"
+	"path/filepath"
+	"testing"
+
+	"google.golang.org/grpc"
+)
+
+// BenchmarkTransport сравнивает задержку одного запроса к одному и тому же
+// сервису по TCP, через unix-сокет и вызовом в процессе
+func BenchmarkTransport(b *testing.B) {
+	log := slog.New(slog.NewTextHandler(io.Discard, nil))
+	service, err := optimization.NewService(log, optimization.Options{})
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer service.Close()
+
+	serve := func(network, address string) string {
+		listener, err := net.Listen(network, address)
+		if err != nil {
+			b.Fatal(err)
+		}
+		s := grpc.NewServer()
+		__.RegisterOptimizationServer(s, grpcserver.NewServer(service))
+		go s.Serve(listener)
+		b.Cleanup(s.Stop)
+		if network == "unix" {
+			return "unix://" + address
+		}
+		return listener.Addr().String()
+	}
+	dial := func(address string) apicore.Optimizator {
+		c, err := client.NewClient(address, log)
+		if err != nil {
+			b.Fatal(err)
+		}
+		return c
+	}
+
+	cases := []struct {
+		name   string
+		engine apicore.Optimizator
+	}{
+		{"tcp", dial(serve("tcp", "127.0.0.1:0"))},
+		{"unix", dial(serve("unix", filepath.Join(b.TempDir(), "optimization.sock")))},
+		{"inprocess", New(service)},
+	}
+	for _, c := range cases {
+		b.Run(c.name, func(b *testing.B) {
+			ctx := context.Background()
+			for i := 0; i < b.N; i++ {
+				if _, err := c.engine.Optimization(ctx, "(x1-1)^2+(x2-2)^2", 1e-6, 200); err != nil {
+					b.Fatal(err)
+				}
+			}
+		})
+	}
+}
@@ -0,0 +1,187 @@
+package optimization
+
+import (
+	"awesomeProject2/api/core"
+	__ "awesomeProject2/proto/optimizator"
+	"context"
+	"errors"
+	"io"
+	"math"
+	"sync"
+	"time"
+)
+
+// Обмен лучшими точками между островами раз в islandExchange. Остров
+// снимается, если, выполнив не меньше islandMinStarts запусков, он
+// islandPatience обменов подряд хуже лучшего острова больше чем на
+// islandPruneGap * (1 + |лучшее значение|) и за это время не улучшился.
+const (
+	islandExchange  = 200 * time.Millisecond
+	islandPatience  = 3
+	islandMinStarts = 2
+	islandPruneGap  = 0.1
+)
+
+// islandState - остров глазами координатора
+type islandState struct {
+	backend *backend
+	stream  __.Optimization_IslandClient
+	cancel  context.CancelFunc
+	best    *__.IslandPoint
+	starts  int
+	behind  int // Обменов подряд, на которых остров отстает
+	active  bool
+	pruned  bool
+}
+
+type islandEvent struct {
+	island int
+	report *__.IslandReport
+	err    error
+}
+
+// Islands делит запуски между доступными экземплярами и координирует их:
+// рассылает отстающим островам лучшую точку и снимает острова, которые
+// заметно и устойчиво проигрывают
+func (p *Pool) Islands(ctx context.Context, task core.IslandTask) (core.IslandResult, error) {
+	var backends []*backend
+	usable := p.router.usable()
+	for _, b := range p.router.backends {
+		if usable(b) {
+			backends = append(backends, b)
+		}
+	}
+
+	ctx, cancel := context.WithCancel(ctx)
+	events := make(chan islandEvent)
+	var wg sync.WaitGroup
+	defer func() {
+		cancel()
+		wg.Wait()
+	}()
+
+	islands := make([]*islandState, len(backends))
+	for i, b := range backends {
+		islandCtx, islandCancel := context.WithCancel(ctx)
+		stream, err := b.client.client.Island(islandCtx)
+		if err == nil {
+			err = stream.Send(&__.IslandMessage{Task: &__.IslandTask{
+				Problem: &__.OptimizationRequest{Function: task.Function, Tolerance: task.Tolerance, MaxIter: int64(task.MaxIter)},
+				Island:  int32(i),
+				Islands: int32(len(backends)),
+				Starts:  int32(task.Starts),
+				Seed:    task.Seed,
+				Radius:  task.Radius,
+			}})
+		}
+		if err != nil {
+			islandCancel()
+			p.observe(b, err)
+			return core.IslandResult{}, err
+		}
+		islands[i] = &islandState{backend: b, stream: stream, cancel: islandCancel, active: true}
+
+		b.outstanding.Add(1)
+		wg.Add(1)
+		go func(i int, b *backend, stream __.Optimization_IslandClient) {
+			defer wg.Done()
+			defer b.outstanding.Add(-1)
+			for {
+				report, err := stream.Recv()
+				select {
+				case events <- islandEvent{island: i, report: report, err: err}:
+				case <-ctx.Done():
+					return
+				}
+				if err != nil {
+					return
+				}
+			}
+		}(i, b, stream)
+	}
+
+	ticker := time.NewTicker(islandExchange)
+	defer ticker.Stop()
+	result := core.IslandResult{Islands: len(islands)}
+	var leader *islandState
+	var failure error
+	for active := len(islands); active > 0; {
+		select {
+		case <-ctx.Done():
+			return core.IslandResult{}, ctx.Err()
+		case <-ticker.C:
+			active -= p.exchange(islands, leader)
+		case event := <-events:
+			is := islands[event.island]
+			if !is.active {
+				continue
+			}
+			if event.err != nil {
+				// Остров завершается потоком EOF после итогового отчета
+				is.active = false
+				active--
+				if !errors.Is(event.err, io.EOF) {
+					failure = p.observe(is.backend, event.err)
+					p.log.Info("island failed", "address", is.backend.address, "error", event.err)
+				}
+				continue
+			}
+			is.starts = int(event.report.GetStarts())
+			if best := event.report.GetBest(); len(best.GetNames()) > 0 && (is.best == nil || best.GetValue() < is.best.GetValue()) {
+				is.best, is.behind = best, 0
+				if leader == nil || best.GetValue() < leader.best.GetValue() {
+					leader = is
+				}
+			}
+		}
+	}
+
+	for _, is := range islands {
+		result.Starts += is.starts
+		if is.pruned {
+			result.Pruned++
+		}
+	}
+	if leader == nil {
+		if failure == nil {
+			failure = errors.New("no island found a solution")
+		}
+		return core.IslandResult{}, failure
+	}
+	best := leader.best
+	result.Replay = core.OptimizationReplay{Variable: make([]core.Variable, len(best.GetNames())), FunctionValue: best.GetValue()}
+	for i, name := range best.GetNames() {
+		result.Replay.Variable[i] = core.Variable{Name: name, Value: int64(best.GetPoint()[i])}
+	}
+	return result, nil
+}
+
+// exchange отправляет лучшую точку отстающим островам и снимает
+// безнадежные, возвращает число снятых
+func (p *Pool) exchange(islands []*islandState, leader *islandState) int {
+	if leader == nil {
+		return 0
+	}
+	best := leader.best.GetValue()
+	pruned := 0
+	for _, is := range islands {
+		if !is.active || is == leader {
+			continue
+		}
+		if is.best == nil || is.best.GetValue() > best {
+			// Ошибка отправки придет в поток острова следующим Recv
+			is.stream.Send(&__.IslandMessage{Migrant: leader.best})
+		}
+		if is.starts < islandMinStarts || is.best != nil && is.best.GetValue()-best <= islandPruneGap*(1+math.Abs(best)) {
+			is.behind = 0
+			continue
+		}
+		if is.behind++; is.behind >= islandPatience {
+			p.log.Debug("island pruned", "address", is.backend.address, "starts", is.starts)
+			is.cancel()
+			is.active, is.pruned = false, true
+			pruned++
+		}
+	}
+	return pruned
+}
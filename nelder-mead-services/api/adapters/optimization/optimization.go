@@ -4,9 +4,13 @@ import (
 	"awesomeProject2/api/core"
 	__ "awesomeProject2/proto/optimizator"
 	"context"
+	"errors"
 	"google.golang.org/grpc"
+	"google.golang.org/grpc/codes"
 	"google.golang.org/grpc/credentials/insecure"
+	"google.golang.org/grpc/status"
 	"google.golang.org/protobuf/types/known/emptypb"
+	"io"
 	"log/slog"
 )
 
@@ -37,10 +41,74 @@ func (c Client) Optimization(ctx context.Context, function string, tolerance flo
 		return core.OptimizationReplay{}, err
 	}
 
+	return makeReplay(reply), nil
+}
+
+func (c Client) OptimizationBatch(ctx context.Context, tasks []core.OptimizationTask, report func(core.BatchResult)) error {
+	request := &__.BatchRequest{Problems: make([]*__.OptimizationRequest, len(tasks))}
+	for i, task := range tasks {
+		request.Problems[i] = &__.OptimizationRequest{Function: task.Function, Tolerance: task.Tolerance, MaxIter: int64(task.MaxIter)}
+	}
+
+	stream, err := c.client.OptimizeBatch(ctx, request)
+	if err != nil {
+		return err
+	}
+	for {
+		result, err := stream.Recv()
+		if errors.Is(err, io.EOF) {
+			return nil
+		}
+		if err != nil {
+			return err
+		}
+		batchResult := core.BatchResult{Index: int(result.GetIndex()), Err: result.GetError()}
+		if result.GetError() == "" {
+			batchResult.Replay = makeReplay(result.GetReply())
+		}
+		report(batchResult)
+	}
+}
+
+func (c Client) SubmitJob(ctx context.Context, task core.OptimizationTask) (core.Job, error) {
+	return makeJob(c.client.SubmitJob(ctx, &__.OptimizationRequest{Function: task.Function, Tolerance: task.Tolerance, MaxIter: int64(task.MaxIter)}))
+}
+
+func (c Client) Job(ctx context.Context, id string) (core.Job, error) {
+	return makeJob(c.client.GetJob(ctx, &__.JobRequest{Id: id}))
+}
+
+func (c Client) CancelJob(ctx context.Context, id string) (core.Job, error) {
+	return makeJob(c.client.CancelJob(ctx, &__.JobRequest{Id: id}))
+}
+
+func makeJob(job *__.JobStatus, err error) (core.Job, error) {
+	if status.Code(err) == codes.NotFound {
+		return core.Job{}, core.ErrJobNotFound
+	}
+	if err != nil {
+		return core.Job{}, err
+	}
+	result := core.Job{
+		ID:          job.GetId(),
+		State:       job.GetState(),
+		Iteration:   job.GetIteration(),
+		BestValue:   job.GetBestValue(),
+		Evaluations: job.GetEvaluations(),
+		Err:         job.GetError(),
+	}
+	if job.GetResult() != nil {
+		replay := makeReplay(job.GetResult())
+		result.Replay = &replay
+	}
+	return result, nil
+}
+
+func makeReplay(reply *__.OptimizationReply) core.OptimizationReplay {
 	variable := make([]core.Variable, 0)
-	for _, item := range reply.Variable {
+	for _, item := range reply.GetVariable() {
 		variable = append(variable, core.Variable{Name: item.Name, Value: item.Value})
 	}
 
-	return core.OptimizationReplay{Variable: variable, FunctionValue: reply.GetFunctionValue()}, nil
+	return core.OptimizationReplay{Variable: variable, FunctionValue: reply.GetFunctionValue()}
 }
@@ -0,0 +1,154 @@
+package optimization
+
+import (
+	"awesomeProject2/api/core"
+	"context"
+	"errors"
+	"fmt"
+	"google.golang.org/grpc/codes"
+	"google.golang.org/grpc/status"
+	"log/slog"
+	"strings"
+	"time"
+)
+
+// Pool - клиент нескольких экземпляров сервиса оптимизации. Доступность
+// экземпляров проверяется через Ping (Watch) и по отказам вызовов.
+// id фоновой задачи дополняется меткой экземпляра: опрос и отмена
+// уходят туда, где задача создана.
+type Pool struct {
+	log    *slog.Logger
+	router *router
+}
+
+func NewPool(addresses []string, log *slog.Logger) (*Pool, error) {
+	if len(addresses) == 0 {
+		return nil, errors.New("no optimization addresses")
+	}
+	backends := make([]*backend, len(addresses))
+	for i, address := range addresses {
+		client, err := NewClient(address, log)
+		if err != nil {
+			return nil, fmt.Errorf("optimization instance %s: %w", address, err)
+		}
+		backends[i] = &backend{address: address, tag: backendTag(address), client: client}
+		backends[i].healthy.Store(true)
+	}
+	return &Pool{log: log, router: newRouter(backends)}, nil
+}
+
+// Watch проверяет экземпляры каждые interval до отмены ctx
+func (p *Pool) Watch(ctx context.Context, interval time.Duration) {
+	ticker := time.NewTicker(interval)
+	defer ticker.Stop()
+	for {
+		select {
+		case <-ctx.Done():
+			return
+		case <-ticker.C:
+		}
+		for _, b := range p.router.backends {
+			pingCtx, cancel := context.WithTimeout(ctx, interval)
+			err := b.client.Ping(pingCtx)
+			cancel()
+			if healthy := err == nil; b.healthy.Swap(healthy) != healthy {
+				p.log.Info("optimization instance health changed", "address", b.address, "healthy", healthy, "error", err)
+			}
+		}
+	}
+}
+
+// call выполняет запрос на экземпляре b, учитывая его в нагрузке.
+// Недоступный экземпляр исключается до следующей проверки Watch.
+func (p *Pool) call(b *backend, f func(*Client) error) error {
+	b.outstanding.Add(1)
+	defer b.outstanding.Add(-1)
+	return p.observe(b, f(b.client))
+}
+
+// observe исключает экземпляр b, если ошибка err говорит о его недоступности
+func (p *Pool) observe(b *backend, err error) error {
+	if status.Code(err) == codes.Unavailable && b.healthy.Swap(false) {
+		p.log.Info("optimization instance unavailable", "address", b.address, "error", err)
+	}
+	return err
+}
+
+// Ping успешен, если отвечает хотя бы один экземпляр
+func (p *Pool) Ping(ctx context.Context) error {
+	var err error
+	for _, b := range p.router.backends {
+		if err = b.client.Ping(ctx); err == nil {
+			return nil
+		}
+	}
+	return err
+}
+
+// Optimization повторяется на другом экземпляре, если выбранный недоступен
+func (p *Pool) Optimization(ctx context.Context, function string, tolerance float64, maxIter int) (core.OptimizationReplay, error) {
+	key := routingKey(function)
+	var replay core.OptimizationReplay
+	var err error
+	for attempt := 0; attempt < min(2, len(p.router.backends)); attempt++ {
+		err = p.call(p.router.pick(key), func(c *Client) (err error) {
+			replay, err = c.Optimization(ctx, function, tolerance, maxIter)
+			return err
+		})
+		if status.Code(err) != codes.Unavailable {
+			break
+		}
+	}
+	return replay, err
+}
+
+// OptimizationBatch целиком уходит наименее загруженному экземпляру
+func (p *Pool) OptimizationBatch(ctx context.Context, tasks []core.OptimizationTask, report func(core.BatchResult)) error {
+	return p.call(p.router.least(), func(c *Client) error {
+		return c.OptimizationBatch(ctx, tasks, report)
+	})
+}
+
+func (p *Pool) SubmitJob(ctx context.Context, task core.OptimizationTask) (core.Job, error) {
+	b := p.router.pick(routingKey(task.Function))
+	var job core.Job
+	err := p.call(b, func(c *Client) (err error) {
+		job, err = c.SubmitJob(ctx, task)
+		return err
+	})
+	if err != nil {
+		return core.Job{}, err
+	}
+	job.ID = b.tag + "." + job.ID
+	return job, nil
+}
+
+func (p *Pool) Job(ctx context.Context, id string) (core.Job, error) {
+	return p.jobCall(id, func(c *Client, id string) (core.Job, error) {
+		return c.Job(ctx, id)
+	})
+}
+
+func (p *Pool) CancelJob(ctx context.Context, id string) (core.Job, error) {
+	return p.jobCall(id, func(c *Client, id string) (core.Job, error) {
+		return c.CancelJob(ctx, id)
+	})
+}
+
+func (p *Pool) jobCall(id string, f func(*Client, string) (core.Job, error)) (core.Job, error) {
+	tag, local, ok := strings.Cut(id, ".")
+	b := p.router.byTag(tag)
+	if !ok || b == nil {
+		return core.Job{}, core.ErrJobNotFound
+	}
+	var job core.Job
+	err := p.call(b, func(c *Client) (err error) {
+		job, err = f(c, local)
+		return err
+	})
+	if err != nil {
+		return core.Job{}, err
+	}
+	job.ID = id
+	return job, nil
+}
@@ -0,0 +1,184 @@
+package optimization
+
+import (
+	"awesomeProject2/api/core"
+	__ "awesomeProject2/proto/optimizator"
+	"context"
+	"fmt"
+	"google.golang.org/grpc"
+	"google.golang.org/protobuf/types/known/emptypb"
+	"io"
+	"log/slog"
+	"net"
+	"sync"
+	"testing"
+	"time"
+)
+
+// fakeInstance - экземпляр сервиса оптимизации на loopback, отвечает
+// своим номером в FunctionValue
+type fakeInstance struct {
+	__.UnimplementedOptimizationServer
+	index    int
+	server   *grpc.Server
+	mu       sync.Mutex
+	jobs     map[string]bool
+	migrants int
+}
+
+func (f *fakeInstance) Ping(context.Context, *emptypb.Empty) (*emptypb.Empty, error) {
+	return &emptypb.Empty{}, nil
+}
+
+func (f *fakeInstance) Optimization(context.Context, *__.OptimizationRequest) (*__.OptimizationReply, error) {
+	return &__.OptimizationReply{FunctionValue: float64(f.index)}, nil
+}
+
+func (f *fakeInstance) SubmitJob(context.Context, *__.OptimizationRequest) (*__.JobStatus, error) {
+	f.mu.Lock()
+	defer f.mu.Unlock()
+	id := fmt.Sprintf("job%d", len(f.jobs))
+	f.jobs[id] = true
+	return &__.JobStatus{Id: id, State: "queued"}, nil
+}
+
+func (f *fakeInstance) GetJob(_ context.Context, request *__.JobRequest) (*__.JobStatus, error) {
+	f.mu.Lock()
+	defer f.mu.Unlock()
+	if !f.jobs[request.GetId()] {
+		return nil, fmt.Errorf("job %s is not known to instance %d", request.GetId(), f.index)
+	}
+	return &__.JobStatus{Id: request.GetId(), State: "done", Result: &__.OptimizationReply{FunctionValue: float64(f.index)}}, nil
+}
+
+// Island отчитывается каждые 50 мс значением, равным номеру экземпляра,
+// пока не выполнит 20 запусков или не будет снят
+func (f *fakeInstance) Island(stream __.Optimization_IslandServer) error {
+	if _, err := stream.Recv(); err != nil {
+		return err
+	}
+	go func() {
+		for {
+			message, err := stream.Recv()
+			if err != nil {
+				return
+			}
+			if message.GetMigrant() != nil {
+				f.mu.Lock()
+				f.migrants++
+				f.mu.Unlock()
+			}
+		}
+	}()
+	best := &__.IslandPoint{Names: []string{"x1"}, Point: []float64{float64(f.index)}, Value: float64(f.index)}
+	for starts := 1; starts <= 20; starts++ {
+		select {
+		case <-stream.Context().Done():
+			return stream.Context().Err()
+		case <-time.After(50 * time.Millisecond):
+		}
+		if err := stream.Send(&__.IslandReport{Starts: int32(starts), Best: best, Done: starts == 20}); err != nil {
+			return err
+		}
+	}
+	return nil
+}
+
+func startInstances(t *testing.T, n int) ([]*fakeInstance, []string) {
+	instances := make([]*fakeInstance, n)
+	addresses := make([]string, n)
+	for i := range instances {
+		listener, err := net.Listen("tcp", "127.0.0.1:0")
+		if err != nil {
+			t.Fatal(err)
+		}
+		instances[i] = &fakeInstance{index: i, server: grpc.NewServer(), jobs: make(map[string]bool)}
+		__.RegisterOptimizationServer(instances[i].server, instances[i])
+		go instances[i].server.Serve(listener)
+		t.Cleanup(instances[i].server.Stop)
+		addresses[i] = listener.Addr().String()
+	}
+	return instances, addresses
+}
+
+func TestPoolRouting(t *testing.T) {
+	instances, addresses := startInstances(t, 3)
+	pool, err := NewPool(addresses, slog.New(slog.NewTextHandler(io.Discard, nil)))
+	if err != nil {
+		t.Fatal(err)
+	}
+	ctx := context.Background()
+
+	served := make(map[float64]int)
+	for i := 0; i < 30; i++ {
+		function := fmt.Sprintf("(x1-%d)^2", i)
+		first, err := pool.Optimization(ctx, function, 1e-6, 100)
+		if err != nil {
+			t.Fatal(err)
+		}
+		second, err := pool.Optimization(ctx, function, 1e-6, 100)
+		if err != nil {
+			t.Fatal(err)
+		}
+		if first.FunctionValue != second.FunctionValue {
+			t.Errorf("%s served by instances %v and %v", function, first.FunctionValue, second.FunctionValue)
+		}
+		served[first.FunctionValue]++
+	}
+	if len(served) != len(instances) {
+		t.Errorf("functions spread over %d of %d instances: %v", len(served), len(instances), served)
+	}
+
+	// Опрос задачи уходит экземпляру, который ее создал
+	for i := 0; i < 10; i++ {
+		job, err := pool.SubmitJob(ctx, core.OptimizationTask{Function: fmt.Sprintf("x1^%d", i), Tolerance: 1e-6, MaxIter: 100})
+		if err != nil {
+			t.Fatal(err)
+		}
+		if job, err = pool.Job(ctx, job.ID); err != nil || job.State != "done" {
+			t.Fatalf("job %+v: %v", job, err)
+		}
+	}
+	if _, err := pool.Job(ctx, "unknown.job0"); err != core.ErrJobNotFound {
+		t.Errorf("unknown job: %v", err)
+	}
+
+	// Остановленный экземпляр пропускается: запросы повторяются на других
+	instances[0].server.Stop()
+	for i := 0; i < 30; i++ {
+		replay, err := pool.Optimization(ctx, fmt.Sprintf("(x1-%d)^2", i), 1e-6, 100)
+		if err != nil {
+			t.Fatalf("function %d after instance stop: %v", i, err)
+		}
+		if replay.FunctionValue == 0 {
+			t.Errorf("function %d served by the stopped instance", i)
+		}
+	}
+}
+
+func TestPoolIslands(t *testing.T) {
+	instances, addresses := startInstances(t, 3)
+	pool, err := NewPool(addresses, slog.New(slog.NewTextHandler(io.Discard, nil)))
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	result, err := pool.Islands(context.Background(), core.IslandTask{Function: "x1^2", Tolerance: 1e-6, MaxIter: 100, Starts: 60, Radius: 1})
+	if err != nil {
+		t.Fatal(err)
+	}
+	if result.Replay.FunctionValue != 0 || len(result.Replay.Variable) != 1 {
+		t.Errorf("best island result %+v", result.Replay)
+	}
+	// Острова 1 и 2 отстают на каждом обмене и снимаются, не доработав
+	if result.Islands != 3 || result.Pruned != 2 || result.Starts >= 60 {
+		t.Errorf("islands %d, pruned %d, starts %d", result.Islands, result.Pruned, result.Starts)
+	}
+	for _, instance := range instances[1:] {
+		instance.mu.Lock()
+		if instance.migrants == 0 {
+			t.Errorf("instance %d received no migrants", instance.index)
+		}
+		instance.mu.Unlock()
+	}
+}
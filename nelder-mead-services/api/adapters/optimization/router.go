@@ -0,0 +1,137 @@
+package optimization
+
+import (
+	"hash/fnv"
+	"math"
+	"sort"
+	"strconv"
+	"strings"
+	"sync/atomic"
+)
+
+// ringReplicas - точек кольца на экземпляр: чем больше, тем равномернее
+// ключи делятся между экземплярами
+const ringReplicas = 128
+
+// loadFactor - во сколько раз владелец ключа может превысить среднюю
+// нагрузку, прежде чем запрос уйдет следующему по кольцу экземпляру
+// (consistent hashing with bounded loads)
+const loadFactor = 1.25
+
+type backend struct {
+	address     string
+	tag         string // Префикс id фоновых задач, созданных экземпляром
+	client      *Client
+	outstanding atomic.Int64 // Запросов в работе
+	healthy     atomic.Bool
+}
+
+type ringPoint struct {
+	hash    uint64
+	backend int
+}
+
+// router выбирает экземпляр: запросы с ключом - по кольцу согласованного
+// хеширования с ограничением нагрузки, чтобы повторы попадали в теплые кэши
+// одного экземпляра, без ключа - наименее загруженный. Недоступные
+// экземпляры пропускаются, пока доступен хотя бы один.
+type router struct {
+	backends []*backend
+	ring     []ringPoint
+	next     atomic.Uint64 // Начало обхода при равной нагрузке
+}
+
+func newRouter(backends []*backend) *router {
+	r := &router{backends: backends}
+	for i, b := range backends {
+		for v := 0; v < ringReplicas; v++ {
+			r.ring = append(r.ring, ringPoint{hash: hashKey(b.address + "#" + strconv.Itoa(v)), backend: i})
+		}
+	}
+	sort.Slice(r.ring, func(i, j int) bool { return r.ring[i].hash < r.ring[j].hash })
+	return r
+}
+
+// hashKey - FNV-1a с перемешиванием splitmix64: у FNV близкие строки
+// дают близкие старшие биты
+func hashKey(key string) uint64 {
+	h := fnv.New64a()
+	h.Write([]byte(key))
+	x := h.Sum64()
+	x ^= x >> 30
+	x *= 0xbf58476d1ce4e5b9
+	x ^= x >> 27
+	x *= 0x94d049bb133111eb
+	x ^= x >> 31
+	return x
+}
+
+// routingKey - выражение без пробелов: запись "x1 + x2" и "x1+x2"
+// компилируется в одну программу и должна попадать в один кэш
+func routingKey(function string) string {
+	return strings.Join(strings.Fields(function), "")
+}
+
+// usable - экземпляры, доступные для запросов: все, если здоровых нет
+func (r *router) usable() func(*backend) bool {
+	for _, b := range r.backends {
+		if b.healthy.Load() {
+			return func(b *backend) bool { return b.healthy.Load() }
+		}
+	}
+	return func(*backend) bool { return true }
+}
+
+func (r *router) pick(key string) *backend {
+	if len(r.backends) == 1 {
+		return r.backends[0]
+	}
+	usable := r.usable()
+	var total int64
+	count := 0
+	for _, b := range r.backends {
+		if usable(b) {
+			total += b.outstanding.Load()
+			count++
+		}
+	}
+	limit := int64(math.Ceil(loadFactor * float64(total+1) / float64(count)))
+
+	h := hashKey(key)
+	start := sort.Search(len(r.ring), func(i int) bool { return r.ring[i].hash >= h })
+	for i := range r.ring {
+		b := r.backends[r.ring[(start+i)%len(r.ring)].backend]
+		if usable(b) && b.outstanding.Load() < limit {
+			return b
+		}
+	}
+	return r.least()
+}
+
+func (r *router) least() *backend {
+	usable := r.usable()
+	start := int(r.next.Add(1))
+	var best *backend
+	for i := range r.backends {
+		b := r.backends[(start+i)%len(r.backends)]
+		if usable(b) && (best == nil || b.outstanding.Load() < best.outstanding.Load()) {
+			best = b
+		}
+	}
+	return best
+}
+
+func (r *router) byTag(tag string) *backend {
+	for _, b := range r.backends {
+		if b.tag == tag {
+			return b
+		}
+	}
+	return nil
+}
+
+func backendTag(address string) string {
+	h := fnv.New32a()
+	h.Write([]byte(address))
+	return strconv.FormatUint(uint64(h.Sum32()), 36)
+}
@@ -0,0 +1,65 @@
+package optimization
+
+import (
+	"fmt"
+	"testing"
+)
+
+func testRouter(n int) *router {
+	backends := make([]*backend, n)
+	for i := range backends {
+		address := fmt.Sprintf("127.0.0.1:%d", 9000+i)
+		backends[i] = &backend{address: address, tag: backendTag(address)}
+		backends[i].healthy.Store(true)
+	}
+	return newRouter(backends)
+}
+
+// Повтор выражения попадает в тот же экземпляр, разные выражения
+// делятся между всеми
+func TestRouterAffinity(t *testing.T) {
+	r := testRouter(4)
+	counts := make(map[*backend]int)
+	for i := 0; i < 4000; i++ {
+		key := routingKey(fmt.Sprintf("(x1 - %d)^2 + x2^2", i))
+		b := r.pick(key)
+		if again := r.pick(routingKey(fmt.Sprintf("(x1-%d)^2+x2^2", i))); again != b {
+			t.Fatalf("key %q: %s, then %s", key, b.address, again.address)
+		}
+		counts[b]++
+	}
+	for _, b := range r.backends {
+		if counts[b] < 600 || counts[b] > 1400 {
+			t.Errorf("%s got %d of 4000 keys", b.address, counts[b])
+		}
+	}
+}
+
+// Перегруженный владелец ключа уступает запрос, недоступный пропускается
+func TestRouterLoadAndHealth(t *testing.T) {
+	r := testRouter(3)
+	owner := r.pick("x1^2")
+	owner.outstanding.Store(10)
+	if b := r.pick("x1^2"); b == owner {
+		t.Errorf("overloaded owner %s still picked", owner.address)
+	}
+	owner.outstanding.Store(0)
+
+	owner.healthy.Store(false)
+	for i := 0; i < 100; i++ {
+		if b := r.pick(fmt.Sprintf("x1^%d", i)); b == owner {
+			t.Fatalf("unhealthy %s picked", owner.address)
+		}
+		if b := r.least(); b == owner {
+			t.Fatalf("unhealthy %s picked as least loaded", owner.address)
+		}
+	}
+
+	// Без здоровых экземпляров запросы идут ко всем: отказ лучше ожидания
+	for _, b := range r.backends {
+		b.healthy.Store(false)
+	}
+	if b := r.pick("x1^2"); b == nil {
+		t.Error("no backend without healthy ones")
+	}
+}
@@ -3,6 +3,7 @@ package rest
 import (
 	"awesomeProject2/api/core"
 	"encoding/json"
+	"errors"
 	"fmt"
 	"log/slog"
 	"net/http"
@@ -78,23 +79,249 @@ func NewOptimizationHandler(log *slog.Logger, optimizator core.Optimizator) http
 			return
 		}
 
-		response := OptimizationResponse{
-			Variable:      make([]Variable, len(reply.Variable)),
-			FunctionValue: reply.FunctionValue,
+		w.Header().Set("Content-Type", "application/json")
+		if err := json.NewEncoder(w).Encode(makeResponse(reply)); err != nil {
+			log.Error("failed to encode response", "error", err)
+			http.Error(w, "Internal Server Error", http.StatusInternalServerError)
+		}
+	}
+}
+
+func makeResponse(reply core.OptimizationReplay) *OptimizationResponse {
+	response := OptimizationResponse{
+		Variable:      make([]Variable, len(reply.Variable)),
+		FunctionValue: reply.FunctionValue,
+	}
+
+	for i, item := range reply.Variable {
+		response.Variable[i] = Variable{Name: item.Name, Value: item.Value}
+	}
+	return &response
+}
+
+const (
+	maxBatchProblems = 4096
+	maxBatchBody     = 8 << 20
+)
+
+type BatchProblem struct {
+	Function  string  `json:"function"`
+	Tolerance float64 `json:"tolerance"`
+	Iter      int     `json:"iter"`
+}
+
+// BatchResponse - строка ответа пакета: результат задачи index или ошибка
+type BatchResponse struct {
+	Index int `json:"index"`
+	*OptimizationResponse
+	Error string `json:"error,omitempty"`
+}
+
+// NewOptimizationBatchHandler принимает JSON-массив задач и отвечает в
+// формате NDJSON: по строке на задачу в порядке готовности
+func NewOptimizationBatchHandler(log *slog.Logger, optimizator core.BatchOptimizator) http.HandlerFunc {
+	return func(w http.ResponseWriter, r *http.Request) {
+		var problems []BatchProblem
+		if err := json.NewDecoder(http.MaxBytesReader(w, r.Body, maxBatchBody)).Decode(&problems); err != nil {
+			log.Error("invalid batch", "error", err)
+			http.Error(w, "request body must be a JSON array of problems", http.StatusBadRequest)
+			return
+		}
+		if len(problems) == 0 || len(problems) > maxBatchProblems {
+			http.Error(w, fmt.Sprintf("batch must contain from 1 to %d problems", maxBatchProblems), http.StatusBadRequest)
+			return
 		}
 
-		for i, item := range reply.Variable {
-			response.Variable[i] = Variable{Name: item.Name, Value: item.Value}
+		tasks := make([]core.OptimizationTask, len(problems))
+		for i, problem := range problems {
+			if err := validateProblem(problem); err != nil {
+				log.Error("invalid batch problem", "index", i, "error", err)
+				http.Error(w, fmt.Sprintf("problem %d: %v", i, err), http.StatusBadRequest)
+				return
+			}
+			tasks[i] = core.OptimizationTask{Function: problem.Function, Tolerance: problem.Tolerance, MaxIter: problem.Iter}
+		}
+
+		w.Header().Set("Content-Type", "application/x-ndjson")
+		w.WriteHeader(http.StatusOK)
+		controller := http.NewResponseController(w)
+		encoder := json.NewEncoder(w)
+		err := optimizator.OptimizationBatch(r.Context(), tasks, func(result core.BatchResult) {
+			line := BatchResponse{Index: result.Index, Error: result.Err}
+			if result.Err == "" {
+				line.OptimizationResponse = makeResponse(result.Replay)
+			}
+			if err := encoder.Encode(line); err == nil {
+				controller.Flush()
+			}
+		})
+		if err != nil {
+			// Статус уже отправлен: обрыв пакета сообщается последней строкой
+			log.Error("batch optimization failed", "error", err)
+			encoder.Encode(BatchResponse{Index: -1, Error: "optimization failed"})
+		}
+	}
+}
+
+// JobResponse - состояние фоновой задачи
+type JobResponse struct {
+	ID          string                `json:"id"`
+	State       string                `json:"state"`
+	Iteration   int64                 `json:"iteration"`
+	BestValue   float64               `json:"best_value"`
+	Evaluations int64                 `json:"evaluations"`
+	Result      *OptimizationResponse `json:"result,omitempty"`
+	Error       string                `json:"error,omitempty"`
+}
+
+// NewJobSubmitHandler принимает задачу в формате элемента пакета и отвечает
+// 202 с адресом задачи в Location, не дожидаясь расчета
+func NewJobSubmitHandler(log *slog.Logger, optimizator core.JobOptimizator) http.HandlerFunc {
+	return func(w http.ResponseWriter, r *http.Request) {
+		var problem BatchProblem
+		if err := json.NewDecoder(http.MaxBytesReader(w, r.Body, maxBatchBody)).Decode(&problem); err != nil {
+			log.Error("invalid job", "error", err)
+			http.Error(w, "request body must be a JSON problem", http.StatusBadRequest)
+			return
+		}
+		if err := validateProblem(problem); err != nil {
+			log.Error("invalid job", "error", err)
+			http.Error(w, err.Error(), http.StatusBadRequest)
+			return
+		}
+
+		job, err := optimizator.SubmitJob(r.Context(), core.OptimizationTask{Function: problem.Function, Tolerance: problem.Tolerance, MaxIter: problem.Iter})
+		if err != nil {
+			log.Error("job submission failed", "error", err)
+			http.Error(w, "job submission failed", http.StatusInternalServerError)
+			return
+		}
+		w.Header().Set("Location", "/api/jobs/"+job.ID)
+		writeJob(w, log, http.StatusAccepted, job)
+	}
+}
+
+// NewJobHandler отвечает состоянием задачи {id}: GET - опрос, DELETE - отмена
+func NewJobHandler(log *slog.Logger, optimizator core.JobOptimizator) http.HandlerFunc {
+	return func(w http.ResponseWriter, r *http.Request) {
+		id := r.PathValue("id")
+		var job core.Job
+		var err error
+		if r.Method == http.MethodDelete {
+			job, err = optimizator.CancelJob(r.Context(), id)
+		} else {
+			job, err = optimizator.Job(r.Context(), id)
+		}
+		if errors.Is(err, core.ErrJobNotFound) {
+			http.Error(w, "job not found", http.StatusNotFound)
+			return
+		}
+		if err != nil {
+			log.Error("job request failed", "job", id, "error", err)
+			http.Error(w, "job request failed", http.StatusInternalServerError)
+			return
+		}
+		writeJob(w, log, http.StatusOK, job)
+	}
+}
+
+func writeJob(w http.ResponseWriter, log *slog.Logger, code int, job core.Job) {
+	response := JobResponse{
+		ID:          job.ID,
+		State:       job.State,
+		Iteration:   job.Iteration,
+		BestValue:   job.BestValue,
+		Evaluations: job.Evaluations,
+		Error:       job.Err,
+	}
+	if job.Replay != nil {
+		response.Result = makeResponse(*job.Replay)
+	}
+	w.Header().Set("Content-Type", "application/json")
+	w.WriteHeader(code)
+	if err := json.NewEncoder(w).Encode(response); err != nil {
+		log.Error("failed to encode response", "error", err)
+	}
+}
+
+// maxIslandStarts ограничивает запуски одной задачи на всех островах
+const maxIslandStarts = 100000
+
+// IslandProblem - задача multi-start: Starts запусков из точек куба
+// [1 - Radius, 1 + Radius], Seed задает последовательность точек
+type IslandProblem struct {
+	BatchProblem
+	Starts int     `json:"starts"`
+	Radius float64 `json:"radius"`
+	Seed   uint64  `json:"seed"`
+}
+
+type IslandResponse struct {
+	*OptimizationResponse
+	Starts  int `json:"starts"`
+	Islands int `json:"islands"`
+	Pruned  int `json:"pruned"`
+}
+
+// NewIslandsHandler решает задачу multi-start на всех экземплярах сервиса
+// оптимизации, обменивающихся лучшими точками
+func NewIslandsHandler(log *slog.Logger, optimizator core.IslandOptimizator) http.HandlerFunc {
+	return func(w http.ResponseWriter, r *http.Request) {
+		var problem IslandProblem
+		if err := json.NewDecoder(http.MaxBytesReader(w, r.Body, maxBatchBody)).Decode(&problem); err != nil {
+			log.Error("invalid island problem", "error", err)
+			http.Error(w, "request body must be a JSON problem", http.StatusBadRequest)
+			return
+		}
+		if err := validateProblem(problem.BatchProblem); err != nil {
+			log.Error("invalid island problem", "error", err)
+			http.Error(w, err.Error(), http.StatusBadRequest)
+			return
+		}
+		if problem.Starts < 1 || problem.Starts > maxIslandStarts {
+			http.Error(w, fmt.Sprintf("starts must be from 1 to %d", maxIslandStarts), http.StatusBadRequest)
+			return
+		}
+		if problem.Radius < 0 {
+			http.Error(w, "radius must be positive", http.StatusBadRequest)
+			return
+		}
+
+		result, err := optimizator.Islands(r.Context(), core.IslandTask{
+			Function:  problem.Function,
+			Tolerance: problem.Tolerance,
+			MaxIter:   problem.Iter,
+			Starts:    problem.Starts,
+			Radius:    problem.Radius,
+			Seed:      problem.Seed,
+		})
+		if err != nil {
+			log.Error("island optimization failed", "error", err)
+			http.Error(w, "optimization failed", http.StatusInternalServerError)
+			return
 		}
 
 		w.Header().Set("Content-Type", "application/json")
+		response := IslandResponse{OptimizationResponse: makeResponse(result.Replay), Starts: result.Starts, Islands: result.Islands, Pruned: result.Pruned}
 		if err := json.NewEncoder(w).Encode(response); err != nil {
 			log.Error("failed to encode response", "error", err)
-			http.Error(w, "Internal Server Error", http.StatusInternalServerError)
 		}
 	}
 }
 
+func validateProblem(problem BatchProblem) error {
+	if problem.Function == "" {
+		return fmt.Errorf("function is required")
+	}
+	if problem.Tolerance < 0 {
+		return fmt.Errorf("tolerance must be positive")
+	}
+	if problem.Iter < 0 {
+		return fmt.Errorf("iter must be positive")
+	}
+	return nil
+}
+
 func parsePositiveFloatParam(r *http.Request, param string) (float64, error) {
 	valueStr := r.URL.Query().Get(param)
 	if valueStr == "" {
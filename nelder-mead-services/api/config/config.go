@@ -10,7 +10,9 @@ type Config struct {
 	LogLevel            string        `yaml:"log_level" env:"LOG_LEVEL" env-default:"DEBUG"`
 	Address             string        `yaml:"api_address" env:"API_ADDRESS" env-default:"localhost:80"`
 	Timeout             time.Duration `yaml:"timeout" env:"API_TIMEOUT" env-default:"5s"`
-	OptimizationAddress string        `yaml:"optimization_address" env:"OPTIMIZATION_ADDRESS" env-default:"localhost:81"`
+	OptimizationAddress string        `yaml:"optimization_address" env:"OPTIMIZATION_ADDRESS" env-default:"localhost:81"` // Через запятую для нескольких экземпляров, "inprocess" - движок в процессе API
+	HealthInterval      time.Duration `yaml:"health_interval" env:"HEALTH_INTERVAL" env-default:"2s"`
+	EngineConfig        string        `yaml:"engine_config" env:"ENGINE_CONFIG" env-default:""` // Настройки движка в процессе, формат сервиса оптимизации
 }
 
 func MustLoad(configPath string) Config {
@@ -0,0 +1,5 @@
+package core
+
+import "errors"
+
+var ErrJobNotFound = errors.New("job not found")
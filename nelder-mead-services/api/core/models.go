@@ -9,3 +9,48 @@ type OptimizationReplay struct {
 	Variable      []Variable
 	FunctionValue float64
 }
+
+// OptimizationTask - одна задача пакета
+type OptimizationTask struct {
+	Function  string
+	Tolerance float64
+	MaxIter   int
+}
+
+// BatchResult - результат задачи пакета с номером Index, при отказе Err не пуст
+type BatchResult struct {
+	Index  int
+	Replay OptimizationReplay
+	Err    string
+}
+
+// Job - состояние фоновой задачи: queued, running, done, failed, cancelled.
+// Replay задан для done и для cancelled с найденной к отмене точкой.
+type Job struct {
+	ID          string
+	State       string
+	Iteration   int64
+	BestValue   float64
+	Evaluations int64
+	Replay      *OptimizationReplay
+	Err         string
+}
+
+// IslandTask - multi-start по экземплярам сервиса: Starts начальных точек в
+// кубе [1 - Radius, 1 + Radius] делятся между экземплярами-островами
+type IslandTask struct {
+	Function  string
+	Tolerance float64
+	MaxIter   int
+	Starts    int
+	Radius    float64
+	Seed      uint64
+}
+
+// IslandResult - лучшая точка всех островов
+type IslandResult struct {
+	Replay  OptimizationReplay
+	Starts  int // Запусков выполнено
+	Islands int
+	Pruned  int // Островов снято как отстающих
+}
@@ -6,6 +6,25 @@ type Optimizator interface {
 	Optimization(context.Context, string, float64, int) (OptimizationReplay, error)
 }
 
+// BatchOptimizator решает пакет задач, report получает результаты по мере готовности
+type BatchOptimizator interface {
+	OptimizationBatch(context.Context, []OptimizationTask, func(BatchResult)) error
+}
+
+// JobOptimizator ведет фоновые задачи: клиент получает id сразу и опрашивает
+// состояние, не держа соединение на время расчета
+type JobOptimizator interface {
+	SubmitJob(context.Context, OptimizationTask) (Job, error)
+	Job(context.Context, string) (Job, error)
+	CancelJob(context.Context, string) (Job, error)
+}
+
 type Pinger interface {
 	Ping(context.Context) error
 }
+
+// IslandOptimizator решает задачу multi-start на нескольких экземплярах,
+// обменивающихся лучшими точками
+type IslandOptimizator interface {
+	Islands(context.Context, IslandTask) (IslandResult, error)
+}
@@ -1,6 +1,7 @@
 package main
 
 import (
+	"awesomeProject2/api/adapters/inprocess"
 	"awesomeProject2/api/adapters/optimization"
 	"awesomeProject2/api/adapters/rest"
 	"awesomeProject2/api/config"
@@ -12,8 +13,12 @@ import (
 	"net/http"
 	"os"
 	"os/signal"
+	"strings"
 )
 
+// inProcessAddress в optimization_address включает движок в процессе API
+const inProcessAddress = "inprocess"
+
 func main() {
 	var configPath string
 	flag.StringVar(&configPath, "config", "config.yaml", "server configuration file")
@@ -25,15 +30,36 @@ func main() {
 
 	log.Info("starting server")
 	log.Debug("debug messages are enabled")
-	optimizationClient, err := optimization.NewClient(cfg.OptimizationAddress, log)
-	if err != nil {
-		log.Error("cannot init optimization adapter", "error", err)
-		os.Exit(1)
+	// Экземпляры сервиса оптимизации по gRPC (TCP или unix:///path) либо
+	// движок в процессе API
+	var optimizationClient inprocess.Backend
+	var pool *optimization.Pool
+	if cfg.OptimizationAddress == inProcessAddress {
+		engine, closeEngine, err := inprocess.Open(cfg.EngineConfig, log)
+		if err != nil {
+			log.Error("cannot init in-process optimization", "error", err)
+			os.Exit(1)
+		}
+		defer closeEngine()
+		optimizationClient = engine
+	} else {
+		var err error
+		pool, err = optimization.NewPool(splitAddresses(cfg.OptimizationAddress), log)
+		if err != nil {
+			log.Error("cannot init optimization adapter", "error", err)
+			os.Exit(1)
+		}
+		optimizationClient = pool
 	}
 
 	mux := http.NewServeMux()
 	mux.Handle("GET /api/ping", rest.NewPingHandler(log, map[string]core.Pinger{"optimization": optimizationClient}))
 	mux.Handle("GET /api/optimization", rest.NewOptimizationHandler(log, optimizationClient))
+	mux.Handle("POST /api/optimization/batch", rest.NewOptimizationBatchHandler(log, optimizationClient))
+	mux.Handle("POST /api/optimization/islands", rest.NewIslandsHandler(log, optimizationClient))
+	mux.Handle("POST /api/jobs", rest.NewJobSubmitHandler(log, optimizationClient))
+	mux.Handle("GET /api/jobs/{id}", rest.NewJobHandler(log, optimizationClient))
+	mux.Handle("DELETE /api/jobs/{id}", rest.NewJobHandler(log, optimizationClient))
 
 	server := http.Server{
 		Addr:        cfg.Address,
@@ -43,6 +69,9 @@ func main() {
 
 	ctx, stop := signal.NotifyContext(context.Background(), os.Interrupt)
 	defer stop()
+	if pool != nil {
+		go pool.Watch(ctx, cfg.HealthInterval)
+	}
 
 	go func() {
 		<-ctx.Done()
@@ -61,6 +90,16 @@ func main() {
 	}
 }
 
+func splitAddresses(list string) []string {
+	var addresses []string
+	for _, address := range strings.Split(list, ",") {
+		if address = strings.TrimSpace(address); address != "" {
+			addresses = append(addresses, address)
+		}
+	}
+	return addresses
+}
+
 func mustMakeLogger(logLevel string) *slog.Logger {
 	var level slog.Level
 	switch logLevel {
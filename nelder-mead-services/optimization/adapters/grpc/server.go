@@ -6,8 +6,10 @@ import (
 	"context"
 	"errors"
 	"google.golang.org/grpc/codes"
+	"google.golang.org/grpc/metadata"
 	"google.golang.org/grpc/status"
 	"google.golang.org/protobuf/types/known/emptypb"
+	"io"
 )
 
 func NewServer(service core.Optimizator) *Server {
@@ -28,16 +30,226 @@ func (s *Server) Optimization(ctx context.Context, request *__.OptimizationReque
 		Function:  request.GetFunction(),
 		Tolerance: request.GetTolerance(),
 		MaxIter:   request.GetMaxIter(),
+		Priority:  requestPriority(ctx),
 	}
 
 	result, err := s.service.Optimization(ctx, query)
 	if err != nil {
-		if errors.Is(err, core.ErrOptimizationFailed) {
-			return nil, status.Error(codes.OutOfRange, "It is impossible to find the optimum")
+		return nil, statusError(err)
+	}
+	return replyMessage(result), nil
+}
+
+// OptimizationStream отправляет ход метода по мере работы, последнее
+// сообщение содержит ответ. Клиент может прервать запуск, отменив вызов.
+func (s *Server) OptimizationStream(request *__.OptimizationRequest, stream __.Optimization_OptimizationStreamServer) error {
+	ctx := stream.Context()
+	query := core.OptimizationQuery{
+		Function:  request.GetFunction(),
+		Tolerance: request.GetTolerance(),
+		MaxIter:   request.GetMaxIter(),
+		Priority:  requestPriority(ctx),
+	}
+
+	// Сообщения отправляет отдельная горутина: report вызывается из потока
+	// пула, который не должен ждать медленного клиента
+	updates := make(chan core.OptimizationProgress, 1)
+	sent := make(chan error, 1)
+	go func() {
+		var err error
+		for progress := range updates {
+			if err == nil {
+				err = stream.Send(&__.OptimizationProgress{
+					Iteration:   progress.Iteration,
+					BestValue:   progress.BestValue,
+					Spread:      progress.Spread,
+					Evaluations: progress.Evaluations,
+				})
+			}
+		}
+		sent <- err
+	}()
+
+	result, err := s.service.OptimizationProgress(ctx, query, func(progress core.OptimizationProgress) {
+		select {
+		case updates <- progress:
+		default: // Предыдущее сообщение еще не отправлено, это пропускается
+		}
+	})
+	close(updates)
+	if sendErr := <-sent; sendErr != nil {
+		return sendErr
+	}
+	if err != nil {
+		return statusError(err)
+	}
+	return stream.Send(&__.OptimizationProgress{Result: replyMessage(result)})
+}
+
+// maxBatchProblems - предел числа задач в одном OptimizeBatch
+const maxBatchProblems = 4096
+
+// OptimizeBatch решает задачи пакета в фоновом классе пула и отправляет
+// результат каждой по мере готовности, index - номер задачи в запросе
+func (s *Server) OptimizeBatch(request *__.BatchRequest, stream __.Optimization_OptimizeBatchServer) error {
+	problems := request.GetProblems()
+	if len(problems) > maxBatchProblems {
+		return status.Errorf(codes.InvalidArgument, "The batch is too large, at most %d problems are allowed", maxBatchProblems)
+	}
+	queries := make([]core.OptimizationQuery, len(problems))
+	for i, problem := range problems {
+		queries[i] = core.OptimizationQuery{
+			Function:  problem.GetFunction(),
+			Tolerance: problem.GetTolerance(),
+			MaxIter:   problem.GetMaxIter(),
+			Priority:  core.PriorityBatch,
 		}
-		return nil, err
 	}
 
+	var sendErr error
+	s.service.OptimizationBatch(stream.Context(), queries, func(index int, result core.OptimizationReplay, err error) {
+		if sendErr != nil {
+			return
+		}
+		message := &__.BatchResult{Index: int32(index)}
+		if err != nil {
+			message.Error = status.Convert(statusError(err)).Message()
+		} else {
+			message.Reply = replyMessage(result)
+		}
+		sendErr = stream.Send(message)
+	})
+	return sendErr
+}
+
+// SubmitJob ставит задачу в фоновую очередь и сразу возвращает ее id:
+// клиент опрашивает GetJob и не держит соединение на время расчета
+func (s *Server) SubmitJob(_ context.Context, request *__.OptimizationRequest) (*__.JobStatus, error) {
+	job, err := s.service.SubmitJob(core.OptimizationQuery{
+		Function:  request.GetFunction(),
+		Tolerance: request.GetTolerance(),
+		MaxIter:   request.GetMaxIter(),
+	})
+	if err != nil {
+		return nil, statusError(err)
+	}
+	return jobMessage(job), nil
+}
+
+func (s *Server) GetJob(_ context.Context, request *__.JobRequest) (*__.JobStatus, error) {
+	job, err := s.service.Job(request.GetId())
+	if err != nil {
+		return nil, statusError(err)
+	}
+	return jobMessage(job), nil
+}
+
+func (s *Server) CancelJob(_ context.Context, request *__.JobRequest) (*__.JobStatus, error) {
+	job, err := s.service.CancelJob(request.GetId())
+	if err != nil {
+		return nil, statusError(err)
+	}
+	return jobMessage(job), nil
+}
+
+// Island выполняет долю острова: первое сообщение потока - задача,
+// следующие - мигранты. Координатор снимает остров, отменив вызов.
+func (s *Server) Island(stream __.Optimization_IslandServer) error {
+	first, err := stream.Recv()
+	if err != nil {
+		return err
+	}
+	request := first.GetTask()
+	if request == nil {
+		return status.Error(codes.InvalidArgument, "The first message must carry the island task")
+	}
+	task := core.IslandTask{
+		Query: core.OptimizationQuery{
+			Function:  request.GetProblem().GetFunction(),
+			Tolerance: request.GetProblem().GetTolerance(),
+			MaxIter:   request.GetProblem().GetMaxIter(),
+		},
+		Island:  int(request.GetIsland()),
+		Islands: int(request.GetIslands()),
+		Starts:  int(request.GetStarts()),
+		Seed:    request.GetSeed(),
+		Radius:  request.GetRadius(),
+	}
+
+	// Мигранты читает отдельная горутина; непрочитанного мигранта
+	// заменяет следующий, он не хуже
+	ctx, cancel := context.WithCancel(stream.Context())
+	defer cancel()
+	migrants := make(chan core.IslandPoint, 1)
+	go func() {
+		for {
+			message, err := stream.Recv()
+			if err != nil {
+				if !errors.Is(err, io.EOF) {
+					cancel()
+				}
+				return
+			}
+			if migrant := message.GetMigrant(); migrant != nil {
+				select {
+				case <-migrants:
+				default:
+				}
+				migrants <- islandPoint(migrant)
+			}
+		}
+	}()
+
+	var sendErr error
+	err = s.service.Island(ctx, task, migrants, func(report core.IslandReport) {
+		if sendErr == nil {
+			sendErr = stream.Send(&__.IslandReport{
+				Starts: int32(report.Starts),
+				Best:   islandMessage(report.Best),
+				Done:   report.Done,
+			})
+		}
+	})
+	if sendErr != nil {
+		return sendErr
+	}
+	if err != nil {
+		return statusError(err)
+	}
+	return nil
+}
+
+func islandPoint(message *__.IslandPoint) core.IslandPoint {
+	return core.IslandPoint{Names: message.GetNames(), Point: message.GetPoint(), Value: message.GetValue()}
+}
+
+func islandMessage(point core.IslandPoint) *__.IslandPoint {
+	return &__.IslandPoint{Names: point.Names, Point: point.Point, Value: point.Value}
+}
+
+func statusError(err error) error {
+	if errors.Is(err, core.ErrOptimizationFailed) {
+		return status.Error(codes.OutOfRange, "It is impossible to find the optimum")
+	}
+	if errors.Is(err, core.ErrOverloaded) {
+		return status.Error(codes.ResourceExhausted, "The server is overloaded, try again later")
+	}
+	if errors.Is(err, core.ErrJobTooCostly) {
+		return status.Error(codes.ResourceExhausted, "The problem is too large, reduce max_iter or dimension")
+	}
+	if errors.Is(err, core.ErrJobNotFound) {
+		return status.Error(codes.NotFound, "The job does not exist or has expired")
+	}
+	if errors.Is(err, core.ErrInvalidIsland) {
+		return status.Error(codes.InvalidArgument, "Invalid island task: islands, island number, starts or radius")
+	}
+	if errors.Is(err, core.ErrWorkerCrashed) {
+		return status.Error(codes.Internal, "The optimization worker crashed on this problem")
+	}
+	return err
+}
+
+func replyMessage(result core.OptimizationReplay) *__.OptimizationReply {
 	var variables []*__.Variable
 	for _, v := range result.Variable {
 		variables = append(variables, &__.Variable{
@@ -49,5 +261,35 @@ func (s *Server) Optimization(ctx context.Context, request *__.OptimizationReque
 	return &__.OptimizationReply{
 		Variable:      variables,
 		FunctionValue: result.FunctionValue,
-	}, nil
+	}
+}
+
+func jobMessage(job core.JobStatus) *__.JobStatus {
+	message := &__.JobStatus{
+		Id:          job.ID,
+		State:       string(job.State),
+		Iteration:   job.Progress.Iteration,
+		BestValue:   job.Progress.BestValue,
+		Evaluations: job.Progress.Evaluations,
+		Error:       job.Error,
+	}
+	if job.State == core.JobDone || job.State == core.JobCancelled && len(job.Replay.Variable) > 0 {
+		message.Result = replyMessage(job.Replay)
+	}
+	return message
+}
+
+// requestPriority читает класс запроса из метаданных "priority: batch",
+// по умолчанию запрос интерактивный
+func requestPriority(ctx context.Context) core.Priority {
+	md, ok := metadata.FromIncomingContext(ctx)
+	if !ok {
+		return core.PriorityInteractive
+	}
+	for _, value := range md.Get("priority") {
+		if value == "batch" {
+			return core.PriorityBatch
+		}
+	}
+	return core.PriorityInteractive
 }
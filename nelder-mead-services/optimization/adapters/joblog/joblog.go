@@ -0,0 +1,231 @@
+// Package joblog - журнал фоновых задач оптимизации в файле: по строке JSON
+// на запись, только дозапись. Оборванная при сбое последняя строка
+// отбрасывается при загрузке, сжатие переписывает журнал через rename.
+package joblog
+
+import (
+	"awesomeProject2/optimization/core"
+	"bufio"
+	"bytes"
+	"encoding/base64"
+	"encoding/binary"
+	"encoding/json"
+	"errors"
+	"fmt"
+	"io"
+	"math"
+	"os"
+	"path/filepath"
+	"strconv"
+	"sync"
+	"time"
+)
+
+var ErrCorrupted = errors.New("job log is corrupted")
+
+// Log - журнал задач. Методы безопасны для одновременного вызова.
+type Log struct {
+	mu   sync.Mutex
+	path string
+	file *os.File
+}
+
+var _ core.JobLog = (*Log)(nil)
+
+func Open(path string) (*Log, error) {
+	file, err := os.OpenFile(path, os.O_RDWR|os.O_CREATE|os.O_APPEND, 0o644)
+	if err != nil {
+		return nil, err
+	}
+	return &Log{path: path, file: file}, nil
+}
+
+func (l *Log) Close() error {
+	l.mu.Lock()
+	defer l.mu.Unlock()
+	return l.file.Close()
+}
+
+// record - строка журнала. Числа с плавающей точкой записываются строками,
+// снимок - байтами float64 в base64: JSON не представляет Inf и NaN,
+// а снимок должен восстанавливаться бит в бит
+type record struct {
+	Kind     core.JobRecordKind `json:"kind"`
+	ID       string             `json:"id"`
+	Time     time.Time          `json:"time"`
+	Query    *query             `json:"query,omitempty"`
+	Snapshot string             `json:"snapshot,omitempty"`
+	State    core.JobState      `json:"state,omitempty"`
+	Replay   *replay            `json:"replay,omitempty"`
+	Error    string             `json:"error,omitempty"`
+}
+
+type query struct {
+	Function  string `json:"function"`
+	Tolerance string `json:"tolerance"`
+	MaxIter   int64  `json:"maxIter"`
+}
+
+type replay struct {
+	Variable      []core.Variable `json:"variables"`
+	FunctionValue string          `json:"functionValue"`
+}
+
+func formatFloat(v float64) string {
+	return strconv.FormatFloat(v, 'g', -1, 64)
+}
+
+func encode(r core.JobRecord) ([]byte, error) {
+	line := record{Kind: r.Kind, ID: r.ID, Time: r.Time, State: r.State, Error: r.Error}
+	switch r.Kind {
+	case core.JobSubmitted:
+		line.Query = &query{Function: r.Query.Function, Tolerance: formatFloat(r.Query.Tolerance), MaxIter: r.Query.MaxIter}
+	case core.JobSnapshot:
+		raw := make([]byte, 8*len(r.Snapshot))
+		for i, v := range r.Snapshot {
+			binary.LittleEndian.PutUint64(raw[8*i:], math.Float64bits(v))
+		}
+		line.Snapshot = base64.StdEncoding.EncodeToString(raw)
+	case core.JobFinished:
+		line.Replay = &replay{Variable: r.Replay.Variable, FunctionValue: formatFloat(r.Replay.FunctionValue)}
+	}
+	data, err := json.Marshal(line)
+	if err != nil {
+		return nil, err
+	}
+	return append(data, '\n'), nil
+}
+
+func decode(data []byte) (core.JobRecord, error) {
+	var line record
+	if err := json.Unmarshal(data, &line); err != nil {
+		return core.JobRecord{}, err
+	}
+	r := core.JobRecord{Kind: line.Kind, ID: line.ID, Time: line.Time, State: line.State, Error: line.Error}
+	var err error
+	if line.Query != nil {
+		r.Query = core.OptimizationQuery{Function: line.Query.Function, MaxIter: line.Query.MaxIter, Priority: core.PriorityBatch}
+		if r.Query.Tolerance, err = strconv.ParseFloat(line.Query.Tolerance, 64); err != nil {
+			return core.JobRecord{}, err
+		}
+	}
+	if line.Snapshot != "" {
+		raw, err := base64.StdEncoding.DecodeString(line.Snapshot)
+		if err != nil || len(raw)%8 != 0 {
+			return core.JobRecord{}, fmt.Errorf("invalid snapshot of job %s", line.ID)
+		}
+		r.Snapshot = make([]float64, len(raw)/8)
+		for i := range r.Snapshot {
+			r.Snapshot[i] = math.Float64frombits(binary.LittleEndian.Uint64(raw[8*i:]))
+		}
+	}
+	if line.Replay != nil {
+		r.Replay.Variable = line.Replay.Variable
+		if r.Replay.FunctionValue, err = strconv.ParseFloat(line.Replay.FunctionValue, 64); err != nil {
+			return core.JobRecord{}, err
+		}
+	}
+	return r, nil
+}
+
+// Append дописывает запись одной операцией write: строки одновременных
+// вызовов не перемешиваются
+func (l *Log) Append(r core.JobRecord, sync bool) error {
+	data, err := encode(r)
+	if err != nil {
+		return err
+	}
+	l.mu.Lock()
+	defer l.mu.Unlock()
+	if _, err := l.file.Write(data); err != nil {
+		return err
+	}
+	if sync {
+		return l.file.Sync()
+	}
+	return nil
+}
+
+// Load читает журнал и обрезает оборванную последнюю строку, чтобы
+// следующие записи начинались с новой строки
+func (l *Log) Load() ([]core.JobRecord, error) {
+	l.mu.Lock()
+	defer l.mu.Unlock()
+	if _, err := l.file.Seek(0, io.SeekStart); err != nil {
+		return nil, err
+	}
+	reader := bufio.NewReader(l.file)
+	var records []core.JobRecord
+	var offset int64
+	for {
+		data, err := reader.ReadBytes('\n')
+		if err == io.EOF {
+			if len(data) > 0 {
+				return records, l.file.Truncate(offset)
+			}
+			return records, nil
+		}
+		if err != nil {
+			return nil, err
+		}
+		if line := bytes.TrimSpace(data); len(line) > 0 {
+			r, err := decode(line)
+			if err != nil {
+				return nil, fmt.Errorf("%w: offset %d: %v", ErrCorrupted, offset, err)
+			}
+			records = append(records, r)
+		}
+		offset += int64(len(data))
+	}
+}
+
+// Compact записывает records во временный файл и подменяет им журнал
+func (l *Log) Compact(records []core.JobRecord) error {
+	tmp := l.path + ".tmp"
+	if err := writeRecords(tmp, records); err != nil {
+		os.Remove(tmp)
+		return err
+	}
+
+	l.mu.Lock()
+	defer l.mu.Unlock()
+	if err := os.Rename(tmp, l.path); err != nil {
+		os.Remove(tmp)
+		return err
+	}
+	// Каталог синхронизируется, чтобы rename пережил сбой питания;
+	// не все системы это позволяют, ошибка не критична
+	if dir, err := os.Open(filepath.Dir(l.path)); err == nil {
+		dir.Sync()
+		dir.Close()
+	}
+	file, err := os.OpenFile(l.path, os.O_RDWR|os.O_APPEND, 0o644)
+	if err != nil {
+		return err
+	}
+	l.file.Close()
+	l.file = file
+	return nil
+}
+
+func writeRecords(path string, records []core.JobRecord) error {
+	file, err := os.OpenFile(path, os.O_RDWR|os.O_CREATE|os.O_TRUNC, 0o644)
+	if err != nil {
+		return err
+	}
+	defer file.Close()
+	writer := bufio.NewWriter(file)
+	for _, r := range records {
+		data, err := encode(r)
+		if err != nil {
+			return err
+		}
+		if _, err := writer.Write(data); err != nil {
+			return err
+		}
+	}
+	if err := writer.Flush(); err != nil {
+		return err
+	}
+	return file.Sync()
+}
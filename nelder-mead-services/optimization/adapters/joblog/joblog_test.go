@@ -0,0 +1,140 @@
+package joblog
+
+import (
+	"awesomeProject2/optimization/core"
+	"math"
+	"os"
+	"path/filepath"
+	"reflect"
+	"testing"
+	"time"
+)
+
+func testRecords() []core.JobRecord {
+	at := time.Date(2024, 5, 1, 12, 0, 0, 0, time.UTC)
+	return []core.JobRecord{
+		{Kind: core.JobSubmitted, ID: "a", Time: at, Query: core.OptimizationQuery{Function: "x1^2", Tolerance: 1e-9, MaxIter: 100, Priority: core.PriorityBatch}},
+		{Kind: core.JobSnapshot, ID: "a", Time: at, Snapshot: []float64{12, 40, 0.1, math.Inf(1), math.NaN(), -0.0}},
+		{Kind: core.JobFinished, ID: "a", Time: at, State: core.JobDone, Replay: core.OptimizationReplay{
+			Variable: []core.Variable{{Name: "x1", Value: 0}}, FunctionValue: math.Inf(-1)}},
+	}
+}
+
+// Снимок сравнивается бит в бит: NaN != NaN
+func sameRecords(t *testing.T, got, want []core.JobRecord) {
+	t.Helper()
+	if len(got) != len(want) {
+		t.Fatalf("%d records, want %d", len(got), len(want))
+	}
+	for i := range want {
+		g, w := got[i], want[i]
+		if len(g.Snapshot) != len(w.Snapshot) {
+			t.Fatalf("record %d: snapshot %v, want %v", i, g.Snapshot, w.Snapshot)
+		}
+		for j := range w.Snapshot {
+			if math.Float64bits(g.Snapshot[j]) != math.Float64bits(w.Snapshot[j]) {
+				t.Errorf("record %d: snapshot %v, want %v", i, g.Snapshot, w.Snapshot)
+			}
+		}
+		g.Snapshot, w.Snapshot = nil, nil
+		if !g.Time.Equal(w.Time) {
+			t.Errorf("record %d: time %v, want %v", i, g.Time, w.Time)
+		}
+		g.Time, w.Time = time.Time{}, time.Time{}
+		if !reflect.DeepEqual(g, w) {
+			t.Errorf("record %d: %+v, want %+v", i, g, w)
+		}
+	}
+}
+
+func TestLogReopen(t *testing.T) {
+	path := filepath.Join(t.TempDir(), "jobs.log")
+	log, err := Open(path)
+	if err != nil {
+		t.Fatal(err)
+	}
+	for i, r := range testRecords() {
+		if err := log.Append(r, i != 1); err != nil {
+			t.Fatal(err)
+		}
+	}
+	log.Close()
+
+	log, err = Open(path)
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer log.Close()
+	records, err := log.Load()
+	if err != nil {
+		t.Fatal(err)
+	}
+	sameRecords(t, records, testRecords())
+}
+
+// Оборванная при сбое строка отбрасывается, следующая запись читается
+func TestLogTornTail(t *testing.T) {
+	path := filepath.Join(t.TempDir(), "jobs.log")
+	log, err := Open(path)
+	if err != nil {
+		t.Fatal(err)
+	}
+	records := testRecords()
+	if err := log.Append(records[0], true); err != nil {
+		t.Fatal(err)
+	}
+	log.Close()
+	file, err := os.OpenFile(path, os.O_WRONLY|os.O_APPEND, 0)
+	if err != nil {
+		t.Fatal(err)
+	}
+	file.WriteString(`{"kind":"snapshot","id":"a","sna`)
+	file.Close()
+
+	log, err = Open(path)
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer log.Close()
+	loaded, err := log.Load()
+	if err != nil {
+		t.Fatal(err)
+	}
+	sameRecords(t, loaded, records[:1])
+	if err := log.Append(records[2], true); err != nil {
+		t.Fatal(err)
+	}
+	if loaded, err = log.Load(); err != nil {
+		t.Fatal(err)
+	}
+	sameRecords(t, loaded, []core.JobRecord{records[0], records[2]})
+}
+
+func TestLogCompact(t *testing.T) {
+	path := filepath.Join(t.TempDir(), "jobs.log")
+	log, err := Open(path)
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer log.Close()
+	records := testRecords()
+	for _, r := range records {
+		if err := log.Append(r, false); err != nil {
+			t.Fatal(err)
+		}
+	}
+	if err := log.Compact(records[:1]); err != nil {
+		t.Fatal(err)
+	}
+	if err := log.Append(records[2], false); err != nil {
+		t.Fatal(err)
+	}
+	loaded, err := log.Load()
+	if err != nil {
+		t.Fatal(err)
+	}
+	sameRecords(t, loaded, []core.JobRecord{records[0], records[2]})
+	if _, err := os.Stat(path + ".tmp"); !os.IsNotExist(err) {
+		t.Errorf("temporary file left: %v", err)
+	}
+}
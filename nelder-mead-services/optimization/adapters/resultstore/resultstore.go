@@ -0,0 +1,13 @@
+// Package resultstore - хранилище готовых ответов оптимизации в файле,
+// отображенном в память. Файл разделяют процессы одного хоста, он переживает
+// перезапуск; объем ограничен размером файла, старые записи вытесняются.
+package resultstore
+
+type Stats struct {
+	Hits      int64
+	Misses    int64
+	Stores    int64
+	Evictions int64 // Слотов индекса, отданных под новый ключ
+	Slots     int
+	DataSize  int64
+}
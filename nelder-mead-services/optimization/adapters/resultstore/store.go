@@ -0,0 +1,384 @@
+//go:build unix
+
+package resultstore
+
+import (
+	"awesomeProject2/optimization/core"
+	"bytes"
+	"encoding/binary"
+	"errors"
+	"fmt"
+	"hash/crc32"
+	"hash/fnv"
+	"math"
+	"os"
+	"sync"
+	"sync/atomic"
+	"syscall"
+)
+
+// Формат файла:
+//
+//	заголовок   headerSize байт: магия, число слотов, размер области данных, head
+//	индекс      slots * slotSize байт: хеш ключа и абсолютное смещение записи
+//	данные      кольцевой журнал записей: заголовок записи, ключ, ответ
+//
+// head - абсолютное смещение следующей записи, растет монотонно; запись по
+// смещению abs цела, пока head <= abs + dataSize. Слот, указывающий на
+// затертую запись, считается свободным, поэтому индекс не требует очистки.
+const (
+	magic        = "NMRSTOR1"
+	headerSize   = 64
+	slotSize     = 16
+	recordHeader = 20 // хеш, crc32, длина ключа, длина ответа
+	probes       = 8  // Слотов, просматриваемых для одного ключа
+
+	offSlots    = 8
+	offDataSize = 16
+	offHead     = 24
+)
+
+var (
+	ErrInvalidFile    = errors.New("result cache file has invalid layout")
+	ErrRecordTooLarge = errors.New("result is too large for the result cache")
+)
+
+// Store - общий для процессов кэш ответов. Запись и чтение в разных
+// процессах согласуются блокировкой файла flock, внутри процесса - mu.
+// flock принадлежит открытому файлу, а не горутине, поэтому разделяемую
+// блокировку берет первый читатель процесса и снимает последний.
+type Store struct {
+	mu   sync.RWMutex
+	file *os.File
+	mem  []byte
+
+	readMu  sync.Mutex
+	readers int
+
+	slots    uint64
+	dataSize uint64
+	index    []byte
+	data     []byte
+
+	hits, misses, stores, evictions atomic.Int64
+}
+
+var _ core.ResultCache = (*Store)(nil)
+
+// Open открывает файл кэша или создает его размером size байт.
+// Геометрия существующего файла сохраняется, size для него не применяется.
+func Open(path string, size int64) (*Store, error) {
+	file, err := os.OpenFile(path, os.O_RDWR|os.O_CREATE, 0o644)
+	if err != nil {
+		return nil, err
+	}
+	store, err := open(file, size)
+	if err != nil {
+		file.Close()
+		return nil, fmt.Errorf("result cache %s: %w", path, err)
+	}
+	return store, nil
+}
+
+func open(file *os.File, size int64) (*Store, error) {
+	fd := int(file.Fd())
+	if err := syscall.Flock(fd, syscall.LOCK_EX); err != nil {
+		return nil, err
+	}
+	defer syscall.Flock(fd, syscall.LOCK_UN)
+
+	info, err := file.Stat()
+	if err != nil {
+		return nil, err
+	}
+	create := info.Size() == 0
+	if create {
+		if size < headerSize+int64(indexSlots(size)*slotSize)+4096 {
+			return nil, fmt.Errorf("size %d is too small", size)
+		}
+		if err := file.Truncate(size); err != nil {
+			return nil, err
+		}
+	} else {
+		size = info.Size()
+	}
+	if size < headerSize {
+		return nil, ErrInvalidFile
+	}
+
+	mem, err := syscall.Mmap(fd, 0, int(size), syscall.PROT_READ|syscall.PROT_WRITE, syscall.MAP_SHARED)
+	if err != nil {
+		return nil, err
+	}
+	if create {
+		slots := indexSlots(size)
+		copy(mem, magic)
+		binary.LittleEndian.PutUint64(mem[offSlots:], slots)
+		binary.LittleEndian.PutUint64(mem[offDataSize:], uint64(size)-headerSize-slots*slotSize)
+		binary.LittleEndian.PutUint64(mem[offHead:], 0)
+	}
+
+	slots := binary.LittleEndian.Uint64(mem[offSlots:])
+	dataSize := binary.LittleEndian.Uint64(mem[offDataSize:])
+	if string(mem[:len(magic)]) != magic || slots == 0 || slots&(slots-1) != 0 ||
+		slots > uint64(size)/slotSize || headerSize+slots*slotSize+dataSize != uint64(size) {
+		syscall.Munmap(mem)
+		return nil, ErrInvalidFile
+	}
+
+	indexEnd := headerSize + slots*slotSize
+	return &Store{
+		file:     file,
+		mem:      mem,
+		slots:    slots,
+		dataSize: dataSize,
+		index:    mem[headerSize:indexEnd],
+		data:     mem[indexEnd:],
+	}, nil
+}
+
+// Close отображает изменения в файл и освобождает его
+func (s *Store) Close() error {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	if s.mem == nil {
+		return nil
+	}
+	err := syscall.Munmap(s.mem)
+	s.mem, s.index, s.data = nil, nil, nil
+	if closeErr := s.file.Close(); err == nil {
+		err = closeErr
+	}
+	return err
+}
+
+func (s *Store) Stats() Stats {
+	return Stats{
+		Hits:      s.hits.Load(),
+		Misses:    s.misses.Load(),
+		Stores:    s.stores.Load(),
+		Evictions: s.evictions.Load(),
+		Slots:     int(s.slots),
+		DataSize:  int64(s.dataSize),
+	}
+}
+
+func (s *Store) Get(key string) (core.OptimizationReplay, bool) {
+	hash := hashKey(key)
+
+	s.mu.RLock()
+	defer s.mu.RUnlock()
+	if s.mem == nil || s.lockShared() != nil {
+		s.misses.Add(1)
+		return core.OptimizationReplay{}, false
+	}
+	defer s.unlockShared()
+
+	head := s.head()
+	for i := uint64(0); i < probes; i++ {
+		slot := s.slot(hash + i)
+		if binary.LittleEndian.Uint64(slot) != hash {
+			continue
+		}
+		recordKey, value, ok := s.record(binary.LittleEndian.Uint64(slot[8:]), head)
+		if !ok || string(recordKey) != key {
+			continue
+		}
+		if replay, ok := decodeReplay(value); ok {
+			s.hits.Add(1)
+			return replay, true
+		}
+	}
+	s.misses.Add(1)
+	return core.OptimizationReplay{}, false
+}
+
+func (s *Store) Put(key string, replay core.OptimizationReplay) error {
+	hash := hashKey(key)
+	value := encodeReplay(replay)
+	size := align8(recordHeader + uint64(len(key)) + uint64(len(value)))
+	if size > s.dataSize/4 {
+		return ErrRecordTooLarge
+	}
+
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	if s.mem == nil {
+		return os.ErrClosed
+	}
+	if err := s.lock(syscall.LOCK_EX); err != nil {
+		return err
+	}
+	defer s.lock(syscall.LOCK_UN)
+
+	// Запись не переходит через конец кольца: хвост пропускается
+	abs := s.head()
+	if pos := abs % s.dataSize; pos+size > s.dataSize {
+		abs += s.dataSize - pos
+	}
+	head := abs + size
+
+	record := s.data[abs%s.dataSize:][:size]
+	binary.LittleEndian.PutUint64(record, hash)
+	binary.LittleEndian.PutUint32(record[12:], uint32(len(key)))
+	binary.LittleEndian.PutUint32(record[16:], uint32(len(value)))
+	copy(record[recordHeader:], key)
+	copy(record[recordHeader+len(key):], value)
+	binary.LittleEndian.PutUint32(record[8:], checksum(record[recordHeader:recordHeader+len(key)+len(value)]))
+	binary.LittleEndian.PutUint64(s.mem[offHead:], head)
+
+	// Слот того же ключа, свободный или указывающий на затертую запись,
+	// иначе слот самой старой записи
+	var target []byte
+	oldest := uint64(math.MaxUint64)
+	for i := uint64(0); i < probes; i++ {
+		slot := s.slot(hash + i)
+		slotHash, slotAbs := binary.LittleEndian.Uint64(slot), binary.LittleEndian.Uint64(slot[8:])
+		if slotHash == hash || slotHash == 0 || !s.live(slotAbs, head) {
+			target = slot
+			break
+		}
+		if slotAbs < oldest {
+			target, oldest = slot, slotAbs
+		}
+	}
+	if slotHash := binary.LittleEndian.Uint64(target); slotHash != 0 && slotHash != hash {
+		s.evictions.Add(1)
+	}
+	binary.LittleEndian.PutUint64(target, hash)
+	binary.LittleEndian.PutUint64(target[8:], abs)
+	s.stores.Add(1)
+	return nil
+}
+
+// indexSlots - число слотов индекса нового файла: степень двойки,
+// индекс занимает не больше восьмой части файла
+func indexSlots(size int64) uint64 {
+	slots := uint64(64)
+	for slots*2*slotSize <= uint64(size)/8 {
+		slots *= 2
+	}
+	return slots
+}
+
+func (s *Store) lock(how int) error {
+	return syscall.Flock(int(s.file.Fd()), how)
+}
+
+func (s *Store) lockShared() error {
+	s.readMu.Lock()
+	defer s.readMu.Unlock()
+	if s.readers == 0 {
+		if err := s.lock(syscall.LOCK_SH); err != nil {
+			return err
+		}
+	}
+	s.readers++
+	return nil
+}
+
+func (s *Store) unlockShared() {
+	s.readMu.Lock()
+	defer s.readMu.Unlock()
+	if s.readers--; s.readers == 0 {
+		s.lock(syscall.LOCK_UN)
+	}
+}
+
+func (s *Store) head() uint64 {
+	return binary.LittleEndian.Uint64(s.mem[offHead:])
+}
+
+func (s *Store) slot(i uint64) []byte {
+	offset := (i & (s.slots - 1)) * slotSize
+	return s.index[offset : offset+slotSize]
+}
+
+// live - запись по смещению abs еще не затерта последующими
+func (s *Store) live(abs, head uint64) bool {
+	return abs < head && head <= abs+s.dataSize
+}
+
+// record читает запись с проверкой границ и контрольной суммы: файл мог
+// остаться недописанным при аварийном завершении процесса
+func (s *Store) record(abs, head uint64) (key, value []byte, ok bool) {
+	if !s.live(abs, head) {
+		return nil, nil, false
+	}
+	pos := abs % s.dataSize
+	if pos+recordHeader > s.dataSize {
+		return nil, nil, false
+	}
+	header := s.data[pos : pos+recordHeader]
+	keyLen := uint64(binary.LittleEndian.Uint32(header[12:]))
+	valueLen := uint64(binary.LittleEndian.Uint32(header[16:]))
+	end := pos + recordHeader + keyLen + valueLen
+	if end > s.dataSize || end > pos+(head-abs) {
+		return nil, nil, false
+	}
+	body := s.data[pos+recordHeader : end]
+	if checksum(body) != binary.LittleEndian.Uint32(header[8:]) {
+		return nil, nil, false
+	}
+	return body[:keyLen], body[keyLen:], true
+}
+
+func hashKey(key string) uint64 {
+	h := fnv.New64a()
+	h.Write([]byte(key))
+	if sum := h.Sum64(); sum != 0 {
+		return sum
+	}
+	return 1 // 0 обозначает свободный слот
+}
+
+func checksum(body []byte) uint32 {
+	return crc32.ChecksumIEEE(body)
+}
+
+func align8(n uint64) uint64 {
+	return (n + 7) &^ 7
+}
+
+// Ответ: значение функции, число переменных, затем имя и значение каждой
+func encodeReplay(replay core.OptimizationReplay) []byte {
+	var buf bytes.Buffer
+	binary.Write(&buf, binary.LittleEndian, replay.FunctionValue)
+	binary.Write(&buf, binary.LittleEndian, uint32(len(replay.Variable)))
+	for _, v := range replay.Variable {
+		binary.Write(&buf, binary.LittleEndian, uint16(len(v.Name)))
+		buf.WriteString(v.Name)
+		binary.Write(&buf, binary.LittleEndian, v.Value)
+	}
+	return buf.Bytes()
+}
+
+func decodeReplay(value []byte) (core.OptimizationReplay, bool) {
+	if len(value) < 12 {
+		return core.OptimizationReplay{}, false
+	}
+	replay := core.OptimizationReplay{
+		FunctionValue: math.Float64frombits(binary.LittleEndian.Uint64(value)),
+	}
+	n := int(binary.LittleEndian.Uint32(value[8:]))
+	value = value[12:]
+	if n > len(value)/10 {
+		return core.OptimizationReplay{}, false
+	}
+	replay.Variable = make([]core.Variable, n)
+	for i := range replay.Variable {
+		if len(value) < 2 {
+			return core.OptimizationReplay{}, false
+		}
+		nameLen := int(binary.LittleEndian.Uint16(value))
+		if len(value) < 2+nameLen+8 {
+			return core.OptimizationReplay{}, false
+		}
+		replay.Variable[i] = core.Variable{
+			Name:  string(value[2 : 2+nameLen]),
+			Value: int64(binary.LittleEndian.Uint64(value[2+nameLen:])),
+		}
+		value = value[2+nameLen+8:]
+	}
+	return replay, true
+}
@@ -0,0 +1,28 @@
+//go:build !unix
+
+package resultstore
+
+import (
+	"awesomeProject2/optimization/core"
+	"errors"
+)
+
+var ErrUnsupported = errors.New("result cache requires a unix system")
+
+type Store struct{}
+
+func Open(path string, size int64) (*Store, error) {
+	return nil, ErrUnsupported
+}
+
+func (s *Store) Close() error { return nil }
+
+func (s *Store) Stats() Stats { return Stats{} }
+
+func (s *Store) Get(key string) (core.OptimizationReplay, bool) {
+	return core.OptimizationReplay{}, false
+}
+
+func (s *Store) Put(key string, replay core.OptimizationReplay) error {
+	return ErrUnsupported
+}
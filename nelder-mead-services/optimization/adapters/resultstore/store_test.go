@@ -0,0 +1,105 @@
+//go:build unix
+
+package resultstore
+
+import (
+	"awesomeProject2/optimization/core"
+	"fmt"
+	"path/filepath"
+	"reflect"
+	"testing"
+)
+
+func testReplay(i int) core.OptimizationReplay {
+	return core.OptimizationReplay{
+		Variable:      []core.Variable{{Name: "x1", Value: int64(i)}, {Name: "x2", Value: -1}},
+		FunctionValue: float64(i) / 3,
+	}
+}
+
+// Ответ виден другому отображению того же файла и после повторного открытия
+func TestStoreSharedAndPersistent(t *testing.T) {
+	path := filepath.Join(t.TempDir(), "results")
+	first, err := Open(path, 1<<20)
+	if err != nil {
+		t.Fatal(err)
+	}
+	second, err := Open(path, 0)
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	if _, ok := first.Get("f|tol=0"); ok {
+		t.Fatal("hit in an empty store")
+	}
+	if err := first.Put("f|tol=0", testReplay(7)); err != nil {
+		t.Fatal(err)
+	}
+	if got, ok := second.Get("f|tol=0"); !ok || !reflect.DeepEqual(got, testReplay(7)) {
+		t.Errorf("shared lookup: %+v, %v", got, ok)
+	}
+	first.Close()
+	second.Close()
+
+	reopened, err := Open(path, 0)
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer reopened.Close()
+	if got, ok := reopened.Get("f|tol=0"); !ok || !reflect.DeepEqual(got, testReplay(7)) {
+		t.Errorf("lookup after reopen: %+v, %v", got, ok)
+	}
+	if _, ok := reopened.Get("f|tol=1"); ok {
+		t.Error("hit for a different key")
+	}
+}
+
+// Объем файла не растет: старые ответы вытесняются новыми
+func TestStoreEviction(t *testing.T) {
+	store, err := Open(filepath.Join(t.TempDir(), "results"), 16<<10)
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer store.Close()
+
+	const keys = 2000
+	for i := 0; i < keys; i++ {
+		if err := store.Put(fmt.Sprintf("key-%d", i), testReplay(i)); err != nil {
+			t.Fatal(err)
+		}
+	}
+	if _, ok := store.Get("key-0"); ok {
+		t.Error("oldest record survived")
+	}
+	if got, ok := store.Get(fmt.Sprintf("key-%d", keys-1)); !ok || !reflect.DeepEqual(got, testReplay(keys-1)) {
+		t.Errorf("newest record: %+v, %v", got, ok)
+	}
+	// Каждый найденный ответ совпадает с записанным для этого ключа
+	for i := 0; i < keys; i++ {
+		if got, ok := store.Get(fmt.Sprintf("key-%d", i)); ok && !reflect.DeepEqual(got, testReplay(i)) {
+			t.Fatalf("key-%d: %+v", i, got)
+		}
+	}
+	if stats := store.Stats(); stats.Stores != keys || stats.Evictions == 0 {
+		t.Errorf("stats %+v", stats)
+	}
+}
+
+// Запуск: go test -bench StoreGet -benchmem
+func BenchmarkStoreGet(b *testing.B) {
+	store, err := Open(filepath.Join(b.TempDir(), "results"), 1<<20)
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer store.Close()
+	key := "100*(x2-x1^2)^2+(1-x1)^2|tol=1e-08|iter=500|x0=1|polish=true|radius=0"
+	if err := store.Put(key, testReplay(1)); err != nil {
+		b.Fatal(err)
+	}
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		if _, ok := store.Get(key); !ok {
+			b.Fatal("miss")
+		}
+	}
+}
@@ -3,11 +3,41 @@ package config
 import (
 	"github.com/ilyakaznacheev/cleanenv"
 	"log"
+	"time"
 )
 
 type Config struct {
 	LogLevel string `yaml:"log_level" env:"LOG_LEVEL" env-default:"DEBUG"`
-	Address  string `yaml:"address" env:"ADDRESS" env-default:"localhost:81"`
+	Address  string `yaml:"address" env:"ADDRESS" env-default:"localhost:81"` // host:port или unix:///path
+
+	CacheEntries   int     `yaml:"cache_entries" env:"CACHE_ENTRIES" env-default:"256"`
+	CacheNodes     int64   `yaml:"cache_nodes" env:"CACHE_NODES" env-default:"1048576"`
+	MetricsAddress string  `yaml:"metrics_address" env:"METRICS_ADDRESS" env-default:""`
+	Polish         bool    `yaml:"polish" env:"POLISH" env-default:"true"`
+	SearchRadius   float64 `yaml:"search_radius" env:"SEARCH_RADIUS" env-default:"0"`
+	RacingStarts   int     `yaml:"racing_starts" env:"RACING_STARTS" env-default:"0"`   // Гонка запусков вместо ветвей и границ, 0 - выключена
+	ScreenSamples  int     `yaml:"screen_samples" env:"SCREEN_SAMPLES" env-default:"0"` // Просмотр бокса перед запусками, 0 - выключен
+	ScreenStarts   int     `yaml:"screen_starts" env:"SCREEN_STARTS" env-default:"4"`
+
+	Workers    int           `yaml:"workers" env:"WORKERS" env-default:"0"`
+	PinThreads bool          `yaml:"pin_threads" env:"PIN_THREADS" env-default:"false"`
+	QueueLimit int           `yaml:"queue_limit" env:"QUEUE_LIMIT" env-default:"1024"`
+	MaxJobCost float64       `yaml:"max_job_cost" env:"MAX_JOB_COST" env-default:"0"`
+	DeferCost  float64       `yaml:"defer_cost" env:"DEFER_COST" env-default:"1e8"`
+	TimeSlice  time.Duration `yaml:"time_slice" env:"TIME_SLICE" env-default:"50ms"`
+
+	NativeWorkers int `yaml:"native_workers" env:"NATIVE_WORKERS" env-default:"0"` // Процессы-исполнители, 0 - только пул потоков
+
+	BatchWindow time.Duration `yaml:"batch_window" env:"BATCH_WINDOW" env-default:"0"`
+	BatchSize   int           `yaml:"batch_size" env:"BATCH_SIZE" env-default:"32"`
+
+	ResultCachePath  string        `yaml:"result_cache_path" env:"RESULT_CACHE_PATH" env-default:""`
+	ResultCacheSize  int64         `yaml:"result_cache_size" env:"RESULT_CACHE_SIZE" env-default:"67108864"`
+	ProgressInterval time.Duration `yaml:"progress_interval" env:"PROGRESS_INTERVAL" env-default:"100ms"`
+
+	JobLogPath          string        `yaml:"job_log_path" env:"JOB_LOG_PATH" env-default:""`
+	JobRetention        time.Duration `yaml:"job_retention" env:"JOB_RETENTION" env-default:"24h"`
+	JobSnapshotInterval time.Duration `yaml:"job_snapshot_interval" env:"JOB_SNAPSHOT_INTERVAL" env-default:"5s"`
 }
 
 func MustLoad(configPath string) Config {
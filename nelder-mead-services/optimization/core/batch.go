@@ -0,0 +1,42 @@
+package core
+
+import (
+	"context"
+	"sync"
+)
+
+// batchJobsPerWorker - сколько задач одного пакета одновременно находятся в
+// пуле на каждый поток: очередь не пустеет, но и не занимается пакетом целиком
+const batchJobsPerWorker = 2
+
+// OptimizationBatch решает задачи пакета параллельно на потоках пула и
+// сообщает результат каждой через report по мере готовности. Вызовы report
+// не пересекаются. После отмены ctx оставшиеся задачи не запускаются и
+// сообщаются с ошибкой ctx.Err().
+func (s *Service) OptimizationBatch(ctx context.Context, queries []OptimizationQuery, report func(index int, replay OptimizationReplay, err error)) {
+	var mu sync.Mutex
+	deliver := func(index int, replay OptimizationReplay, err error) {
+		mu.Lock()
+		defer mu.Unlock()
+		report(index, replay, err)
+	}
+
+	slots := make(chan struct{}, batchJobsPerWorker*s.pool.Size())
+	var wg sync.WaitGroup
+	for i, query := range queries {
+		select {
+		case slots <- struct{}{}:
+		case <-ctx.Done():
+			deliver(i, OptimizationReplay{}, ctx.Err())
+			continue
+		}
+		wg.Add(1)
+		go func(i int, query OptimizationQuery) {
+			defer wg.Done()
+			defer func() { <-slots }()
+			replay, err := s.Optimization(ctx, query)
+			deliver(i, replay, err)
+		}(i, query)
+	}
+	wg.Wait()
+}
@@ -0,0 +1,70 @@
+package core
+
+// #include "worker_pool.h"
+import "C"
+
+import (
+	"sync"
+	"time"
+)
+
+// Задачи не больше batchMaxDimension переменных собираются в пакеты
+const batchMaxDimension = 4
+
+// batcher копит мелкие задачи, пришедшие в течение window, и отправляет их
+// в пул одним пакетом: методы пакета выполняются одним потоком поочередно
+// по итерации, а результаты возвращаются каждому запросу по готовности
+type batcher struct {
+	pool    *WorkerPool
+	window  time.Duration
+	maxSize int
+
+	mu      sync.Mutex
+	pending []*nativeJob
+	timer   *time.Timer
+}
+
+func newBatcher(pool *WorkerPool, window time.Duration, maxSize int) *batcher {
+	return &batcher{pool: pool, window: window, maxSize: max(1, maxSize)}
+}
+
+func (b *batcher) Run(j *nativeJob) error {
+	handle, done := j.wait()
+	defer handle.Delete()
+
+	b.mu.Lock()
+	b.pending = append(b.pending, j)
+	full := len(b.pending) >= b.maxSize
+	if !full && b.timer == nil {
+		b.timer = time.AfterFunc(b.window, b.flush)
+	}
+	b.mu.Unlock()
+
+	if full {
+		b.flush()
+	}
+	return <-done
+}
+
+func (b *batcher) flush() {
+	b.mu.Lock()
+	jobs := b.pending
+	b.pending = nil
+	if b.timer != nil {
+		b.timer.Stop()
+		b.timer = nil
+	}
+	b.mu.Unlock()
+
+	if len(jobs) == 0 {
+		return
+	}
+	for i := 0; i+1 < len(jobs); i++ {
+		jobs[i].job.next = jobs[i+1].job
+	}
+	if err := b.pool.submitBatch(jobs[0].job); err != nil {
+		for _, j := range jobs {
+			j.done <- err
+		}
+	}
+}
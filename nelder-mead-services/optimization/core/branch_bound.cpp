@@ -0,0 +1,158 @@
+#include "branch_bound.h"
+#include "expression_impl.h"
+#include "worker_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <queue>
+#include <vector>
+
+namespace {
+
+struct Box {
+    std::vector<expr::Interval> sides;
+    double bound;        // нижняя граница значения на боксе
+    double center_value; // значение в центре
+
+    bool operator<(const Box& other) const {
+        // priority_queue выдает наибольший элемент, нужен бокс с меньшей границей
+        return bound > other.bound;
+    }
+};
+
+void center(const Box& box, std::vector<double>& point) {
+    for (size_t i = 0; i < box.sides.size(); ++i) point[i] = 0.5 * (box.sides[i].lo + box.sides[i].hi);
+}
+
+int widest_side(const Box& box) {
+    int widest = 0;
+    for (size_t i = 1; i < box.sides.size(); ++i) {
+        if (box.sides[i].hi - box.sides[i].lo > box.sides[widest].hi - box.sides[widest].lo) {
+            widest = static_cast<int>(i);
+        }
+    }
+    return widest;
+}
+
+double box_objective(double* x, int /*n*/, void* context) {
+    return static_cast<expr::Evaluator*>(context)->evaluate(x);
+}
+
+// Граница NaN (неопределенность на всем боксе) не позволяет отбросить бокс
+double lower_bound(expr::Evaluator& evaluator, const Box& box) {
+    double bound = evaluator.evaluate_interval(box.sides.data()).lo;
+    return std::isnan(bound) ? -HUGE_VAL : bound;
+}
+
+} // namespace
+
+
+BranchBoundParams create_default_branch_bound_params(void) {
+    BranchBoundParams params;
+    params.max_boxes = 2048;
+    params.starts = 8;
+    params.min_width = 1e-3;
+    return params;
+}
+
+int nelder_mead_optimize_branch_bound(
+    const ExprProgram* program,
+    double* x,
+    int n,
+    const double* lower,
+    const double* upper,
+    OptimizationParams* params,
+    const BranchBoundParams* bb_params,
+    double* final_value
+) {
+    if (!program || !x || !lower || !upper || !params || !bb_params || n <= 0) return -1;
+    const expr::Program& p = *program->program;
+    if (p.dimension() != n) return -1;
+
+    expr::Evaluator evaluator(p);
+    std::vector<double> point(n);
+    std::vector<double> best_point(x, x + n);
+    double best = evaluator.evaluate(x);
+    if (std::isnan(best)) best = HUGE_VAL;
+
+    Box root;
+    for (int i = 0; i < n; ++i) root.sides.push_back(expr::Interval(lower[i], upper[i]));
+    root.bound = lower_bound(evaluator, root);
+    center(root, point);
+    root.center_value = evaluator.evaluate(point.data());
+
+    std::priority_queue<Box> open;
+    std::vector<Box> leaves;
+    open.push(root);
+
+    // Разбиение: верхняя оценка минимума - лучшее значение в центрах боксов
+    for (int split = 0; split < bb_params->max_boxes && !open.empty(); ++split) {
+        Box box = open.top();
+        open.pop();
+        if (box.center_value < best) {
+            best = box.center_value;
+            center(box, best_point);
+        }
+        if (box.bound > best) continue;
+
+        int side = widest_side(box);
+        if (box.sides[side].hi - box.sides[side].lo < bb_params->min_width) {
+            leaves.push_back(box);
+            continue;
+        }
+        double middle = 0.5 * (box.sides[side].lo + box.sides[side].hi);
+        for (int half = 0; half < 2; ++half) {
+            Box child = box;
+            if (half == 0) child.sides[side].hi = middle;
+            else child.sides[side].lo = middle;
+            child.bound = lower_bound(evaluator, child);
+            center(child, point);
+            child.center_value = evaluator.evaluate(point.data());
+            if (child.center_value < best) {
+                best = child.center_value;
+                best_point = point;
+            }
+            if (child.bound <= best) open.push(child);
+        }
+    }
+
+    // Кандидаты - оставшиеся боксы, упорядоченные по значению в центре
+    std::vector<Box> candidates = leaves;
+    while (!open.empty()) {
+        if (open.top().bound <= best) candidates.push_back(open.top());
+        open.pop();
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Box& a, const Box& b) { return a.center_value < b.center_value; });
+    if (static_cast<int>(candidates.size()) > bb_params->starts) candidates.resize(std::max(0, bb_params->starts));
+
+    std::vector<std::vector<double>> starts(1, best_point);
+    for (const Box& box : candidates) {
+        center(box, point);
+        starts.push_back(point);
+    }
+
+    std::vector<double> results(starts.size(), HUGE_VAL);
+    std::atomic<int> next(0);
+    auto work = [&](int) {
+        expr::Evaluator local(p);
+        for (int k = next++; k < static_cast<int>(starts.size()); k = next++) {
+            double value = HUGE_VAL;
+            if (nelder_mead_optimize(box_objective, starts[k].data(), n, params, &local, &value) == 0 &&
+                !std::isnan(value)) {
+                results[k] = value;
+            }
+        }
+    };
+
+    worker_pool_parallel(static_cast<int>(starts.size()), work);
+
+    size_t winner = std::min_element(results.begin(), results.end()) - results.begin();
+    if (results[winner] < best) {
+        best = results[winner];
+        best_point = starts[winner];
+    }
+    std::copy(best_point.begin(), best_point.end(), x);
+    if (final_value) *final_value = best;
+    return std::isinf(best) && best > 0 ? -1 : 0;
+}
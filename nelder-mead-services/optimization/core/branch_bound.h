@@ -0,0 +1,41 @@
+#ifndef BRANCH_BOUND_H
+#define BRANCH_BOUND_H
+
+#include "expression.h"
+#include "nelder_mead.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+typedef struct {
+    int max_boxes;       // Предел числа разбиений (обычно 2048)
+    int starts;          // Сколько лучших боксов получают запуск метода (обычно 8)
+    double min_width;    // Более узкие боксы не делятся (обычно 1e-3)
+} BranchBoundParams;
+
+
+BranchBoundParams create_default_branch_bound_params(void);
+
+// Глобальный поиск на боксе [lower, upper]: боксы, нижняя граница которых
+// (интервальная оценка выражения) не лучше найденного значения, отбрасываются,
+// остальные делятся пополам по самой широкой стороне. Метод Нелдера-Мида
+// запускается параллельно из центров не более чем starts лучших боксов.
+// В x возвращается лучшая найденная точка.
+int nelder_mead_optimize_branch_bound(
+    const ExprProgram* program,
+    double* x,
+    int n,
+    const double* lower,
+    const double* upper,
+    OptimizationParams* params,
+    const BranchBoundParams* bb_params,
+    double* final_value
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BRANCH_BOUND_H
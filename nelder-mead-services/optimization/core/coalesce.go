@@ -0,0 +1,71 @@
+package core
+
+import (
+	"context"
+	"sync"
+	"sync/atomic"
+)
+
+// flight - выполняющаяся оптимизация, к которой присоединяются одинаковые запросы
+type flight struct {
+	done   chan struct{}
+	replay OptimizationReplay
+	err    error
+}
+
+// coalescer объединяет одновременные запросы с одинаковым ключом:
+// вычисление выполняет первый, остальные ждут и получают его результат
+type coalescer struct {
+	mu      sync.Mutex
+	flights map[string]*flight
+
+	leaders   atomic.Int64
+	coalesced atomic.Int64
+}
+
+func newCoalescer() *coalescer {
+	return &coalescer{flights: make(map[string]*flight)}
+}
+
+func (c *coalescer) Do(ctx context.Context, key string, fn func() (OptimizationReplay, error)) (OptimizationReplay, error) {
+	c.mu.Lock()
+	if f, ok := c.flights[key]; ok {
+		c.mu.Unlock()
+		c.coalesced.Add(1)
+		select {
+		case <-f.done:
+			return copyReplay(f.replay), f.err
+		case <-ctx.Done():
+			return OptimizationReplay{}, ctx.Err()
+		}
+	}
+	f := &flight{done: make(chan struct{})}
+	c.flights[key] = f
+	c.mu.Unlock()
+	c.leaders.Add(1)
+
+	f.replay, f.err = fn()
+
+	c.mu.Lock()
+	delete(c.flights, key)
+	c.mu.Unlock()
+	close(f.done)
+	return f.replay, f.err
+}
+
+func (c *coalescer) Stats() CoalesceStats {
+	c.mu.Lock()
+	inFlight := len(c.flights)
+	c.mu.Unlock()
+	return CoalesceStats{
+		Leaders:   c.leaders.Load(),
+		Coalesced: c.coalesced.Load(),
+		InFlight:  inFlight,
+	}
+}
+
+// Ответ отдается нескольким вызывающим, у каждого своя копия переменных
+func copyReplay(replay OptimizationReplay) OptimizationReplay {
+	replay.Variable = append([]Variable(nil), replay.Variable...)
+	return replay
+}
@@ -0,0 +1,266 @@
+#include "decomposition.h"
+#include "expression_impl.h"
+#include "worker_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace {
+
+// Целевая функция по подмножеству координат: остальные зафиксированы
+// в базовой точке вычислителя, пересчет идет через evaluate_delta.
+struct SubspaceObjective {
+    expr::Evaluator* evaluator;
+    std::vector<double> point;       // полная точка, совпадает с базовой вне vars
+    const std::vector<int>* vars;
+
+    void scatter(const double* x) {
+        for (size_t i = 0; i < vars->size(); ++i) point[(*vars)[i]] = x[i];
+    }
+};
+
+double subspace_objective(double* x, int n, void* context) {
+    SubspaceObjective* sub = static_cast<SubspaceObjective*>(context);
+    sub->scatter(x);
+    return sub->evaluator->evaluate_delta(sub->point.data(), sub->vars->data(), n);
+}
+
+// Одномерный симплекс с критерием по разбросу значений останавливается, как только
+// две вершины встают симметрично относительно минимума, поэтому одиночные
+// переменные объединяются в подзадачи размерности не меньше kMinSubproblemSize
+const size_t kMinSubproblemSize = 2;
+
+std::vector<std::vector<int>> pack_components(const std::vector<std::vector<int>>& components) {
+    std::vector<std::vector<int>> packed;
+    std::vector<int> bundle;
+    for (const auto& component : components) {
+        if (component.size() >= kMinSubproblemSize) {
+            packed.push_back(component);
+            continue;
+        }
+        bundle.insert(bundle.end(), component.begin(), component.end());
+        if (bundle.size() >= kMinSubproblemSize) {
+            packed.push_back(bundle);
+            bundle.clear();
+        }
+    }
+    if (!bundle.empty()) {
+        if (packed.empty()) packed.push_back(bundle);
+        else packed.back().insert(packed.back().end(), bundle.begin(), bundle.end());
+    }
+    return packed;
+}
+
+int worker_count(size_t jobs) {
+    return worker_pool_parallelism(static_cast<int>(jobs));
+}
+
+// Порядок переменных обходом в ширину по графу "встречаются в одном слагаемом",
+// чтобы соседние по смыслу переменные попадали в один блок
+std::vector<int> interaction_order(const expr::Program& p, const std::vector<std::vector<int>>& term_vars) {
+    std::vector<std::vector<int>> terms_of(p.dimension());
+    for (size_t t = 0; t < term_vars.size(); ++t) {
+        for (int v : term_vars[t]) terms_of[v].push_back(static_cast<int>(t));
+    }
+
+    std::vector<int> order;
+    std::vector<char> seen(p.dimension(), 0);
+    std::vector<char> term_seen(term_vars.size(), 0);
+    for (int start = 0; start < p.dimension(); ++start) {
+        if (seen[start]) continue;
+        seen[start] = 1;
+        size_t head = order.size();
+        order.push_back(start);
+        while (head < order.size()) {
+            int v = order[head++];
+            for (int t : terms_of[v]) {
+                if (term_seen[t]) continue;
+                term_seen[t] = 1;
+                for (int u : term_vars[t]) {
+                    if (seen[u]) continue;
+                    seen[u] = 1;
+                    order.push_back(u);
+                }
+            }
+        }
+    }
+    return order;
+}
+
+// Жадная раскраска блоков: блоки одного цвета не имеют общих слагаемых
+std::vector<std::vector<int>> color_blocks(int block_count, const std::vector<int>& block_of,
+                                           const std::vector<std::vector<int>>& term_vars) {
+    std::vector<std::vector<int>> neighbours(block_count);
+    for (const auto& vars : term_vars) {
+        std::vector<int> touched;
+        for (int v : vars) touched.push_back(block_of[v]);
+        std::sort(touched.begin(), touched.end());
+        touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+        for (int a : touched) {
+            for (int b : touched) {
+                if (a != b) neighbours[a].push_back(b);
+            }
+        }
+    }
+
+    std::vector<int> color(block_count, -1);
+    std::vector<std::vector<int>> classes;
+    for (int b = 0; b < block_count; ++b) {
+        std::vector<char> used(classes.size() + 1, 0);
+        for (int other : neighbours[b]) {
+            if (color[other] >= 0) used[color[other]] = 1;
+        }
+        int c = 0;
+        while (used[c]) ++c;
+        color[b] = c;
+        if (c == static_cast<int>(classes.size())) classes.push_back(std::vector<int>());
+        classes[c].push_back(b);
+    }
+    return classes;
+}
+
+} // namespace
+
+
+int nelder_mead_optimize_separable(
+    const ExprProgram* program,
+    double* x,
+    int n,
+    OptimizationParams* params,
+    double* final_value
+) {
+    if (!program || !x || !params || n <= 0) return -1;
+    const expr::Program& p = *program->program;
+    if (p.dimension() != n) return -1;
+
+    std::vector<std::vector<int>> components = pack_components(expr::separable_components(p));
+    std::vector<double> x0(x, x + n);
+    std::atomic<int> next(0);
+    std::atomic<int> status(0);
+
+    // Каждый поток держит свой вычислитель с базой в x0 и берет подзадачи по очереди
+    auto work = [&](int) {
+        expr::Evaluator evaluator(p);
+        evaluator.evaluate(x0.data());
+        SubspaceObjective sub;
+        sub.evaluator = &evaluator;
+        sub.point = x0;
+
+        for (int c = next++; c < static_cast<int>(components.size()); c = next++) {
+            const std::vector<int>& vars = components[c];
+            std::vector<double> local(vars.size());
+            for (size_t i = 0; i < vars.size(); ++i) local[i] = x0[vars[i]];
+
+            sub.vars = &vars;
+            if (nelder_mead_optimize(subspace_objective, local.data(), static_cast<int>(vars.size()),
+                                     params, &sub, nullptr) != 0) {
+                status = -1;
+            }
+            // Подзадачи не пересекаются по переменным, запись в x без блокировок
+            for (size_t i = 0; i < vars.size(); ++i) {
+                x[vars[i]] = local[i];
+                sub.point[vars[i]] = x0[vars[i]];
+            }
+        }
+    };
+
+    worker_pool_parallel(static_cast<int>(components.size()), work);
+
+    if (final_value) {
+        expr::Evaluator evaluator(p);
+        *final_value = evaluator.evaluate(x);
+    }
+    return status;
+}
+
+
+BlockParams create_default_block_params(void) {
+    BlockParams params;
+    params.block_size = 4;
+    params.sweep_iter = 50;
+    params.max_sweeps = 100;
+    return params;
+}
+
+int nelder_mead_optimize_blocks(
+    const ExprProgram* program,
+    double* x,
+    int n,
+    OptimizationParams* params,
+    const BlockParams* block_params,
+    double* final_value
+) {
+    if (!program || !x || !params || !block_params || n <= 0) return -1;
+    const expr::Program& p = *program->program;
+    if (p.dimension() != n || block_params->block_size <= 0) return -1;
+
+    std::vector<std::vector<int>> term_vars = expr::term_variables(p);
+
+    std::vector<int> order = interaction_order(p, term_vars);
+    std::vector<std::vector<int>> blocks;
+    std::vector<int> block_of(n);
+    for (size_t i = 0; i < order.size(); i += block_params->block_size) {
+        size_t end = std::min(order.size(), i + block_params->block_size);
+        if (end - i < kMinSubproblemSize && !blocks.empty()) {
+            blocks.back().insert(blocks.back().end(), order.begin() + i, order.begin() + end);
+        } else {
+            blocks.push_back(std::vector<int>(order.begin() + i, order.begin() + end));
+        }
+        for (size_t j = i; j < end; ++j) block_of[order[j]] = static_cast<int>(blocks.size()) - 1;
+    }
+    std::vector<std::vector<int>> colors = color_blocks(static_cast<int>(blocks.size()), block_of, term_vars);
+
+    OptimizationParams sweep = *params;
+    sweep.max_iter = block_params->sweep_iter;
+
+    int workers = worker_count(blocks.size());
+    std::vector<std::unique_ptr<expr::Evaluator>> evaluators;
+    for (int t = 0; t < workers; ++t) evaluators.push_back(std::unique_ptr<expr::Evaluator>(new expr::Evaluator(p)));
+
+    std::vector<double> snapshot(x, x + n);
+    double value = evaluators[0]->evaluate(x);
+    std::atomic<int> status(0);
+
+    for (int pass = 0; pass < block_params->max_sweeps; ++pass) {
+        for (const std::vector<int>& color : colors) {
+            std::copy(x, x + n, snapshot.begin());
+            std::atomic<int> next(0);
+
+            // Блоки одного цвета не делят слагаемых, их вклады в значение независимы
+            auto work = [&](int worker) {
+                expr::Evaluator& evaluator = *evaluators[worker];
+                evaluator.evaluate(snapshot.data());
+                SubspaceObjective sub;
+                sub.evaluator = &evaluator;
+                sub.point = snapshot;
+
+                for (int k = next++; k < static_cast<int>(color.size()); k = next++) {
+                    const std::vector<int>& vars = blocks[color[k]];
+                    std::vector<double> local(vars.size());
+                    for (size_t i = 0; i < vars.size(); ++i) local[i] = snapshot[vars[i]];
+
+                    sub.vars = &vars;
+                    if (nelder_mead_optimize(subspace_objective, local.data(), static_cast<int>(vars.size()),
+                                             &sweep, &sub, nullptr) != 0) {
+                        status = -1;
+                    }
+                    for (size_t i = 0; i < vars.size(); ++i) {
+                        x[vars[i]] = local[i];
+                        sub.point[vars[i]] = snapshot[vars[i]];
+                    }
+                }
+            };
+
+            worker_pool_parallel(static_cast<int>(color.size()), work);
+        }
+
+        double updated = evaluators[0]->evaluate(x);
+        bool converged = !(value - updated >= params->tolerance);
+        value = updated;
+        if (converged || status != 0) break;
+    }
+
+    if (final_value) *final_value = value;
+    return status;
+}
@@ -0,0 +1,51 @@
+#ifndef DECOMPOSITION_H
+#define DECOMPOSITION_H
+
+#include "expression.h"
+#include "nelder_mead.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+typedef struct {
+    int block_size;      // Число переменных в блоке (обычно 4)
+    int sweep_iter;      // Итераций метода на блок за один проход (обычно 50)
+    int max_sweeps;      // Максимальное число проходов по всем блокам
+} BlockParams;
+
+
+BlockParams create_default_block_params(void);
+
+
+// Оптимизация сепарабельного выражения: независимые группы переменных
+// решаются отдельными вызовами nelder_mead_optimize параллельно,
+// затем решения собираются в x.
+int nelder_mead_optimize_separable(
+    const ExprProgram* program,  // Скомпилированное выражение
+    double* x,                   // Начальное приближение (будет содержать результат)
+    int n,                       // Размерность задачи
+    OptimizationParams* params,  // Параметры метода (для каждой подзадачи)
+    double* final_value          // Итоговое значение функции
+);
+
+// Блочно-покоординатный метод для частично сепарабельных выражений:
+// переменные разбиваются на блоки по графу зависимостей, на каждом проходе
+// блок оптимизируется коротким запуском метода при фиксированных остальных.
+// Блоки без общих слагаемых обрабатываются параллельно. Останавливается,
+// когда проход улучшает значение меньше чем на params->tolerance.
+int nelder_mead_optimize_blocks(
+    const ExprProgram* program,
+    double* x,
+    int n,
+    OptimizationParams* params,
+    const BlockParams* block_params,
+    double* final_value
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DECOMPOSITION_H
@@ -2,4 +2,11 @@ package core
 
 import "errors"
 
-var ErrOptimizationFailed = errors.New("optimization failed")
+var (
+	ErrOptimizationFailed = errors.New("optimization failed")
+	ErrOverloaded         = errors.New("optimization queue is full")
+	ErrJobTooCostly       = errors.New("optimization job exceeds the cost limit")
+	ErrJobNotFound        = errors.New("optimization job not found")
+	ErrWorkerCrashed      = errors.New("optimization worker process crashed")
+	ErrInvalidIsland      = errors.New("invalid island task")
+)
@@ -0,0 +1,1506 @@
+#include "expression_impl.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+namespace expr {
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+
+// Номера переменных x[k], порождаемых циклами, и суммарное число итераций циклов
+const long long kMaxVariableNumber = 1 << 20;
+const long long kMaxLoopIterations = 10000000;
+
+struct FunctionName {
+    const char* name;
+    Op op;
+};
+
+const FunctionName kFunctions[] = {
+    {"sin", OP_SIN}, {"cos", OP_COS}, {"tan", OP_TAN}, {"exp", OP_EXP},
+    {"log", OP_LOG}, {"sqrt", OP_SQRT}, {"abs", OP_ABS},
+};
+
+// Рекурсивный спуск:
+//   expr    := term (('+'|'-') term)*
+//   term    := unary (('*'|'/') unary)*
+//   unary   := ('-'|'+') unary | power
+//   power   := primary ('^' exponent)*      (левоассоциативно, как в service.go)
+//   primary := number | xN | x '[' expr ']' | pi | index | func '(' expr ')' | '(' expr ')'
+//            | ('sum'|'prod') '(' index ',' expr ',' expr ',' expr ')'
+// Индекс в x[...] должен быть целочисленной аффинной функцией индексов циклов,
+// границы циклов - целыми константами.
+class Parser {
+public:
+    explicit Parser(const std::string& source) : pos_(0) {
+        for (char c : source) {
+            if (!std::isspace(static_cast<unsigned char>(c))) {
+                text_ += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            }
+        }
+    }
+
+    ParseResult run() {
+        ParseResult result;
+        if (text_.empty()) {
+            result.error = "empty expression";
+            return result;
+        }
+        std::unique_ptr<Ast> root = parse_expr();
+        if (error_.empty() && pos_ != text_.size()) {
+            fail("unexpected symbol");
+        }
+        if (!error_.empty()) {
+            result.error = error_;
+            return result;
+        }
+        result.root = std::move(root);
+        result.variables = variables_;
+        return result;
+    }
+
+private:
+    char peek() const { return pos_ < text_.size() ? text_[pos_] : '\0'; }
+
+    void fail(const char* message) {
+        if (error_.empty()) {
+            error_ = std::string(message) + " at position " + std::to_string(pos_);
+        }
+    }
+
+    std::unique_ptr<Ast> parse_expr() {
+        std::unique_ptr<Ast> first = parse_term();
+        if (peek() != '+' && peek() != '-') return first;
+
+        std::unique_ptr<Ast> sum(new Ast(OP_SUM));
+        sum->args.push_back(std::move(first));
+        sum->inverted.push_back(0);
+        while (error_.empty() && (peek() == '+' || peek() == '-')) {
+            char sign = text_[pos_++];
+            sum->args.push_back(parse_term());
+            sum->inverted.push_back(sign == '-');
+        }
+        return sum;
+    }
+
+    std::unique_ptr<Ast> parse_term() {
+        std::unique_ptr<Ast> first = parse_unary();
+        if (peek() != '*' && peek() != '/') return first;
+
+        std::unique_ptr<Ast> product(new Ast(OP_PRODUCT));
+        product->args.push_back(std::move(first));
+        product->inverted.push_back(0);
+        while (error_.empty() && (peek() == '*' || peek() == '/')) {
+            char sign = text_[pos_++];
+            product->args.push_back(parse_unary());
+            product->inverted.push_back(sign == '/');
+        }
+        return product;
+    }
+
+    std::unique_ptr<Ast> parse_unary() {
+        if (peek() == '-' || peek() == '+') {
+            char sign = text_[pos_++];
+            std::unique_ptr<Ast> operand = parse_unary();
+            if (sign == '+') return operand;
+            std::unique_ptr<Ast> neg(new Ast(OP_NEG));
+            neg->args.push_back(std::move(operand));
+            return neg;
+        }
+        return parse_power();
+    }
+
+    std::unique_ptr<Ast> parse_power() {
+        std::unique_ptr<Ast> base = parse_primary();
+        while (error_.empty() && peek() == '^') {
+            ++pos_;
+            std::unique_ptr<Ast> exponent;
+            if (peek() == '-' || peek() == '+') {
+                exponent = parse_unary();
+            } else {
+                exponent = parse_primary();
+            }
+            std::unique_ptr<Ast> power(new Ast(OP_POW));
+            power->args.push_back(std::move(base));
+            power->args.push_back(std::move(exponent));
+            base = std::move(power);
+        }
+        return base;
+    }
+
+    std::unique_ptr<Ast> parse_primary() {
+        char c = peek();
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+            return parse_number();
+        }
+        if (c == '(') {
+            ++pos_;
+            std::unique_ptr<Ast> inner = parse_expr();
+            expect(')');
+            return inner;
+        }
+        if (std::isalpha(static_cast<unsigned char>(c))) {
+            return parse_identifier();
+        }
+        fail(c == '\0' ? "unexpected end of expression" : "unexpected symbol");
+        return std::unique_ptr<Ast>(new Ast(OP_CONST));
+    }
+
+    std::unique_ptr<Ast> parse_number() {
+        const char* begin = text_.c_str() + pos_;
+        char* end = nullptr;
+        double value = std::strtod(begin, &end);
+        if (end == begin) {
+            fail("invalid number");
+            return std::unique_ptr<Ast>(new Ast(OP_CONST));
+        }
+        pos_ += static_cast<size_t>(end - begin);
+        std::unique_ptr<Ast> node(new Ast(OP_CONST));
+        node->value = value;
+        return node;
+    }
+
+    std::unique_ptr<Ast> parse_identifier() {
+        size_t start = pos_;
+        while (std::isalpha(static_cast<unsigned char>(peek()))) ++pos_;
+        std::string name = text_.substr(start, pos_ - start);
+
+        if (name == "x" && std::isdigit(static_cast<unsigned char>(peek()))) {
+            while (std::isdigit(static_cast<unsigned char>(peek()))) ++pos_;
+            std::unique_ptr<Ast> node(new Ast(OP_VAR));
+            node->var = variable_index(text_.substr(start, pos_ - start));
+            return node;
+        }
+        if (name == "x" && peek() == '[') {
+            return parse_indexed_variable();
+        }
+        if (name == "sum" || name == "prod") {
+            return parse_loop(name == "sum" ? OP_LOOP_SUM : OP_LOOP_PROD);
+        }
+        for (size_t depth = 0; depth < indices_.size(); ++depth) {
+            if (name == indices_[depth]) {
+                std::unique_ptr<Ast> node(new Ast(OP_INDEX));
+                node->var = static_cast<int>(depth);
+                return node;
+            }
+        }
+        if (name == "pi") {
+            std::unique_ptr<Ast> node(new Ast(OP_CONST));
+            node->value = kPi;
+            return node;
+        }
+        for (const FunctionName& function : kFunctions) {
+            if (name == function.name) {
+                expect('(');
+                std::unique_ptr<Ast> node(new Ast(function.op));
+                node->args.push_back(parse_expr());
+                expect(')');
+                return node;
+            }
+        }
+        pos_ = start;
+        fail("unknown identifier");
+        return std::unique_ptr<Ast>(new Ast(OP_CONST));
+    }
+
+    std::unique_ptr<Ast> parse_indexed_variable() {
+        ++pos_;
+        std::unique_ptr<Ast> index = parse_expr();
+        expect(']');
+        std::unique_ptr<Ast> node(new Ast(OP_VARREF));
+        if (!error_.empty()) return node;
+
+        std::vector<double> affine(indices_.size() + 1, 0.0);
+        if (!affine_of(*index, affine)) {
+            fail("index of x[...] must be an integer affine function of loop indices");
+            return node;
+        }
+        for (double c : affine) node->affine.push_back(static_cast<long long>(c));
+
+        bool constant = true;
+        for (size_t d = 1; d < affine.size(); ++d) {
+            if (affine[d] != 0.0) constant = false;
+        }
+        if (constant) {
+            if (node->affine[0] < 0) {
+                fail("variable number must be non-negative");
+                return node;
+            }
+            node->op = OP_VAR;
+            node->var = variable_index("x" + std::to_string(node->affine[0]));
+            node->affine.clear();
+            return node;
+        }
+        register_indexed(node->affine);
+        return node;
+    }
+
+    std::unique_ptr<Ast> parse_loop(Op op) {
+        std::unique_ptr<Ast> node(new Ast(op));
+        expect('(');
+        size_t start = pos_;
+        while (std::isalpha(static_cast<unsigned char>(peek()))) ++pos_;
+        std::string index = text_.substr(start, pos_ - start);
+        if (error_.empty() && (index.empty() || index == "x" || index == "pi")) {
+            pos_ = start;
+            fail("expected loop index name");
+        }
+        expect(',');
+        node->lo = parse_bound();
+        expect(',');
+        node->hi = parse_bound();
+        expect(',');
+        if (!error_.empty()) return node;
+        if (indices_.size() >= static_cast<size_t>(kMaxLoopDepth)) {
+            fail("loops are nested too deeply");
+            return node;
+        }
+
+        long long total = std::max(0, node->hi - node->lo + 1);
+        for (const auto& range : ranges_) total *= std::max(0, range.second - range.first + 1);
+        if (total > kMaxLoopIterations) {
+            fail("loop is too large");
+            return node;
+        }
+
+        indices_.push_back(index);
+        ranges_.push_back(std::make_pair(node->lo, node->hi));
+        node->args.push_back(parse_expr());
+        indices_.pop_back();
+        ranges_.pop_back();
+        expect(')');
+        return node;
+    }
+
+    int parse_bound() {
+        std::unique_ptr<Ast> bound = parse_expr();
+        if (!error_.empty()) return 0;
+        std::vector<double> affine(indices_.size() + 1, 0.0);
+        bool constant = affine_of(*bound, affine);
+        for (size_t d = 1; d < affine.size(); ++d) {
+            if (affine[d] != 0.0) constant = false;
+        }
+        if (!constant || std::fabs(affine[0]) > 1e9) {
+            fail("loop bounds must be integer constants");
+            return 0;
+        }
+        return static_cast<int>(affine[0]);
+    }
+
+    // Разбор индексного выражения как c0 + sum(c[d] * i_d) с целыми коэффициентами
+    static bool affine_of(const Ast& ast, std::vector<double>& out) {
+        std::fill(out.begin(), out.end(), 0.0);
+        switch (ast.op) {
+        case OP_CONST:
+            out[0] = ast.value;
+            break;
+        case OP_INDEX:
+            out[ast.var + 1] = 1.0;
+            break;
+        case OP_NEG:
+            if (!affine_of(*ast.args[0], out)) return false;
+            for (double& c : out) c = -c;
+            break;
+        case OP_SUM: {
+            std::vector<double> term(out.size());
+            for (size_t i = 0; i < ast.args.size(); ++i) {
+                if (!affine_of(*ast.args[i], term)) return false;
+                for (size_t d = 0; d < out.size(); ++d) out[d] += ast.inverted[i] ? -term[d] : term[d];
+            }
+            break;
+        }
+        case OP_PRODUCT: {
+            // Допускается не более одного множителя, зависящего от индексов
+            std::vector<double> term(out.size());
+            out[0] = 1.0;
+            bool linear = false;
+            for (size_t i = 0; i < ast.args.size(); ++i) {
+                if (!affine_of(*ast.args[i], term)) return false;
+                bool is_constant = true;
+                for (size_t d = 1; d < term.size(); ++d) {
+                    if (term[d] != 0.0) is_constant = false;
+                }
+                if (is_constant) {
+                    double factor = ast.inverted[i] ? 1.0 / term[0] : term[0];
+                    for (double& c : out) c *= factor;
+                } else {
+                    if (linear || ast.inverted[i]) return false;
+                    linear = true;
+                    double factor = out[0];
+                    for (size_t d = 0; d < out.size(); ++d) out[d] = term[d] * factor;
+                }
+            }
+            break;
+        }
+        default:
+            return false;
+        }
+        for (double c : out) {
+            if (!std::isfinite(c) || c != std::floor(c)) return false;
+        }
+        return true;
+    }
+
+    // Регистрация всех переменных, которых коснется x[...] при обходе циклов
+    void register_indexed(const std::vector<long long>& affine) {
+        std::vector<int> depths;
+        for (size_t d = 1; d < affine.size(); ++d) {
+            // Тело цикла с пустым диапазоном не выполняется ни разу
+            if (ranges_[d - 1].second < ranges_[d - 1].first) return;
+            if (affine[d] != 0) depths.push_back(static_cast<int>(d) - 1);
+        }
+
+        std::vector<long long> current(depths.size());
+        for (size_t k = 0; k < depths.size(); ++k) current[k] = ranges_[depths[k]].first;
+        while (true) {
+            long long number = affine[0];
+            for (size_t k = 0; k < depths.size(); ++k) number += affine[depths[k] + 1] * current[k];
+            if (number < 0 || number > kMaxVariableNumber) {
+                fail("variable number in x[...] is out of range");
+                return;
+            }
+            variable_index("x" + std::to_string(number));
+
+            size_t k = depths.size();
+            while (k > 0 && current[k - 1] == ranges_[depths[k - 1]].second) {
+                current[k - 1] = ranges_[depths[k - 1]].first;
+                --k;
+            }
+            if (k == 0) break;
+            ++current[k - 1];
+        }
+    }
+
+    void expect(char c) {
+        if (peek() != c) {
+            fail((std::string("expected '") + c + "'").c_str());
+            return;
+        }
+        ++pos_;
+    }
+
+    int variable_index(const std::string& name) {
+        auto found = variable_ids_.find(name);
+        if (found != variable_ids_.end()) return found->second;
+        int index = static_cast<int>(variables_.size());
+        variables_.push_back(name);
+        variable_ids_[name] = index;
+        return index;
+    }
+
+    std::string text_;
+    size_t pos_;
+    std::string error_;
+    std::vector<std::string> variables_;
+    std::unordered_map<std::string, int> variable_ids_;
+    std::vector<std::string> indices_;
+    std::vector<std::pair<int, int>> ranges_;
+};
+
+
+// Прямой режим дифференцирования: значение и производная по направлению
+Dual& operator+=(Dual& a, const Dual& b) {
+    a.value += b.value;
+    a.derivative += b.derivative;
+    return a;
+}
+
+Dual& operator-=(Dual& a, const Dual& b) {
+    a.value -= b.value;
+    a.derivative -= b.derivative;
+    return a;
+}
+
+Dual& operator*=(Dual& a, const Dual& b) {
+    a.derivative = a.derivative * b.value + a.value * b.derivative;
+    a.value *= b.value;
+    return a;
+}
+
+Dual& operator/=(Dual& a, const Dual& b) {
+    a.value /= b.value;
+    a.derivative = (a.derivative - a.value * b.derivative) / b.value;
+    return a;
+}
+
+double power(double a, double b) {
+    return std::pow(a, b);
+}
+
+Dual power(const Dual& a, const Dual& b) {
+    Dual result(std::pow(a.value, b.value));
+    if (a.derivative != 0.0) result.derivative += b.value * std::pow(a.value, b.value - 1.0) * a.derivative;
+    if (b.derivative != 0.0) result.derivative += result.value * std::log(a.value) * b.derivative;
+    return result;
+}
+
+// Интервальная арифметика для оценки функции на боксе
+const double kInf = std::numeric_limits<double>::infinity();
+
+Interval whole() {
+    return Interval(-kInf, kInf);
+}
+
+// Произведения вида 0 * inf дают NaN - такой отрезок заменяется всей прямой
+Interval checked(double lo, double hi) {
+    if (std::isnan(lo) || std::isnan(hi)) return whole();
+    return Interval(lo, hi);
+}
+
+Interval& operator+=(Interval& a, const Interval& b) {
+    a = checked(a.lo + b.lo, a.hi + b.hi);
+    return a;
+}
+
+Interval& operator-=(Interval& a, const Interval& b) {
+    a = checked(a.lo - b.hi, a.hi - b.lo);
+    return a;
+}
+
+Interval& operator*=(Interval& a, const Interval& b) {
+    double p[] = { a.lo * b.lo, a.lo * b.hi, a.hi * b.lo, a.hi * b.hi };
+    a = checked(*std::min_element(p, p + 4), *std::max_element(p, p + 4));
+    return a;
+}
+
+Interval& operator/=(Interval& a, const Interval& b) {
+    if (b.lo <= 0.0 && b.hi >= 0.0) {
+        a = whole();
+        return a;
+    }
+    return a *= Interval(1.0 / b.hi, 1.0 / b.lo);
+}
+
+Interval power(const Interval& a, const Interval& b) {
+    if (b.lo == b.hi && b.lo == std::floor(b.lo) && std::fabs(b.lo) < 1e9) {
+        double k = b.lo;
+        if (k == 0.0) return Interval(1.0);
+        if (k < 0.0) {
+            Interval result(1.0);
+            return result /= power(a, Interval(-k));
+        }
+        double lo = std::pow(a.lo, k), hi = std::pow(a.hi, k);
+        if (std::fmod(k, 2.0) != 0.0) return checked(lo, hi);
+        if (a.lo >= 0.0) return checked(lo, hi);
+        if (a.hi <= 0.0) return checked(hi, lo);
+        return checked(0.0, std::max(lo, hi));
+    }
+    // Нецелая степень определена при основании >= 0
+    if (a.hi < 0.0) return whole();
+    Interval base(std::max(a.lo, 0.0), a.hi);
+    double p[] = { std::pow(base.lo, b.lo), std::pow(base.lo, b.hi), std::pow(base.hi, b.lo), std::pow(base.hi, b.hi) };
+    return checked(*std::min_element(p, p + 4), *std::max_element(p, p + 4));
+}
+
+// Синус на отрезке: концы плюс экстремумы pi/2 + k*pi внутри
+Interval interval_sin(const Interval& a) {
+    if (!(a.hi - a.lo < 2.0 * kPi)) return Interval(-1.0, 1.0);
+    double lo = std::min(std::sin(a.lo), std::sin(a.hi));
+    double hi = std::max(std::sin(a.lo), std::sin(a.hi));
+    double k = std::ceil((a.lo - kPi / 2.0) / kPi);
+    for (double t = kPi / 2.0 + k * kPi; t <= a.hi; t += kPi) {
+        if (std::sin(t) > 0.0) hi = 1.0;
+        else lo = -1.0;
+    }
+    return Interval(lo, hi);
+}
+
+// Производная элементарной функции op в точке a при значении value = op(a)
+double unary_derivative(unsigned char op, double a, double value) {
+    switch (op) {
+    case OP_NEG: return -1.0;
+    case OP_SIN: return std::cos(a);
+    case OP_COS: return -std::sin(a);
+    case OP_TAN: return 1.0 + value * value;
+    case OP_EXP: return value;
+    case OP_LOG: return 1.0 / a;
+    case OP_SQRT: return 0.5 / value;
+    case OP_ABS: return a > 0.0 ? 1.0 : (a < 0.0 ? -1.0 : 0.0);
+    default: return 1.0;
+    }
+}
+
+template <class T, class Get>
+T compute_node(const Program& p, int id, Get get) {
+    const int* a = p.args.data() + p.arg_begin[id];
+    const char* inv = p.inverted.data() + p.arg_begin[id];
+    int count = p.arg_count(id);
+
+    switch (p.op[id]) {
+    case OP_CONST:
+        return T(p.value[id]);
+    case OP_SUM: {
+        T sum = T(0.0);
+        for (int i = 0; i < count; ++i) {
+            if (inv[i]) sum -= get(a[i]);
+            else sum += get(a[i]);
+        }
+        return sum;
+    }
+    case OP_PRODUCT: {
+        T product = T(1.0);
+        for (int i = 0; i < count; ++i) {
+            if (inv[i]) product /= get(a[i]);
+            else product *= get(a[i]);
+        }
+        return product;
+    }
+    case OP_POW:
+        return power(get(a[0]), get(a[1]));
+    default:
+        return apply_unary(p.op[id], get(a[0]));
+    }
+}
+
+
+long long ref_number(const IndexRef& ref, const int* indices) {
+    long long number = ref.offset;
+    for (size_t d = 0; d < ref.coef.size(); ++d) number += ref.coef[d] * indices[d];
+    return number;
+}
+
+// Рабочие буферы тел циклов по уровням вложенности (свои у каждого потока)
+template <class T>
+std::vector<T>& loop_buffer(int level) {
+    static thread_local std::vector<T> buffers[kMaxLoopDepth];
+    return buffers[level];
+}
+
+std::vector<double>& loop_adjoints(int level) {
+    static thread_local std::vector<double> buffers[kMaxLoopDepth];
+    return buffers[level];
+}
+
+template <class Var>
+auto run_loop(const Program& top, const Loop& loop, unsigned char op, int* indices, int depth, Var var_value)
+    -> decltype(var_value(0));
+
+// Одна итерация: тело выполняется по своей программе, indices[0..depth) - индексы
+// объемлющих циклов, var_value(v) - значение переменной v верхней программы.
+// Значения узлов тела остаются в loop_buffer(depth - 1).
+template <class Var>
+auto run_body(const Program& top, const Program& body, int* indices, int depth, Var var_value)
+    -> decltype(var_value(0)) {
+    typedef decltype(var_value(0)) T;
+    std::vector<T>& values = loop_buffer<T>(depth - 1);
+    if (values.size() < body.op.size()) values.resize(body.op.size());
+
+    for (int id = 0; id < body.size(); ++id) {
+        switch (body.op[id]) {
+        case OP_VAR:
+            values[id] = var_value(body.var[id]);
+            break;
+        case OP_INDEX:
+            values[id] = T(indices[body.var[id]]);
+            break;
+        case OP_VARREF:
+            values[id] = var_value(top.var_by_number[ref_number(body.refs[body.var[id]], indices)]);
+            break;
+        case OP_LOOP_SUM:
+        case OP_LOOP_PROD:
+            values[id] = run_loop(top, body.loops[body.var[id]], body.op[id], indices, depth, var_value);
+            break;
+        default:
+            values[id] = compute_node<T>(body, id, [&values](int arg) { return values[arg]; });
+        }
+    }
+    return values[body.root];
+}
+
+template <class Var>
+auto run_loop(const Program& top, const Loop& loop, unsigned char op, int* indices, int depth, Var var_value)
+    -> decltype(var_value(0)) {
+    typedef decltype(var_value(0)) T;
+    T result = T(op == OP_LOOP_SUM ? 0.0 : 1.0);
+    for (int i = loop.lo; i <= loop.hi; ++i) {
+        indices[depth] = i;
+        T value = run_body(top, *loop.body, indices, depth + 1, var_value);
+        if (op == OP_LOOP_SUM) result += value;
+        else result *= value;
+    }
+    return result;
+}
+
+// Цикл узла id верхней программы
+template <class Var>
+auto loop_value(const Program& p, int id, Var var_value) -> decltype(var_value(0)) {
+    int indices[kMaxLoopDepth];
+    return run_loop(p, p.loops[p.var[id]], p.op[id], indices, 0, var_value);
+}
+
+
+// Обратный проход по одному узлу: push(arg, вклад) для каждого аргумента,
+// value(k) - значение узла k, посчитанное прямым проходом
+template <class Get, class Push>
+void backprop_node(const Program& p, int id, double adjoint, Get value, Push push) {
+    const int* a = p.args.data() + p.arg_begin[id];
+    const char* inv = p.inverted.data() + p.arg_begin[id];
+    int count = p.arg_count(id);
+
+    switch (p.op[id]) {
+    case OP_SUM:
+        for (int i = 0; i < count; ++i) push(a[i], inv[i] ? -adjoint : adjoint);
+        break;
+    case OP_PRODUCT: {
+        double product = value(id);
+        for (int i = 0; i < count; ++i) {
+            double factor = value(a[i]);
+            double partial;
+            if (factor != 0.0 && std::isfinite(product)) {
+                partial = inv[i] ? -product / factor : product / factor;
+            } else {
+                // Нулевой множитель: произведение остальных считается явно
+                partial = 1.0;
+                for (int j = 0; j < count; ++j) {
+                    if (j == i) continue;
+                    if (inv[j]) partial /= value(a[j]);
+                    else partial *= value(a[j]);
+                }
+                if (inv[i]) partial = -partial / (factor * factor);
+            }
+            push(a[i], adjoint * partial);
+        }
+        break;
+    }
+    case OP_POW: {
+        double base = value(a[0]);
+        double exponent = value(a[1]);
+        push(a[0], adjoint * exponent * std::pow(base, exponent - 1.0));
+        if (p.op[a[1]] != OP_CONST && base > 0.0) push(a[1], adjoint * value(id) * std::log(base));
+        break;
+    }
+    case OP_CONST:
+    case OP_VAR:
+    case OP_INDEX:
+    case OP_VARREF:
+        break;
+    default:
+        push(a[0], adjoint * unary_derivative(p.op[id], value(a[0]), value(id)));
+    }
+}
+
+template <class Var, class Grad>
+void backprop_loop(const Program& top, const Loop& loop, unsigned char op, int* indices, int depth,
+                   double adjoint, Var var_value, Grad add_gradient);
+
+// Обратный проход по телу на одной итерации; seed - сопряженное значение результата тела
+template <class Var, class Grad>
+void backprop_body(const Program& top, const Program& body, int* indices, int depth,
+                   double seed, Var var_value, Grad add_gradient) {
+    run_body(top, body, indices, depth, var_value);
+    const std::vector<double>& values = loop_buffer<double>(depth - 1);
+    std::vector<double>& adjoints = loop_adjoints(depth - 1);
+    adjoints.assign(body.op.size(), 0.0);
+    adjoints[body.root] = seed;
+
+    auto value = [&values](int k) { return values[k]; };
+    auto push = [&adjoints](int k, double contribution) { adjoints[k] += contribution; };
+    for (int id = body.size() - 1; id >= 0; --id) {
+        double adjoint = adjoints[id];
+        if (adjoint == 0.0) continue;
+        switch (body.op[id]) {
+        case OP_VAR:
+            add_gradient(body.var[id], adjoint);
+            break;
+        case OP_VARREF:
+            add_gradient(top.var_by_number[ref_number(body.refs[body.var[id]], indices)], adjoint);
+            break;
+        case OP_LOOP_SUM:
+        case OP_LOOP_PROD:
+            backprop_loop(top, body.loops[body.var[id]], body.op[id], indices, depth, adjoint, var_value, add_gradient);
+            break;
+        default:
+            backprop_node(body, id, adjoint, value, push);
+        }
+    }
+}
+
+template <class Var, class Grad>
+void backprop_loop(const Program& top, const Loop& loop, unsigned char op, int* indices, int depth,
+                   double adjoint, Var var_value, Grad add_gradient) {
+    if (op == OP_LOOP_SUM) {
+        for (int i = loop.lo; i <= loop.hi; ++i) {
+            indices[depth] = i;
+            backprop_body(top, *loop.body, indices, depth + 1, adjoint, var_value, add_gradient);
+        }
+        return;
+    }
+
+    // Произведение: множитель итерации i - произведение всех остальных (префикс * суффикс)
+    std::vector<double> prefix(1, 1.0);
+    for (int i = loop.lo; i <= loop.hi; ++i) {
+        indices[depth] = i;
+        prefix.push_back(prefix.back() * run_body(top, *loop.body, indices, depth + 1, var_value));
+    }
+    double suffix = 1.0;
+    for (int i = loop.hi; i >= loop.lo; --i) {
+        indices[depth] = i;
+        double others = prefix[i - loop.lo] * suffix;
+        double value = run_body(top, *loop.body, indices, depth + 1, var_value);
+        if (others != 0.0) {
+            backprop_body(top, *loop.body, indices, depth + 1, adjoint * others, var_value, add_gradient);
+        }
+        suffix *= value;
+    }
+}
+
+void collect_loop_variables(const Program& top, const Loop& loop, int* indices, int depth, std::vector<int>& out);
+
+// Переменные, которых касается тело на итерации с индексами indices
+void collect_body_variables(const Program& top, const Program& body, int* indices, int depth, std::vector<int>& out) {
+    for (int id = 0; id < body.size(); ++id) {
+        switch (body.op[id]) {
+        case OP_VAR:
+            out.push_back(body.var[id]);
+            break;
+        case OP_VARREF:
+            out.push_back(top.var_by_number[ref_number(body.refs[body.var[id]], indices)]);
+            break;
+        case OP_LOOP_SUM:
+        case OP_LOOP_PROD:
+            collect_loop_variables(top, body.loops[body.var[id]], indices, depth, out);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void collect_loop_variables(const Program& top, const Loop& loop, int* indices, int depth, std::vector<int>& out) {
+    for (int i = loop.lo; i <= loop.hi; ++i) {
+        indices[depth] = i;
+        collect_body_variables(top, *loop.body, indices, depth + 1, out);
+    }
+}
+
+void sort_unique(std::vector<int>& values) {
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+}
+
+
+// Построение DAG с объединением одинаковых узлов и сверткой констант.
+// Тела циклов строятся отдельными Builder в собственные программы (top_level = false).
+class Builder {
+public:
+    Builder(Program& program, const Program& top, bool top_level)
+        : p_(program), top_(top), top_level_(top_level) {
+        p_.arg_begin.push_back(0);
+    }
+
+    int lower(const Ast& ast) {
+        switch (ast.op) {
+        case OP_CONST:
+            return constant(ast.value);
+        case OP_VAR:
+            return add(OP_VAR, 0.0, ast.var, std::vector<int>(), std::vector<char>());
+        case OP_SUM:
+            return lower_sum(ast);
+        case OP_PRODUCT:
+            return lower_product(ast);
+        case OP_INDEX:
+            return add(OP_INDEX, 0.0, ast.var, std::vector<int>(), std::vector<char>());
+        case OP_VARREF:
+            return add(OP_VARREF, 0.0, reference(ast.affine), std::vector<int>(), std::vector<char>());
+        case OP_LOOP_SUM:
+        case OP_LOOP_PROD:
+            return lower_loop(ast);
+        case OP_NEG: {
+            int operand = lower(*ast.args[0]);
+            if (p_.op[operand] == OP_NEG) {
+                return p_.args[p_.arg_begin[operand]];
+            }
+            return add(OP_NEG, 0.0, -1, std::vector<int>(1, operand), std::vector<char>(1, 0));
+        }
+        default: {
+            std::vector<int> args;
+            for (const auto& arg : ast.args) args.push_back(lower(*arg));
+            return add(ast.op, 0.0, -1, args, std::vector<char>(args.size(), 0));
+        }
+        }
+    }
+
+    int constant(double value) {
+        return add(OP_CONST, value, -1, std::vector<int>(), std::vector<char>());
+    }
+
+private:
+    void collect_terms(const Ast& ast, bool negative, std::vector<int>& args, std::vector<char>& inverted) {
+        if (ast.op == OP_SUM) {
+            for (size_t i = 0; i < ast.args.size(); ++i) {
+                collect_terms(*ast.args[i], negative != (ast.inverted[i] != 0), args, inverted);
+            }
+            return;
+        }
+        if (ast.op == OP_NEG) {
+            collect_terms(*ast.args[0], !negative, args, inverted);
+            return;
+        }
+        args.push_back(lower(ast));
+        inverted.push_back(negative);
+    }
+
+    int lower_sum(const Ast& ast) {
+        std::vector<int> terms;
+        std::vector<char> signs;
+        collect_terms(ast, false, terms, signs);
+
+        // Константные слагаемые сворачиваются в одно
+        std::vector<int> args;
+        std::vector<char> inverted;
+        double constant_sum = 0.0;
+        bool has_constant = false;
+        for (size_t i = 0; i < terms.size(); ++i) {
+            if (p_.op[terms[i]] == OP_CONST) {
+                constant_sum += signs[i] ? -p_.value[terms[i]] : p_.value[terms[i]];
+                has_constant = true;
+            } else {
+                args.push_back(terms[i]);
+                inverted.push_back(signs[i]);
+            }
+        }
+        if (args.empty()) return constant(constant_sum);
+        if (has_constant && constant_sum != 0.0) {
+            args.push_back(constant(constant_sum));
+            inverted.push_back(0);
+        }
+        if (args.size() == 1 && !inverted[0]) return args[0];
+        return add(OP_SUM, 0.0, -1, args, inverted);
+    }
+
+    int lower_product(const Ast& ast) {
+        std::vector<int> args;
+        std::vector<char> inverted;
+        for (size_t i = 0; i < ast.args.size(); ++i) {
+            const Ast& arg = *ast.args[i];
+            if (arg.op == OP_PRODUCT && !ast.inverted[i]) {
+                int nested = lower_product(arg);
+                if (p_.op[nested] == OP_PRODUCT) {
+                    for (int j = p_.arg_begin[nested]; j < p_.arg_begin[nested + 1]; ++j) {
+                        args.push_back(p_.args[j]);
+                        inverted.push_back(p_.inverted[j]);
+                    }
+                    continue;
+                }
+                args.push_back(nested);
+            } else {
+                args.push_back(lower(arg));
+            }
+            inverted.push_back(ast.inverted[i]);
+        }
+        if (args.size() == 1 && !inverted[0]) return args[0];
+        return add(OP_PRODUCT, 0.0, -1, args, inverted);
+    }
+
+    int reference(const std::vector<long long>& affine) {
+        std::string key(reinterpret_cast<const char*>(affine.data()), affine.size() * sizeof(long long));
+        auto found = refs_.find(key);
+        if (found != refs_.end()) return found->second;
+        IndexRef ref;
+        ref.offset = affine[0];
+        ref.coef.assign(affine.begin() + 1, affine.end());
+        p_.refs.push_back(ref);
+        int id = static_cast<int>(p_.refs.size()) - 1;
+        refs_[key] = id;
+        return id;
+    }
+
+    int lower_loop(const Ast& ast) {
+        Loop loop;
+        loop.lo = ast.lo;
+        loop.hi = ast.hi;
+        loop.body.reset(new Program());
+        Builder body(*loop.body, top_, false);
+        loop.body->root = body.lower(*ast.args[0]);
+
+        // Приращение считается по итерациям, только если тело читает одни x[a*i+b]
+        loop.incremental = top_level_ && ast.op == OP_LOOP_SUM;
+        for (unsigned char op : loop.body->op) {
+            if (op == OP_VAR || op == OP_LOOP_SUM || op == OP_LOOP_PROD) loop.incremental = false;
+        }
+        if (loop.hi < loop.lo) return constant(ast.op == OP_LOOP_SUM ? 0.0 : 1.0);
+
+        if (!top_level_) {
+            p_.loops.push_back(std::move(loop));
+            return add(ast.op, 0.0, static_cast<int>(p_.loops.size()) - 1, std::vector<int>(), std::vector<char>());
+        }
+
+        // Аргументы узла цикла - узлы всех переменных, которых касается тело
+        int indices[kMaxLoopDepth];
+        std::vector<int> touched;
+        collect_loop_variables(top_, loop, indices, 0, touched);
+        sort_unique(touched);
+        if (touched.empty()) {
+            return constant(run_loop(top_, loop, ast.op, indices, 0, [](int) { return 0.0; }));
+        }
+        std::vector<int> args;
+        for (int v : touched) args.push_back(p_.var_node[v]);
+        p_.loops.push_back(std::move(loop));
+        return add(ast.op, 0.0, static_cast<int>(p_.loops.size()) - 1, args, std::vector<char>(args.size(), 0));
+    }
+
+    int add(Op op, double value, int var, const std::vector<int>& args, const std::vector<char>& inverted) {
+        if (op != OP_CONST && op != OP_VAR && op != OP_LOOP_SUM && op != OP_LOOP_PROD && !args.empty()) {
+            bool all_constant = true;
+            for (int arg : args) {
+                if (p_.op[arg] != OP_CONST) {
+                    all_constant = false;
+                    break;
+                }
+            }
+            if (all_constant) {
+                return constant(fold(op, args, inverted));
+            }
+        }
+
+        std::string key(1, static_cast<char>(op));
+        key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        key.append(reinterpret_cast<const char*>(&var), sizeof(var));
+        for (size_t i = 0; i < args.size(); ++i) {
+            key.append(reinterpret_cast<const char*>(&args[i]), sizeof(int));
+            key.push_back(inverted[i]);
+        }
+        auto found = cache_.find(key);
+        if (found != cache_.end()) return found->second;
+
+        int id = p_.size();
+        p_.op.push_back(op);
+        p_.value.push_back(value);
+        p_.var.push_back(var);
+        p_.args.insert(p_.args.end(), args.begin(), args.end());
+        p_.inverted.insert(p_.inverted.end(), inverted.begin(), inverted.end());
+        p_.arg_begin.push_back(static_cast<int>(p_.args.size()));
+        cache_[key] = id;
+        return id;
+    }
+
+    double fold(Op op, const std::vector<int>& args, const std::vector<char>& inverted) {
+        Program single;
+        single.op.push_back(op);
+        single.value.push_back(0.0);
+        single.var.push_back(-1);
+        single.arg_begin.push_back(0);
+        single.arg_begin.push_back(static_cast<int>(args.size()));
+        for (size_t i = 0; i < args.size(); ++i) {
+            single.args.push_back(static_cast<int>(i));
+            single.inverted.push_back(inverted[i]);
+        }
+        const Program& p = p_;
+        return compute_node<double>(single, 0, [&](int i) { return p.value[args[i]]; });
+    }
+
+    Program& p_;
+    const Program& top_;
+    bool top_level_;
+    std::unordered_map<std::string, int> cache_;
+    std::unordered_map<std::string, int> refs_;
+};
+
+
+void build_dependencies(Program& p) {
+    int size = p.size();
+
+    std::vector<int> parent_count(size + 1, 0);
+    for (int id = 0; id < size; ++id) {
+        for (int j = p.arg_begin[id]; j < p.arg_begin[id + 1]; ++j) {
+            ++parent_count[p.args[j] + 1];
+        }
+    }
+    for (int id = 0; id < size; ++id) parent_count[id + 1] += parent_count[id];
+    std::vector<int> parents(parent_count[size]);
+    std::vector<int> fill(parent_count.begin(), parent_count.end() - 1);
+    for (int id = 0; id < size; ++id) {
+        for (int j = p.arg_begin[id]; j < p.arg_begin[id + 1]; ++j) {
+            parents[fill[p.args[j]]++] = id;
+        }
+    }
+
+    // Родители-суммы: повторные вхождения одного аргумента складываются в коэффициент
+    p.sum_parent_begin.assign(1, 0);
+    for (int id = 0; id < size; ++id) {
+        int first = static_cast<int>(p.sum_parents.size());
+        for (int k = parent_count[id]; k < parent_count[id + 1]; ++k) {
+            int parent = parents[k];
+            if (p.op[parent] != OP_SUM) continue;
+            bool seen = false;
+            for (int s = first; s < static_cast<int>(p.sum_parents.size()); ++s) {
+                if (p.sum_parents[s] == parent) seen = true;
+            }
+            if (seen) continue;
+            double coef = 0.0;
+            for (int j = p.arg_begin[parent]; j < p.arg_begin[parent + 1]; ++j) {
+                if (p.args[j] == id) coef += p.inverted[j] ? -1.0 : 1.0;
+            }
+            p.sum_parents.push_back(parent);
+            p.sum_parent_coef.push_back(coef);
+        }
+        p.sum_parent_begin.push_back(static_cast<int>(p.sum_parents.size()));
+    }
+
+    // Для каждой переменной - все узлы выше нее по графу
+    std::vector<unsigned> visited(size, 0);
+    std::vector<int> stack;
+    p.affected_begin.assign(1, 0);
+    for (int v = 0; v < p.dimension(); ++v) {
+        unsigned stamp = static_cast<unsigned>(v) + 1;
+        size_t first = p.affected.size();
+        stack.assign(1, p.var_node[v]);
+        while (!stack.empty()) {
+            int id = stack.back();
+            stack.pop_back();
+            for (int k = parent_count[id]; k < parent_count[id + 1]; ++k) {
+                int parent = parents[k];
+                if (visited[parent] == stamp) continue;
+                visited[parent] = stamp;
+                p.affected.push_back(parent);
+                stack.push_back(parent);
+            }
+        }
+        std::sort(p.affected.begin() + first, p.affected.end());
+        p.affected_begin.push_back(static_cast<int>(p.affected.size()));
+    }
+}
+
+} // namespace
+
+
+ParseResult parse(const std::string& source) {
+    return Parser(source).run();
+}
+
+double apply_unary(unsigned char op, double a) {
+    switch (op) {
+    case OP_NEG: return -a;
+    case OP_SIN: return std::sin(a);
+    case OP_COS: return std::cos(a);
+    case OP_TAN: return std::tan(a);
+    case OP_EXP: return std::exp(a);
+    case OP_LOG: return std::log(a);
+    case OP_SQRT: return std::sqrt(a);
+    case OP_ABS: return std::fabs(a);
+    default: return a;
+    }
+}
+
+Interval apply_unary(unsigned char op, const Interval& a) {
+    switch (op) {
+    case OP_NEG:
+        return Interval(-a.hi, -a.lo);
+    case OP_SIN:
+        return interval_sin(a);
+    case OP_COS:
+        return interval_sin(Interval(a.lo + kPi / 2.0, a.hi + kPi / 2.0));
+    case OP_TAN: {
+        // Полюс pi/2 + k*pi внутри отрезка - значения не ограничены
+        double k = std::ceil((a.lo - kPi / 2.0) / kPi);
+        if (!(a.hi - a.lo < kPi) || kPi / 2.0 + k * kPi <= a.hi) return whole();
+        return Interval(std::tan(a.lo), std::tan(a.hi));
+    }
+    case OP_EXP:
+        return Interval(std::exp(a.lo), std::exp(a.hi));
+    case OP_LOG:
+        if (a.hi <= 0.0) return whole();
+        return Interval(a.lo > 0.0 ? std::log(a.lo) : -kInf, std::log(a.hi));
+    case OP_SQRT:
+        if (a.hi < 0.0) return whole();
+        return Interval(std::sqrt(std::max(a.lo, 0.0)), std::sqrt(a.hi));
+    case OP_ABS:
+        if (a.lo >= 0.0) return a;
+        if (a.hi <= 0.0) return Interval(-a.hi, -a.lo);
+        return Interval(0.0, std::max(-a.lo, a.hi));
+    default:
+        return a;
+    }
+}
+
+Dual apply_unary(unsigned char op, const Dual& a) {
+    double value = apply_unary(op, a.value);
+    return Dual(value, a.derivative == 0.0 ? 0.0 : unary_derivative(op, a.value, value) * a.derivative);
+}
+
+std::unique_ptr<Program> compile(const Ast& ast, const std::vector<std::string>& variables) {
+    std::unique_ptr<Program> program(new Program());
+    program->variables = variables;
+
+    // Номера переменных для x[...]: только имена вида xN без ведущих нулей
+    program->var_number.assign(variables.size(), -1);
+    for (size_t v = 0; v < variables.size(); ++v) {
+        const std::string& name = variables[v];
+        if (name.size() < 2 || name.size() > 8 || (name[1] == '0' && name.size() > 2)) continue;
+        long long number = std::atoll(name.c_str() + 1);
+        if (number > kMaxVariableNumber) continue;
+        program->var_number[v] = number;
+        if (program->var_by_number.size() <= static_cast<size_t>(number)) {
+            program->var_by_number.resize(number + 1, -1);
+        }
+        program->var_by_number[number] = static_cast<int>(v);
+    }
+
+    Builder builder(*program, *program, true);
+    // Узлы переменных создаются первыми, чтобы каждая имела свой узел
+    for (size_t v = 0; v < variables.size(); ++v) {
+        Ast var(OP_VAR);
+        var.var = static_cast<int>(v);
+        program->var_node.push_back(builder.lower(var));
+    }
+    program->root = builder.lower(ast);
+
+    build_dependencies(*program);
+    return program;
+}
+
+std::vector<int> node_variables(const Program& p, int id) {
+    std::vector<char> visited(p.size(), 0);
+    std::vector<int> stack(1, id);
+    std::vector<int> variables;
+    visited[id] = 1;
+    while (!stack.empty()) {
+        int node = stack.back();
+        stack.pop_back();
+        if (p.op[node] == OP_VAR) {
+            variables.push_back(p.var[node]);
+            continue;
+        }
+        for (int j = p.arg_begin[node]; j < p.arg_begin[node + 1]; ++j) {
+            if (visited[p.args[j]]) continue;
+            visited[p.args[j]] = 1;
+            stack.push_back(p.args[j]);
+        }
+    }
+    std::sort(variables.begin(), variables.end());
+    return variables;
+}
+
+long long program_nodes(const Program& p) {
+    long long nodes = p.size();
+    for (const Loop& loop : p.loops) nodes += program_nodes(*loop.body);
+    return nodes;
+}
+
+std::vector<int> root_terms(const Program& p) {
+    if (p.op[p.root] != OP_SUM) return std::vector<int>(1, p.root);
+    return std::vector<int>(p.args.begin() + p.arg_begin[p.root], p.args.begin() + p.arg_begin[p.root + 1]);
+}
+
+std::vector<std::vector<int>> term_variables(const Program& p) {
+    std::vector<std::vector<int>> terms;
+    for (int term : root_terms(p)) {
+        if (p.op[term] != OP_LOOP_SUM) {
+            terms.push_back(node_variables(p, term));
+            continue;
+        }
+        const Loop& loop = p.loops[p.var[term]];
+        int indices[kMaxLoopDepth];
+        for (int i = loop.lo; i <= loop.hi; ++i) {
+            indices[0] = i;
+            std::vector<int> variables;
+            collect_body_variables(p, *loop.body, indices, 1, variables);
+            sort_unique(variables);
+            terms.push_back(variables);
+        }
+    }
+    return terms;
+}
+
+std::vector<std::vector<int>> separable_components(const Program& p) {
+    std::vector<int> leader(p.dimension());
+    for (int v = 0; v < p.dimension(); ++v) leader[v] = v;
+    auto find = [&leader](int v) {
+        while (leader[v] != v) {
+            leader[v] = leader[leader[v]];
+            v = leader[v];
+        }
+        return v;
+    };
+
+    for (const std::vector<int>& variables : term_variables(p)) {
+        for (size_t i = 1; i < variables.size(); ++i) {
+            leader[find(variables[i])] = find(variables[0]);
+        }
+    }
+
+    std::vector<std::vector<int>> components;
+    std::vector<int> index(p.dimension(), -1);
+    for (int v = 0; v < p.dimension(); ++v) {
+        int root = find(v);
+        if (index[root] < 0) {
+            index[root] = static_cast<int>(components.size());
+            components.push_back(std::vector<int>());
+        }
+        components[index[root]].push_back(v);
+    }
+    return components;
+}
+
+
+Evaluator::Evaluator(const Program& program)
+    : program_(program),
+      base_(program.size(), 0.0),
+      scratch_(program.size(), 0.0),
+      mark_(program.size(), 0),
+      accum_(program.size(), 0.0),
+      accum_count_(program.size(), 0),
+      accum_mark_(program.size(), 0),
+      changed_(nullptr),
+      num_changed_(0),
+      epoch_(0) {}
+
+double Evaluator::evaluate(const double* x) {
+    const Program& p = program_;
+    const std::vector<double>& values = base_;
+    for (int id = 0; id < p.size(); ++id) {
+        if (p.op[id] == OP_VAR) {
+            base_[id] = x[p.var[id]];
+        } else if (p.op[id] == OP_LOOP_SUM || p.op[id] == OP_LOOP_PROD) {
+            base_[id] = loop_value(p, id, [x](int v) { return x[v]; });
+        } else {
+            base_[id] = compute_node<double>(p, id, [&](int arg) { return values[arg]; });
+        }
+    }
+    return base_[p.root];
+}
+
+double Evaluator::gradient(const double* x, double* gradient) {
+    const Program& p = program_;
+    double value = evaluate(x);
+    std::fill(gradient, gradient + p.dimension(), 0.0);
+    adjoint_.assign(p.size(), 0.0);
+    adjoint_[p.root] = 1.0;
+
+    auto node = [this](int k) { return base_[k]; };
+    auto push = [this](int k, double contribution) { adjoint_[k] += contribution; };
+    auto var_value = [x](int v) { return x[v]; };
+    auto add_gradient = [gradient](int v, double contribution) { gradient[v] += contribution; };
+    int indices[kMaxLoopDepth];
+    for (int id = p.root; id >= 0; --id) {
+        double adjoint = adjoint_[id];
+        if (adjoint == 0.0) continue;
+        if (p.op[id] == OP_VAR) {
+            gradient[p.var[id]] += adjoint;
+        } else if (p.op[id] == OP_LOOP_SUM || p.op[id] == OP_LOOP_PROD) {
+            backprop_loop(p, p.loops[p.var[id]], p.op[id], indices, 0, adjoint, var_value, add_gradient);
+        } else {
+            backprop_node(p, id, adjoint, node, push);
+        }
+    }
+    return value;
+}
+
+Interval Evaluator::evaluate_interval(const Interval* box) {
+    const Program& p = program_;
+    interval_.resize(p.size());
+    auto var_value = [box](int v) { return box[v]; };
+    for (int id = 0; id < p.size(); ++id) {
+        if (p.op[id] == OP_VAR) {
+            interval_[id] = box[p.var[id]];
+        } else if (p.op[id] == OP_LOOP_SUM || p.op[id] == OP_LOOP_PROD) {
+            interval_[id] = loop_value(p, id, var_value);
+        } else {
+            interval_[id] = compute_node<Interval>(p, id, [this](int arg) { return interval_[arg]; });
+        }
+    }
+    return interval_[p.root];
+}
+
+double Evaluator::directional(const double* x, const double* direction, double* derivative) {
+    const Program& p = program_;
+    dual_.resize(p.size());
+    auto var_value = [x, direction](int v) { return Dual(x[v], direction[v]); };
+    for (int id = 0; id < p.size(); ++id) {
+        if (p.op[id] == OP_VAR) {
+            dual_[id] = var_value(p.var[id]);
+        } else if (p.op[id] == OP_LOOP_SUM || p.op[id] == OP_LOOP_PROD) {
+            dual_[id] = loop_value(p, id, var_value);
+        } else {
+            dual_[id] = compute_node<Dual>(p, id, [this](int arg) { return dual_[arg]; });
+        }
+    }
+    if (derivative) *derivative = dual_[p.root].derivative;
+    return dual_[p.root].value;
+}
+
+void Evaluator::collect_affected(const int* changed, int num_changed) {
+    const Program& p = program_;
+    order_.clear();
+    for (int k = 0; k < num_changed; ++k) {
+        int v = changed[k];
+        for (int j = p.affected_begin[v]; j < p.affected_begin[v + 1]; ++j) {
+            int id = p.affected[j];
+            if (mark_[id] == epoch_) continue;
+            mark_[id] = epoch_;
+            order_.push_back(id);
+        }
+    }
+    if (num_changed > 1) std::sort(order_.begin(), order_.end());
+}
+
+void Evaluator::push_to_sum_parents(int id) {
+    const Program& p = program_;
+    double diff = scratch_[id] - base_[id];
+    bool finite = std::isfinite(scratch_[id]) && std::isfinite(base_[id]);
+    for (int k = p.sum_parent_begin[id]; k < p.sum_parent_begin[id + 1]; ++k) {
+        int parent = p.sum_parents[k];
+        if (accum_mark_[parent] != epoch_) {
+            accum_mark_[parent] = epoch_;
+            accum_[parent] = 0.0;
+            accum_count_[parent] = 0;
+        }
+        accum_[parent] += p.sum_parent_coef[k] * diff;
+        // Бесконечности не вычитаются - такую сумму считаем заново
+        accum_count_[parent] += finite ? 1 : p.arg_count(parent);
+    }
+}
+
+// Сумма по циклу: пересчитываются только итерации, читающие измененные x[...]
+bool Evaluator::loop_delta(int id, double& value) {
+    const Program& p = program_;
+    const Loop& loop = p.loops[p.var[id]];
+    if (p.op[id] != OP_LOOP_SUM || !loop.incremental || !std::isfinite(base_[id])) return false;
+    const Program& body = *loop.body;
+
+    long long count = static_cast<long long>(loop.hi) - loop.lo + 1;
+    iterations_.clear();
+    for (int k = 0; k < num_changed_; ++k) {
+        long long number = p.var_number[changed_[k]];
+        if (number < 0) continue;
+        for (const IndexRef& ref : body.refs) {
+            long long shift = number - ref.offset;
+            if (shift % ref.coef[0] != 0) continue;
+            long long i = shift / ref.coef[0];
+            if (i >= loop.lo && i <= loop.hi) iterations_.push_back(static_cast<int>(i));
+        }
+        if (2 * static_cast<long long>(iterations_.size()) >= count) return false;
+    }
+    sort_unique(iterations_);
+
+    auto now = [this, &p](int v) { return node_value(p.var_node[v]); };
+    auto before = [this, &p](int v) { return base_[p.var_node[v]]; };
+    int indices[kMaxLoopDepth];
+    value = base_[id];
+    for (int i : iterations_) {
+        indices[0] = i;
+        value += run_body(p, body, indices, 1, now) - run_body(p, body, indices, 1, before);
+    }
+    return std::isfinite(value);
+}
+
+double Evaluator::compute_delta_node(int id) {
+    const Program& p = program_;
+    if (p.op[id] == OP_LOOP_SUM || p.op[id] == OP_LOOP_PROD) {
+        double value;
+        if (loop_delta(id, value)) return value;
+        return loop_value(p, id, [this, &p](int v) { return node_value(p.var_node[v]); });
+    }
+    if (p.op[id] == OP_SUM && accum_mark_[id] == epoch_ &&
+        2 * accum_count_[id] < p.arg_count(id) && std::isfinite(base_[id])) {
+        return base_[id] + accum_[id];
+    }
+    return compute_node<double>(p, id, [this](int arg) { return node_value(arg); });
+}
+
+double Evaluator::evaluate_delta(const double* x, const int* changed, int num_changed) {
+    const Program& p = program_;
+    if (++epoch_ == 0) {
+        std::fill(mark_.begin(), mark_.end(), 0u);
+        std::fill(accum_mark_.begin(), accum_mark_.end(), 0u);
+        epoch_ = 1;
+    }
+    changed_ = changed;
+    num_changed_ = num_changed;
+
+    // Узлы переменных помечаются до сбора затронутых узлов, чтобы не попасть в order_
+    for (int k = 0; k < num_changed; ++k) {
+        int id = p.var_node[changed[k]];
+        if (mark_[id] == epoch_) continue;
+        mark_[id] = epoch_;
+        scratch_[id] = x[changed[k]];
+        push_to_sum_parents(id);
+    }
+    collect_affected(changed, num_changed);
+
+    for (int id : order_) {
+        scratch_[id] = compute_delta_node(id);
+        push_to_sum_parents(id);
+    }
+    return node_value(p.root);
+}
+
+} // namespace expr
+
+
+ExprProgram* expr_compile(const char* source, char* error, int error_size) {
+    expr::ParseResult parsed = expr::parse(source ? source : "");
+    if (!parsed.root) {
+        if (error && error_size > 0) {
+            std::strncpy(error, parsed.error.c_str(), error_size - 1);
+            error[error_size - 1] = '\0';
+        }
+        return nullptr;
+    }
+    ExprProgram* program = new ExprProgram();
+    program->program = expr::compile(*parsed.root, parsed.variables);
+    program->canonical = expr::canonical_form(*parsed.root, parsed.variables);
+    return program;
+}
+
+void expr_program_free(ExprProgram* program) {
+    delete program;
+}
+
+int expr_dimension(const ExprProgram* program) {
+    return program->program->dimension();
+}
+
+const char* expr_canonical_form(const ExprProgram* program) {
+    return program->canonical.c_str();
+}
+
+const char* expr_variable_name(const ExprProgram* program, int index) {
+    return program->program->variables[index].c_str();
+}
+
+int expr_node_count(const ExprProgram* program) {
+    return program->program->size();
+}
+
+int expr_component_count(const ExprProgram* program) {
+    return static_cast<int>(expr::separable_components(*program->program).size());
+}
+
+int expr_max_term_variables(const ExprProgram* program) {
+    size_t widest = 0;
+    for (const std::vector<int>& variables : expr::term_variables(*program->program)) {
+        widest = std::max(widest, variables.size());
+    }
+    return static_cast<int>(widest);
+}
+
+ExprEvaluator* expr_evaluator_create(const ExprProgram* program) {
+    return new ExprEvaluator(*program->program);
+}
+
+void expr_evaluator_free(ExprEvaluator* evaluator) {
+    delete evaluator;
+}
+
+double expr_objective(double* x, int /*n*/, void* context) {
+    return static_cast<ExprEvaluator*>(context)->evaluator.evaluate(x);
+}
+
+double expr_objective_delta(double* x, int /*n*/, const int* changed, int num_changed, void* context) {
+    return static_cast<ExprEvaluator*>(context)->evaluator.evaluate_delta(x, changed, num_changed);
+}
+
+double expr_objective_gradient(double* x, int /*n*/, double* gradient, void* context) {
+    return static_cast<ExprEvaluator*>(context)->evaluator.gradient(x, gradient);
+}
+
+double expr_objective_directional(double* x, int /*n*/, const double* direction, double* derivative, void* context) {
+    return static_cast<ExprEvaluator*>(context)->evaluator.directional(x, direction, derivative);
+}
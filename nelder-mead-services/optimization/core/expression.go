@@ -0,0 +1,102 @@
+package core
+
+/*
+#include "expression.h"
+#include <stdlib.h>
+*/
+import "C"
+
+import (
+	"errors"
+	"unsafe"
+)
+
+const (
+	compileErrorSize = 256
+
+	// Блочный режим включается для выражений не меньше blockMinDimension переменных,
+	// в которых слагаемое затрагивает не больше 1/blockSparsity из них
+	blockMinDimension = 16
+	blockSparsity     = 4
+)
+
+// NativeProgram - выражение, скомпилированное в DAG на стороне C++
+type NativeProgram struct {
+	program    *C.ExprProgram
+	canonical  string
+	variables  []string
+	components int
+	termWidth  int
+}
+
+// compileNative берет программу из общего кэша C++ или компилирует ее.
+// Free освобождает только ссылку, программа в кэше остается.
+func compileNative(expr string) (*NativeProgram, error) {
+	source := C.CString(expr)
+	defer C.free(unsafe.Pointer(source))
+
+	var errBuf [compileErrorSize]C.char
+	program := C.expr_compile_cached(source, &errBuf[0], C.int(len(errBuf)))
+	if program == nil {
+		return nil, errors.New(C.GoString(&errBuf[0]))
+	}
+
+	n := int(C.expr_dimension(program))
+	variables := make([]string, n)
+	for i := range variables {
+		variables[i] = C.GoString(C.expr_variable_name(program, C.int(i)))
+	}
+
+	return &NativeProgram{
+		program:    program,
+		canonical:  C.GoString(C.expr_canonical_form(program)),
+		variables:  variables,
+		components: int(C.expr_component_count(program)),
+		termWidth:  int(C.expr_max_term_variables(program)),
+	}, nil
+}
+
+func (p *NativeProgram) Dimension() int {
+	return len(p.variables)
+}
+
+// Canonical - каноническая запись выражения, общая для равносильных записей
+func (p *NativeProgram) Canonical() string {
+	return p.canonical
+}
+
+func (p *NativeProgram) VarNames() []string {
+	return p.variables
+}
+
+// Components - число независимых подзадач сепарабельного выражения
+func (p *NativeProgram) Components() int {
+	return p.components
+}
+
+// Sparse - выражение достаточно велико и каждое слагаемое затрагивает
+// малую часть переменных, так что выгоден блочно-покоординатный метод
+func (p *NativeProgram) Sparse() bool {
+	n := p.Dimension()
+	return n >= blockMinDimension && p.termWidth*blockSparsity <= n
+}
+
+func (p *NativeProgram) Free() {
+	C.expr_program_free(p.program)
+}
+
+func configureExpressionCache(entries int, nodes int64) {
+	C.expr_cache_configure(C.int(entries), C.longlong(nodes))
+}
+
+// ExpressionCacheStats - счетчики общего кэша скомпилированных выражений
+func ExpressionCacheStats() CacheStats {
+	stats := C.expr_cache_stats()
+	return CacheStats{
+		Hits:      int64(stats.hits),
+		Misses:    int64(stats.misses),
+		Evictions: int64(stats.evictions),
+		Entries:   int(stats.entries),
+		Nodes:     int64(stats.nodes),
+	}
+}
@@ -0,0 +1,83 @@
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+typedef struct ExprProgram ExprProgram;      // Скомпилированное выражение (неизменяемый DAG)
+typedef struct ExprEvaluator ExprEvaluator;  // Рабочая область вычислений над программой
+
+
+// Компиляция строки вида "(x1-2)^2 + x2*x2". При ошибке возвращает NULL
+// и пишет сообщение в error (если error != NULL).
+ExprProgram* expr_compile(const char* source, char* error, int error_size);
+
+void expr_program_free(ExprProgram* program);
+
+int expr_dimension(const ExprProgram* program);
+
+const char* expr_variable_name(const ExprProgram* program, int index);
+
+int expr_node_count(const ExprProgram* program);
+
+// Каноническая запись выражения: совпадает у выражений, отличающихся
+// пробелами, форматом чисел и порядком операндов сумм и произведений
+const char* expr_canonical_form(const ExprProgram* program);
+
+// Число независимых подзадач: групп переменных, не встречающихся
+// вместе ни в одном слагаемом выражения
+int expr_component_count(const ExprProgram* program);
+
+// Наибольшее число переменных в одном слагаемом (мера разреженности)
+int expr_max_term_variables(const ExprProgram* program);
+
+
+typedef struct {
+    long long hits;        // Запросы, обслуженные готовой программой
+    long long misses;      // Запросы, потребовавшие компиляции
+    long long evictions;   // Программы, вытесненные по LRU
+    int entries;           // Программ в кэше сейчас
+    long long nodes;       // Суммарный размер программ в кэше (узлов DAG)
+} ExprCacheStats;
+
+// Компиляция через общий для процесса кэш программ. Ключ - каноническая форма
+// выражения, поэтому "x1+2*x2" и "2 * x2 + x1" получают одну программу
+// (и один порядок переменных). Результат освобождается expr_program_free.
+ExprProgram* expr_compile_cached(const char* source, char* error, int error_size);
+
+// Ограничения кэша: число программ и суммарное число узлов.
+// Лишние программы вытесняются сразу, 0 в max_entries отключает кэш.
+void expr_cache_configure(int max_entries, long long max_nodes);
+
+ExprCacheStats expr_cache_stats(void);
+
+
+ExprEvaluator* expr_evaluator_create(const ExprProgram* program);
+
+void expr_evaluator_free(ExprEvaluator* evaluator);
+
+
+// Полное вычисление, совместимо с ObjectiveFunction (context = ExprEvaluator*).
+// Значения всех узлов запоминаются как базовая точка для expr_objective_delta.
+double expr_objective(double* x, int n, void* context);
+
+// Инкрементальное вычисление: x отличается от базовой точки только
+// в координатах changed. Пересчитываются лишь узлы, зависящие от них,
+// базовая точка не меняется.
+double expr_objective_delta(double* x, int n, const int* changed, int num_changed, void* context);
+
+// Значение и градиент (обратный режим автоматического дифференцирования).
+// x становится базовой точкой, как после expr_objective.
+double expr_objective_gradient(double* x, int n, double* gradient, void* context);
+
+// Значение и производная по направлению direction (прямой режим),
+// базовая точка не меняется
+double expr_objective_directional(double* x, int n, const double* direction, double* derivative, void* context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EXPRESSION_H
@@ -0,0 +1,199 @@
+#include "expression_impl.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace expr {
+
+namespace {
+
+typedef std::vector<std::string> Names;
+
+void collect_canonical(const Ast& ast, const Names& variables, bool negative, std::vector<std::string>& terms) {
+    if (ast.op == OP_SUM) {
+        for (size_t i = 0; i < ast.args.size(); ++i) {
+            collect_canonical(*ast.args[i], variables, negative != (ast.inverted[i] != 0), terms);
+        }
+        return;
+    }
+    if (ast.op == OP_NEG) {
+        collect_canonical(*ast.args[0], variables, !negative, terms);
+        return;
+    }
+    terms.push_back((negative ? "-" : "+") + canonical_form(ast, variables));
+}
+
+void collect_factors(const Ast& ast, const Names& variables, std::vector<std::string>& factors) {
+    for (size_t i = 0; i < ast.args.size(); ++i) {
+        const Ast& arg = *ast.args[i];
+        if (arg.op == OP_PRODUCT && !ast.inverted[i]) {
+            collect_factors(arg, variables, factors);
+            continue;
+        }
+        factors.push_back((ast.inverted[i] ? "/" : "*") + canonical_form(arg, variables));
+    }
+}
+
+std::string join(std::vector<std::string>& parts) {
+    std::sort(parts.begin(), parts.end());
+    std::string result = "(";
+    for (const std::string& part : parts) result += part;
+    return result + ")";
+}
+
+const char* function_name(Op op) {
+    switch (op) {
+    case OP_SIN: return "sin";
+    case OP_COS: return "cos";
+    case OP_TAN: return "tan";
+    case OP_EXP: return "exp";
+    case OP_LOG: return "log";
+    case OP_SQRT: return "sqrt";
+    case OP_ABS: return "abs";
+    case OP_NEG: return "neg";
+    default: return "?";
+    }
+}
+
+} // namespace
+
+std::string canonical_form(const Ast& ast, const std::vector<std::string>& variables) {
+    switch (ast.op) {
+    case OP_CONST: {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.17g", ast.value);
+        return buffer;
+    }
+    case OP_VAR:
+        return variables[ast.var];
+    case OP_INDEX:
+        return "#" + std::to_string(ast.var);
+    case OP_VARREF: {
+        std::string result = "x[";
+        for (long long c : ast.affine) result += std::to_string(c) + ";";
+        return result + "]";
+    }
+    case OP_SUM:
+    case OP_NEG: {
+        std::vector<std::string> terms;
+        collect_canonical(ast, variables, false, terms);
+        if (terms.size() == 1 && ast.op == OP_NEG) return "neg" + terms[0].substr(1);
+        return join(terms);
+    }
+    case OP_PRODUCT: {
+        std::vector<std::string> factors;
+        collect_factors(ast, variables, factors);
+        return join(factors);
+    }
+    case OP_POW:
+        return "(" + canonical_form(*ast.args[0], variables) + "^" + canonical_form(*ast.args[1], variables) + ")";
+    case OP_LOOP_SUM:
+    case OP_LOOP_PROD:
+        return std::string(ast.op == OP_LOOP_SUM ? "sum[" : "prod[") + std::to_string(ast.lo) + ";" +
+               std::to_string(ast.hi) + "](" + canonical_form(*ast.args[0], variables) + ")";
+    default:
+        return std::string(function_name(ast.op)) + "(" + canonical_form(*ast.args[0], variables) + ")";
+    }
+}
+
+} // namespace expr
+
+
+namespace {
+
+struct CacheEntry {
+    std::string key;
+    std::shared_ptr<const expr::Program> program;
+    long long nodes;
+};
+
+// LRU: в начале списка - последние использованные программы
+struct ProgramCache {
+    std::mutex mutex;
+    std::list<CacheEntry> entries;
+    std::unordered_map<std::string, std::list<CacheEntry>::iterator> index;
+    int max_entries = 256;
+    long long max_nodes = 1 << 20;
+    ExprCacheStats stats = ExprCacheStats();
+
+    void evict() {
+        while (!entries.empty() &&
+               (static_cast<int>(entries.size()) > max_entries || stats.nodes > max_nodes)) {
+            stats.nodes -= entries.back().nodes;
+            index.erase(entries.back().key);
+            entries.pop_back();
+            ++stats.evictions;
+        }
+        stats.entries = static_cast<int>(entries.size());
+    }
+};
+
+ProgramCache& cache() {
+    static ProgramCache instance;
+    return instance;
+}
+
+} // namespace
+
+
+ExprProgram* expr_compile_cached(const char* source, char* error, int error_size) {
+    expr::ParseResult parsed = expr::parse(source ? source : "");
+    if (!parsed.root) {
+        if (error && error_size > 0) {
+            std::strncpy(error, parsed.error.c_str(), error_size - 1);
+            error[error_size - 1] = '\0';
+        }
+        return nullptr;
+    }
+
+    ProgramCache& c = cache();
+    std::string key = expr::canonical_form(*parsed.root, parsed.variables);
+    {
+        std::lock_guard<std::mutex> lock(c.mutex);
+        auto found = c.index.find(key);
+        if (found != c.index.end()) {
+            c.entries.splice(c.entries.begin(), c.entries, found->second);
+            ++c.stats.hits;
+            ExprProgram* program = new ExprProgram();
+            program->program = found->second->program;
+            program->canonical = key;
+            return program;
+        }
+        ++c.stats.misses;
+    }
+
+    // Компиляция идет без блокировки, другие запросы к кэшу не ждут
+    ExprProgram* program = new ExprProgram();
+    program->program = expr::compile(*parsed.root, parsed.variables);
+    program->canonical = key;
+    long long nodes = expr::program_nodes(*program->program);
+
+    std::lock_guard<std::mutex> lock(c.mutex);
+    if (c.index.count(key) || c.max_entries <= 0 || nodes > c.max_nodes) return program;
+    CacheEntry entry;
+    entry.key = key;
+    entry.program = program->program;
+    entry.nodes = nodes;
+    c.entries.push_front(entry);
+    c.index[key] = c.entries.begin();
+    c.stats.nodes += nodes;
+    c.evict();
+    return program;
+}
+
+void expr_cache_configure(int max_entries, long long max_nodes) {
+    ProgramCache& c = cache();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    c.max_entries = max_entries;
+    c.max_nodes = max_nodes;
+    c.evict();
+}
+
+ExprCacheStats expr_cache_stats(void) {
+    ProgramCache& c = cache();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    return c.stats;
+}
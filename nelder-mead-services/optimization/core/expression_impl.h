@@ -0,0 +1,220 @@
+#ifndef EXPRESSION_IMPL_H
+#define EXPRESSION_IMPL_H
+
+// Внутреннее C++ представление выражений, общее для компилятора и решателей.
+
+#include "expression.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace expr {
+
+enum Op : unsigned char {
+    OP_CONST,
+    OP_VAR,
+    OP_SUM,        // n-арная сумма, inverted = вычитание
+    OP_PRODUCT,    // n-арное произведение, inverted = деление
+    OP_POW,
+    OP_NEG,
+    OP_SIN,
+    OP_COS,
+    OP_TAN,
+    OP_EXP,
+    OP_LOG,
+    OP_SQRT,
+    OP_ABS,
+    OP_INDEX,      // значение индекса цикла, var = глубина вложенности
+    OP_VARREF,     // x[i+c] внутри цикла, var = номер ссылки в Program::refs
+    OP_LOOP_SUM,   // sum(i, lo, hi, тело), var = номер цикла в Program::loops
+    OP_LOOP_PROD   // prod(i, lo, hi, тело)
+};
+
+const int kMaxLoopDepth = 8;
+
+// Узел синтаксического дерева
+struct Ast {
+    Op op;
+    double value;                          // OP_CONST
+    int var;                               // OP_VAR, глубина для OP_INDEX
+    int lo, hi;                            // границы OP_LOOP_*
+    std::vector<long long> affine;         // OP_VARREF: номер = affine[0] + sum(affine[d+1] * i_d)
+    std::vector<std::unique_ptr<Ast>> args;
+    std::vector<char> inverted;            // для OP_SUM и OP_PRODUCT
+
+    explicit Ast(Op op) : op(op), value(0.0), var(-1), lo(0), hi(-1) {}
+};
+
+struct ParseResult {
+    std::unique_ptr<Ast> root;
+    std::vector<std::string> variables;    // в порядке первого появления
+    std::string error;
+};
+
+ParseResult parse(const std::string& source);
+
+
+struct Program;
+
+// Цикл sum/prod: тело компилируется один раз в отдельную программу
+// и выполняется на каждой итерации, а не разворачивается в узлы
+struct Loop {
+    int lo;
+    int hi;
+    std::unique_ptr<Program> body;
+    bool incremental;      // тело зависит только от x[a*i+b] этого цикла
+};
+
+// Ссылка x[...] с номером offset + sum(coef[d] * i_d)
+struct IndexRef {
+    long long offset;
+    std::vector<long long> coef;
+};
+
+// Скомпилированный DAG: одинаковые подвыражения хранятся один раз,
+// узлы упорядочены топологически (аргументы раньше родителя).
+// Узлы цикла ссылаются на узлы всех переменных, которые может затронуть тело.
+struct Program {
+    std::vector<unsigned char> op;
+    std::vector<double> value;
+    std::vector<int> var;
+    std::vector<int> arg_begin;            // CSR: аргументы узла i в args[arg_begin[i], arg_begin[i+1])
+    std::vector<int> args;
+    std::vector<char> inverted;
+    int root;
+
+    std::vector<std::string> variables;
+    std::vector<int> var_node;
+
+    std::vector<Loop> loops;
+    std::vector<IndexRef> refs;
+    std::vector<int> var_by_number;        // номер N из имени xN -> индекс переменной
+    std::vector<long long> var_number;
+
+    // Родители-суммы с суммарным знаком вхождения (для инкрементального пересчета сумм)
+    std::vector<int> sum_parent_begin;
+    std::vector<int> sum_parents;
+    std::vector<double> sum_parent_coef;
+
+    // Узлы, зависящие от переменной v, в топологическом порядке
+    std::vector<int> affected_begin;
+    std::vector<int> affected;
+
+    int size() const { return static_cast<int>(op.size()); }
+    int dimension() const { return static_cast<int>(variables.size()); }
+    int arg_count(int id) const { return arg_begin[id + 1] - arg_begin[id]; }
+};
+
+std::unique_ptr<Program> compile(const Ast& ast, const std::vector<std::string>& variables);
+
+// Переменные, от которых зависит узел, по возрастанию
+std::vector<int> node_variables(const Program& program, int id);
+
+// Слагаемые корня (сам корень, если он не сумма)
+std::vector<int> root_terms(const Program& program);
+
+// Переменные каждого слагаемого; циклы-суммы среди слагаемых корня
+// раскрываются в отдельное слагаемое на итерацию
+std::vector<std::vector<int>> term_variables(const Program& program);
+
+// Разбиение переменных на группы, не встречающиеся вместе ни в одном слагаемом
+std::vector<std::vector<int>> separable_components(const Program& program);
+
+double apply_unary(unsigned char op, double a);
+
+// Значение и производная по направлению (прямой режим дифференцирования)
+struct Dual {
+    double value;
+    double derivative;
+
+    Dual() : value(0.0), derivative(0.0) {}
+    explicit Dual(double value) : value(value), derivative(0.0) {}
+    Dual(double value, double derivative) : value(value), derivative(derivative) {}
+};
+
+Dual apply_unary(unsigned char op, const Dual& a);
+
+// Отрезок значений [lo, hi]; вне области определения функций оценка
+// расширяется до всей прямой, так что граница снизу остается верной
+struct Interval {
+    double lo;
+    double hi;
+
+    Interval() : lo(0.0), hi(0.0) {}
+    explicit Interval(double value) : lo(value), hi(value) {}
+    Interval(double lo, double hi) : lo(lo), hi(hi) {}
+};
+
+Interval apply_unary(unsigned char op, const Interval& a);
+
+// Каноническая запись: без пробелов, с упорядоченными операндами сумм и
+// произведений, единым форматом чисел и индексами циклов по глубине
+std::string canonical_form(const Ast& ast, const std::vector<std::string>& variables);
+
+// Число узлов программы вместе с телами циклов
+long long program_nodes(const Program& program);
+
+
+class Evaluator {
+public:
+    explicit Evaluator(const Program& program);
+
+    // Полное вычисление, результат всех узлов становится базовой точкой
+    double evaluate(const double* x);
+
+    // Пересчет только узлов, зависящих от changed, относительно базовой точки
+    double evaluate_delta(const double* x, const int* changed, int num_changed);
+
+    // Значение и градиент обратным проходом по DAG; x становится базовой точкой
+    double gradient(const double* x, double* gradient);
+
+    // Значение и производная по направлению прямым проходом, база не меняется
+    double directional(const double* x, const double* direction, double* derivative);
+
+    // Оценка множества значений на боксе box[v] (интервальная арифметика)
+    Interval evaluate_interval(const Interval* box);
+
+    const Program& program() const { return program_; }
+    const std::vector<double>& base() const { return base_; }
+
+private:
+    double node_value(int id) const {
+        return mark_[id] == epoch_ ? scratch_[id] : base_[id];
+    }
+    void collect_affected(const int* changed, int num_changed);
+    void push_to_sum_parents(int id);
+    double compute_delta_node(int id);
+    bool loop_delta(int id, double& value);
+
+    const Program& program_;
+    std::vector<double> base_;
+    std::vector<double> scratch_;
+    std::vector<unsigned> mark_;
+    std::vector<double> accum_;
+    std::vector<int> accum_count_;
+    std::vector<unsigned> accum_mark_;
+    std::vector<int> order_;
+    std::vector<int> iterations_;
+    std::vector<double> adjoint_;
+    std::vector<Dual> dual_;
+    std::vector<Interval> interval_;
+    const int* changed_;
+    int num_changed_;
+    unsigned epoch_;
+};
+
+} // namespace expr
+
+// Программа неизменяема и может разделяться между кэшем и несколькими запросами
+struct ExprProgram {
+    std::shared_ptr<const expr::Program> program;
+    std::string canonical;     // каноническая запись исходного выражения
+};
+
+struct ExprEvaluator {
+    expr::Evaluator evaluator;
+
+    explicit ExprEvaluator(const expr::Program& program) : evaluator(program) {}
+};
+
+#endif // EXPRESSION_IMPL_H
@@ -0,0 +1,200 @@
+package core
+
+/*
+#include "worker_pool.h"
+*/
+import "C"
+
+import (
+	"context"
+	"math"
+	"sync"
+	"sync/atomic"
+)
+
+// Доля запусков острова, начинающихся рядом с лучшей известной точкой
+// (своей или пришедшей с другого острова), и радиус таких запусков
+// относительно IslandTask.Radius
+const (
+	islandLocalEvery  = 2
+	islandLocalRadius = 0.1
+)
+
+// island - состояние доли multi-start на одном экземпляре
+type island struct {
+	task    IslandTask
+	program *NativeProgram
+	slots   map[string]int // Номер переменной по имени для точек других островов
+	next    atomic.Int64   // Следующий запуск доли
+
+	mu     sync.Mutex
+	report func(IslandReport)
+	starts int
+	best   []float64 // Лучшая точка своих запусков
+	value  float64
+	elite  []float64 // Лучшая известная точка: своя или мигрант
+	eliteV float64
+}
+
+// Island выполняет долю острова: запуски метода с начальных точек общей
+// псевдослучайной последовательности идут в фоновом классе пула, по потоку
+// на ядро. Каждый islandLocalEvery-й запуск начинается рядом с лучшей
+// известной точкой, так что мигранты других островов направляют поиск.
+// report вызывается после каждого запуска и по завершении доли.
+func (s *Service) Island(ctx context.Context, task IslandTask, migrants <-chan IslandPoint, report func(IslandReport)) error {
+	if task.Islands < 1 || task.Island < 0 || task.Island >= task.Islands || task.Starts < 1 || task.Radius < 0 {
+		return ErrInvalidIsland
+	}
+	program, err := compileNative(task.Query.Function)
+	if err != nil {
+		return err
+	}
+	defer program.Free()
+	if program.Dimension() == 0 {
+		return ErrOptimizationFailed
+	}
+	task.Query.Priority = PriorityBatch
+
+	is := &island{task: task, program: program, slots: make(map[string]int), report: report, value: math.Inf(1), eliteV: math.Inf(1)}
+	for i, name := range program.VarNames() {
+		is.slots[name] = i
+	}
+
+	done := make(chan struct{})
+	defer close(done)
+	go func() {
+		for {
+			select {
+			case migrant, ok := <-migrants:
+				if !ok {
+					return
+				}
+				is.migrate(migrant)
+			case <-done:
+				return
+			}
+		}
+	}()
+
+	share := (task.Starts - task.Island + task.Islands - 1) / task.Islands
+	var wg sync.WaitGroup
+	var firstErr error
+	var errOnce sync.Once
+	for w := 0; w < min(s.pool.Size(), share); w++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for ctx.Err() == nil {
+				j := int(is.next.Add(1) - 1)
+				if j >= share {
+					return
+				}
+				if err := s.islandStart(is, j); err != nil {
+					errOnce.Do(func() { firstErr = err })
+					return
+				}
+			}
+		}()
+	}
+	wg.Wait()
+	if firstErr != nil {
+		return firstErr
+	}
+	if err := ctx.Err(); err != nil {
+		return err
+	}
+
+	is.mu.Lock()
+	defer is.mu.Unlock()
+	report(IslandReport{Starts: is.starts, Best: is.point(), Done: true})
+	return nil
+}
+
+// islandStart выполняет запуск j доли острова
+func (s *Service) islandStart(is *island, j int) error {
+	job := newNativeJob(is.program, makeParams(is.task.Query), is.task.Query.Priority)
+	defer job.Free()
+	if s.polish {
+		job.job.polish = 1
+		job.job.polish_params = C.create_default_polish_params()
+	}
+
+	// Номер точки в общей последовательности: доли островов не пересекаются,
+	// а их объединение не зависит от числа островов
+	k := uint64(is.task.Island + j*is.task.Islands)
+	state := is.task.Seed ^ (k+1)*0x9e3779b97f4a7c15
+	is.mu.Lock()
+	center, radius := []float64(nil), is.task.Radius
+	if j%islandLocalEvery == islandLocalEvery-1 && is.elite != nil {
+		center, radius = is.elite, is.task.Radius*islandLocalRadius
+	}
+	for i := range job.x {
+		x := 1.0
+		if center != nil {
+			x = center[i]
+		}
+		if k > 0 || center != nil {
+			// Точка 0 - обычное начальное приближение из единиц
+			x += radius * (2*uniform(&state) - 1)
+		}
+		job.x[i] = C.double(x)
+	}
+	is.mu.Unlock()
+
+	if err := s.pool.Run(job); err != nil {
+		return err
+	}
+	is.mu.Lock()
+	defer is.mu.Unlock()
+	is.starts++
+	if value := float64(job.job.final_value); job.job.status == 0 && value < is.value {
+		is.value = value
+		is.best = make([]float64, len(job.x))
+		for i, x := range job.x {
+			is.best[i] = float64(x)
+		}
+		if value < is.eliteV {
+			is.elite, is.eliteV = is.best, value
+		}
+	}
+	is.report(IslandReport{Starts: is.starts, Best: is.point()})
+	return nil
+}
+
+// migrate принимает точку другого острова, если она лучше известной
+func (is *island) migrate(migrant IslandPoint) {
+	if len(migrant.Names) != len(migrant.Point) || len(migrant.Point) != len(is.slots) {
+		return
+	}
+	point := make([]float64, len(migrant.Point))
+	for i, name := range migrant.Names {
+		slot, ok := is.slots[name]
+		if !ok {
+			return
+		}
+		point[slot] = migrant.Point[i]
+	}
+	is.mu.Lock()
+	defer is.mu.Unlock()
+	if migrant.Value < is.eliteV {
+		is.elite, is.eliteV = point, migrant.Value
+	}
+}
+
+// point - лучшая точка своих запусков, вызывается под mu
+func (is *island) point() IslandPoint {
+	if is.best == nil {
+		return IslandPoint{Value: math.Inf(1)}
+	}
+	return IslandPoint{Names: is.program.VarNames(), Point: is.best, Value: is.value}
+}
+
+// uniform - число из [0, 1) генератора splitmix64
+func uniform(state *uint64) float64 {
+	*state += 0x9e3779b97f4a7c15
+	z := *state
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9
+	z = (z ^ (z >> 27)) * 0x94d049bb133111eb
+	z ^= z >> 31
+	return float64(z>>11) / (1 << 53)
+}
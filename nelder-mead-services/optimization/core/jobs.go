@@ -0,0 +1,376 @@
+package core
+
+import (
+	"context"
+	"crypto/rand"
+	"encoding/hex"
+	"sync"
+	"time"
+)
+
+// jobsPerWorker - одновременно выполняемых фоновых задач на поток пула:
+// остальные ждут в таблице, не занимая очередь пула
+const jobsPerWorker = 2
+
+// jobCompactRecords - записей, дописанных в журнал, после которых он
+// переписывается текущим состоянием таблицы
+const jobCompactRecords = 4096
+
+type jobEntry struct {
+	mu        sync.Mutex
+	status    JobStatus
+	query     OptimizationQuery
+	snapshot  []float64 // Последний снимок метода, с него задача продолжается
+	ctx       context.Context
+	cancel    context.CancelFunc
+	cancelled bool // Отменена клиентом, а не остановкой сервиса
+}
+
+func (e *jobEntry) Status() JobStatus {
+	e.mu.Lock()
+	defer e.mu.Unlock()
+	return e.status
+}
+
+func (e *jobEntry) finished() bool {
+	switch e.status.State {
+	case JobDone, JobFailed, JobCancelled:
+		return true
+	}
+	return false
+}
+
+// jobTable - фоновые задачи: выполняются с приоритетом PriorityBatch,
+// состояние опрашивается по ID. Порядок блокировок: jobTable.mu, jobEntry.mu.
+type jobTable struct {
+	mu       sync.Mutex
+	jobs     map[string]*jobEntry
+	log      JobLog // nil - задачи не переживают перезапуск
+	appended int
+
+	slots            chan struct{}
+	retention        time.Duration
+	snapshotInterval time.Duration
+
+	ctx  context.Context // Отменяется остановкой сервиса
+	stop context.CancelFunc
+	wg   sync.WaitGroup
+}
+
+func newJobTable(options Options, workers int) *jobTable {
+	ctx, stop := context.WithCancel(context.Background())
+	return &jobTable{
+		jobs:             make(map[string]*jobEntry),
+		log:              options.Jobs,
+		slots:            make(chan struct{}, jobsPerWorker*workers),
+		retention:        options.JobRetention,
+		snapshotInterval: options.JobSnapshotInterval,
+		ctx:              ctx,
+		stop:             stop,
+	}
+}
+
+// SubmitJob ставит задачу в очередь и возвращается сразу. Задача записана
+// в журнал до возврата и будет выполнена, даже если сервис перезапустится.
+func (s *Service) SubmitJob(query OptimizationQuery) (JobStatus, error) {
+	id, err := newJobID()
+	if err != nil {
+		return JobStatus{}, err
+	}
+	query.Priority = PriorityBatch
+	entry := s.jobs.add(id, query, time.Now())
+	if err := s.jobs.append(JobRecord{Kind: JobSubmitted, ID: id, Time: entry.status.Submitted, Query: query}, true); err != nil {
+		s.jobs.remove(id)
+		return JobStatus{}, err
+	}
+	s.jobs.start(s, entry)
+	return entry.Status(), nil
+}
+
+func (s *Service) Job(id string) (JobStatus, error) {
+	entry, err := s.jobs.get(id)
+	if err != nil {
+		return JobStatus{}, err
+	}
+	return entry.Status(), nil
+}
+
+// CancelJob отменяет задачу; выполняемая завершается с лучшей найденной
+// точкой. Отмена завершенной задачи ничего не меняет.
+func (s *Service) CancelJob(id string) (JobStatus, error) {
+	entry, err := s.jobs.get(id)
+	if err != nil {
+		return JobStatus{}, err
+	}
+	entry.mu.Lock()
+	if !entry.finished() {
+		entry.cancelled = true
+		entry.cancel()
+	}
+	entry.mu.Unlock()
+	return entry.Status(), nil
+}
+
+func newJobID() (string, error) {
+	var id [16]byte
+	if _, err := rand.Read(id[:]); err != nil {
+		return "", err
+	}
+	return hex.EncodeToString(id[:]), nil
+}
+
+func (t *jobTable) add(id string, query OptimizationQuery, submitted time.Time) *jobEntry {
+	ctx, cancel := context.WithCancel(t.ctx)
+	entry := &jobEntry{
+		status: JobStatus{ID: id, State: JobQueued, Submitted: submitted},
+		query:  query,
+		ctx:    ctx,
+		cancel: cancel,
+	}
+	t.mu.Lock()
+	t.jobs[id] = entry
+	t.mu.Unlock()
+	return entry
+}
+
+func (t *jobTable) remove(id string) {
+	t.mu.Lock()
+	if entry, ok := t.jobs[id]; ok {
+		entry.cancel()
+		delete(t.jobs, id)
+	}
+	t.mu.Unlock()
+}
+
+func (t *jobTable) get(id string) (*jobEntry, error) {
+	t.mu.Lock()
+	defer t.mu.Unlock()
+	entry, ok := t.jobs[id]
+	if !ok {
+		return nil, ErrJobNotFound
+	}
+	return entry, nil
+}
+
+func (t *jobTable) start(s *Service, entry *jobEntry) {
+	t.wg.Add(1)
+	go t.run(s, entry)
+}
+
+func (t *jobTable) run(s *Service, entry *jobEntry) {
+	defer t.wg.Done()
+	select {
+	case t.slots <- struct{}{}:
+	case <-entry.ctx.Done():
+		t.finish(s, entry, OptimizationReplay{}, entry.ctx.Err())
+		return
+	}
+	defer func() { <-t.slots }()
+
+	entry.mu.Lock()
+	entry.status.State = JobRunning
+	resume := entry.snapshot
+	entry.mu.Unlock()
+
+	sink := &progressSink{
+		ctx:      entry.ctx,
+		interval: s.progressInterval,
+		report: func(progress OptimizationProgress) {
+			entry.mu.Lock()
+			entry.status.Progress = progress
+			entry.mu.Unlock()
+		},
+		snapshotInterval: t.snapshotInterval,
+		resume:           resume,
+	}
+	if t.log != nil && t.snapshotInterval > 0 {
+		sink.snapshot = func(snapshot []float64) {
+			entry.mu.Lock()
+			entry.snapshot = snapshot
+			entry.mu.Unlock()
+			record := JobRecord{Kind: JobSnapshot, ID: entry.status.ID, Time: time.Now(), Snapshot: snapshot}
+			if err := t.append(record, false); err != nil {
+				s.log.Debug("job snapshot not logged", "job", entry.status.ID, "error", err)
+			}
+		}
+	}
+	replay, err := s.optimizeObserved(entry.ctx, entry.query, sink, "job")
+	t.finish(s, entry, replay, err)
+}
+
+func (t *jobTable) finish(s *Service, entry *jobEntry, replay OptimizationReplay, err error) {
+	entry.mu.Lock()
+	if err != nil && !entry.cancelled && t.ctx.Err() != nil {
+		// Остановка сервиса: задача остается незавершенной в журнале
+		// и продолжится с последнего снимка
+		entry.status.State = JobQueued
+		entry.mu.Unlock()
+		return
+	}
+	switch {
+	case entry.cancelled:
+		entry.status.State = JobCancelled
+	case err != nil:
+		entry.status.State = JobFailed
+		entry.status.Error = err.Error()
+	default:
+		entry.status.State = JobDone
+	}
+	entry.status.Replay = replay
+	entry.status.Finished = time.Now()
+	entry.snapshot = nil
+	record := JobRecord{
+		Kind:   JobFinished,
+		ID:     entry.status.ID,
+		Time:   entry.status.Finished,
+		State:  entry.status.State,
+		Replay: replay,
+		Error:  entry.status.Error,
+	}
+	entry.mu.Unlock()
+	entry.cancel()
+
+	if err := t.append(record, true); err != nil {
+		s.log.Error("job result not logged", "job", record.ID, "error", err)
+	}
+}
+
+// append дописывает запись в журнал, переписывая его каждые
+// jobCompactRecords записей
+func (t *jobTable) append(record JobRecord, sync bool) error {
+	if t.log == nil {
+		return nil
+	}
+	t.mu.Lock()
+	defer t.mu.Unlock()
+	if err := t.log.Append(record, sync); err != nil {
+		return err
+	}
+	t.appended++
+	if t.appended < jobCompactRecords {
+		return nil
+	}
+	return t.compact()
+}
+
+// compact заменяет журнал состоянием таблицы, удаляя завершенные задачи
+// старше retention. Вызывается под t.mu.
+func (t *jobTable) compact() error {
+	now := time.Now()
+	records := make([]JobRecord, 0, len(t.jobs))
+	for id, entry := range t.jobs {
+		entry.mu.Lock()
+		if t.expired(entry, now) {
+			entry.mu.Unlock()
+			delete(t.jobs, id)
+			continue
+		}
+		records = append(records, JobRecord{Kind: JobSubmitted, ID: id, Time: entry.status.Submitted, Query: entry.query})
+		switch {
+		case entry.finished():
+			records = append(records, JobRecord{
+				Kind:   JobFinished,
+				ID:     id,
+				Time:   entry.status.Finished,
+				State:  entry.status.State,
+				Replay: entry.status.Replay,
+				Error:  entry.status.Error,
+			})
+		case entry.snapshot != nil:
+			records = append(records, JobRecord{Kind: JobSnapshot, ID: id, Time: now, Snapshot: entry.snapshot})
+		}
+		entry.mu.Unlock()
+	}
+	t.appended = 0
+	if t.log == nil {
+		return nil
+	}
+	return t.log.Compact(records)
+}
+
+// resume восстанавливает таблицу по журналу и запускает незавершенные задачи
+func (t *jobTable) resume(s *Service) error {
+	if t.log == nil {
+		return nil
+	}
+	records, err := t.log.Load()
+	if err != nil {
+		return err
+	}
+	for _, record := range records {
+		if record.Kind == JobSubmitted {
+			t.add(record.ID, record.Query, record.Time)
+			continue
+		}
+		entry, ok := t.jobs[record.ID]
+		if !ok {
+			continue
+		}
+		switch record.Kind {
+		case JobSnapshot:
+			entry.snapshot = record.Snapshot
+		case JobFinished:
+			entry.status.State = record.State
+			entry.status.Replay = record.Replay
+			entry.status.Error = record.Error
+			entry.status.Finished = record.Time
+			entry.snapshot = nil
+			entry.cancel()
+		}
+	}
+
+	t.mu.Lock()
+	err = t.compact()
+	var pending []*jobEntry
+	for _, entry := range t.jobs {
+		if !entry.finished() {
+			pending = append(pending, entry)
+		}
+	}
+	t.mu.Unlock()
+	if err != nil {
+		return err
+	}
+	for _, entry := range pending {
+		s.log.Debug("resuming job", "job", entry.status.ID, "snapshot", entry.snapshot != nil)
+		t.start(s, entry)
+	}
+	return nil
+}
+
+// expired - задача завершена раньше чем retention назад. Вызывается под entry.mu.
+func (t *jobTable) expired(entry *jobEntry, now time.Time) bool {
+	return t.retention > 0 && entry.finished() && now.Sub(entry.status.Finished) > t.retention
+}
+
+// sweep удаляет из таблицы завершенные задачи старше retention
+func (t *jobTable) sweep() {
+	if t.retention <= 0 {
+		return
+	}
+	ticker := time.NewTicker(t.retention / 2)
+	defer ticker.Stop()
+	for {
+		select {
+		case <-t.ctx.Done():
+			return
+		case now := <-ticker.C:
+			t.mu.Lock()
+			for id, entry := range t.jobs {
+				entry.mu.Lock()
+				expired := t.expired(entry, now)
+				entry.mu.Unlock()
+				if expired {
+					delete(t.jobs, id)
+				}
+			}
+			t.mu.Unlock()
+		}
+	}
+}
+
+// close прерывает выполняемые задачи со снимком состояния и ждет их
+func (t *jobTable) close() {
+	t.stop()
+	t.wg.Wait()
+}
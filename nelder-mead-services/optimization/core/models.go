@@ -1,9 +1,20 @@
 package core
 
+import "time"
+
+// Priority - класс очереди пула: интерактивные запросы выбираются первыми
+type Priority int
+
+const (
+	PriorityInteractive Priority = iota
+	PriorityBatch
+)
+
 type OptimizationQuery struct {
 	Function  string
 	Tolerance float64
 	MaxIter   int64
+	Priority  Priority
 }
 
 type Variable struct {
@@ -15,3 +26,115 @@ type OptimizationReplay struct {
 	Variable      []Variable
 	FunctionValue float64
 }
+
+// OptimizationProgress - ход метода для клиентов долгих запусков
+type OptimizationProgress struct {
+	Iteration   int64
+	BestValue   float64
+	Spread      float64 // Разброс значений в вершинах симплекса
+	Evaluations int64   // Вычислений целевой функции
+}
+
+// JobState - состояние фоновой задачи
+type JobState string
+
+const (
+	JobQueued    JobState = "queued"
+	JobRunning   JobState = "running"
+	JobDone      JobState = "done"
+	JobFailed    JobState = "failed"
+	JobCancelled JobState = "cancelled"
+)
+
+// JobStatus - состояние фоновой задачи для опроса клиентом. Replay задан
+// для выполненных задач и для отмененных: лучшая точка на момент отмены
+type JobStatus struct {
+	ID        string
+	State     JobState
+	Progress  OptimizationProgress
+	Replay    OptimizationReplay
+	Error     string
+	Submitted time.Time
+	Finished  time.Time
+}
+
+// JobRecordKind - вид записи журнала фоновых задач
+type JobRecordKind string
+
+const (
+	JobSubmitted JobRecordKind = "submitted" // Query
+	JobSnapshot  JobRecordKind = "snapshot"  // Snapshot
+	JobFinished  JobRecordKind = "finished"  // State, Replay, Error
+)
+
+// JobRecord - запись журнала фоновых задач
+type JobRecord struct {
+	Kind     JobRecordKind
+	ID       string
+	Time     time.Time
+	Query    OptimizationQuery
+	Snapshot []float64 // Снимок состояния метода (nelder_mead_snapshot)
+	State    JobState
+	Replay   OptimizationReplay
+	Error    string
+}
+
+// IslandTask - доля острова в кооперативном multi-start: запуски
+// с номерами Island, Island + Islands, ... из Starts стартовых точек
+type IslandTask struct {
+	Query   OptimizationQuery
+	Island  int
+	Islands int
+	Starts  int
+	Seed    uint64
+	Radius  float64 // Точки равномерно в кубе [1 - Radius, 1 + Radius]
+}
+
+// IslandPoint - точка с именами переменных в порядке Point
+type IslandPoint struct {
+	Names []string
+	Point []float64
+	Value float64
+}
+
+// IslandReport - ход острова: лучшая точка его запусков
+type IslandReport struct {
+	Starts int // Выполнено запусков
+	Best   IslandPoint
+	Done   bool // Доля выполнена
+}
+
+type CacheStats struct {
+	Hits      int64
+	Misses    int64
+	Evictions int64
+	Entries   int
+	Nodes     int64
+}
+
+type WorkerPoolStats struct {
+	InteractiveDepth int
+	BatchDepth       int
+	Admitted         int64
+	Deferred         int64
+	RejectedFull     int64
+	RejectedCost     int64
+	Completed        int64
+	Preempted        int64
+	Batches          int64
+	WaitTotal        float64 // Суммарное ожидание в очереди, с
+	WaitMax          float64
+}
+
+// ScreenStats - как часто предварительный просмотр бокса находит бассейн
+// лучше обычного запуска из единиц
+type ScreenStats struct {
+	Runs     int64 // Оптимизаций с просмотром
+	Improved int64 // Из них ответ лучше запуска из единиц больше чем на tolerance
+}
+
+type CoalesceStats struct {
+	Leaders   int64 // Запросов, выполнивших вычисление
+	Coalesced int64 // Запросов, получивших результат чужого вычисления
+	InFlight  int
+}
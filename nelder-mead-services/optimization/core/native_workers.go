@@ -0,0 +1,398 @@
+package core
+
+/*
+#include "shm_channel.h"
+*/
+import "C"
+
+import (
+	"errors"
+	"fmt"
+	"log/slog"
+	"os"
+	"os/exec"
+	"sync"
+	"sync/atomic"
+	"syscall"
+	"unsafe"
+)
+
+// nativeWorkerEnv отмечает процесс-исполнитель, запущенный сервисом
+const nativeWorkerEnv = "OPTIMIZATION_NATIVE_WORKER"
+
+// Дескрипторы канала в процессе-исполнителе: ExtraFiles начинаются с 3
+const (
+	workerMemfd        = 3
+	workerRequestEvent = 4
+	workerReplyEvent   = 5
+)
+
+var (
+	// errNativeUnavailable - задача не уходит исполнителю (не помещается
+	// в ячейку кольца или живых исполнителей нет) и выполняется пулом
+	errNativeUnavailable = errors.New("native worker is unavailable")
+
+	eventSignal = []byte{1, 0, 0, 0, 0, 0, 0, 0} // Прибавляет 1 к счетчику eventfd
+)
+
+// RunNativeWorker обслуживает канал, если процесс запущен сервисом как
+// исполнитель (Options.NativeWorkers), и возвращает true после остановки.
+// Вызывается первым в main: исполнитель - тот же исполняемый файл.
+func RunNativeWorker() bool {
+	if os.Getenv(nativeWorkerEnv) == "" {
+		return false
+	}
+	if C.shm_channel_serve(workerMemfd, workerRequestEvent, workerReplyEvent) != 0 {
+		fmt.Fprintln(os.Stderr, "native worker: the shared-memory channel is unavailable")
+		os.Exit(1)
+	}
+	return true
+}
+
+type nativeResult struct {
+	replay OptimizationReplay
+	err    error
+}
+
+// workerProcess - процесс-исполнитель и его канал. Запросы пишутся в кольцо
+// под mu (у кольца один производитель), ответы разбирает горутина receive.
+type workerProcess struct {
+	cmd     *exec.Cmd
+	region  []byte        // Отображение области канала
+	wake    *os.File      // eventfd кольца запросов
+	ready   *os.File      // eventfd кольца ответов
+	slots   chan struct{} // Свободные места: в работе не больше SHM_RING_SLOTS запросов
+	exited  atomic.Bool   // Процесс завершился, receive дочитывает ответы и выходит
+	drained chan struct{} // Закрывается при выходе receive
+
+	mu      sync.Mutex
+	head    uint64 // Опубликовано запросов
+	nextID  uint64
+	pending map[uint64]chan nativeResult
+	dead    bool // Область освобождена
+}
+
+// word - счетчик кольца, общий с исполнителем
+func (w *workerProcess) word(offset int) *uint64 {
+	return (*uint64)(unsafe.Pointer(&w.region[offset]))
+}
+
+func (w *workerProcess) cell(ring int, index uint64) unsafe.Pointer {
+	return unsafe.Pointer(&w.region[ring+C.SHM_RING_DATA+int(index&(C.SHM_RING_SLOTS-1))*C.SHM_SLOT_SIZE])
+}
+
+// nativeWorkers - процессы-исполнители обычных запусков метода над
+// выражением. Запросы и ответы идут через кольца в общей памяти без вызовов
+// cgo, а падение нативного кода завершает исполнитель, а не сервис: запрос,
+// на котором упал процесс, завершается ErrWorkerCrashed, не начатые запросы
+// возвращаются пулу, процесс перезапускается.
+type nativeWorkers struct {
+	log          *slog.Logger
+	cacheEntries int
+	cacheNodes   int64
+	next         atomic.Uint64 // Начало обхода при выборе исполнителя
+	wg           sync.WaitGroup
+
+	mu      sync.Mutex
+	workers []*workerProcess // nil - процесс перезапускается
+	closed  bool
+}
+
+func startNativeWorkers(log *slog.Logger, options Options) (*nativeWorkers, error) {
+	p := &nativeWorkers{
+		log:          log,
+		cacheEntries: options.CacheEntries,
+		cacheNodes:   options.CacheNodes,
+		workers:      make([]*workerProcess, options.NativeWorkers),
+	}
+	for i := range p.workers {
+		w, err := p.start()
+		if err != nil {
+			p.Close()
+			return nil, err
+		}
+		p.workers[i] = w
+		p.wg.Add(1)
+		go p.watch(i, w)
+	}
+	return p, nil
+}
+
+func (p *nativeWorkers) start() (*workerProcess, error) {
+	var memfd, request, reply C.int
+	if C.shm_channel_create(C.int(p.cacheEntries), C.longlong(p.cacheNodes), &memfd, &request, &reply) != 0 {
+		return nil, errors.New("cannot create shared-memory channel")
+	}
+	// После запуска область держат отображения сервиса и исполнителя
+	mem := os.NewFile(uintptr(memfd), "nelder-mead-channel")
+	defer mem.Close()
+	wake := os.NewFile(uintptr(request), "nelder-mead-requests")
+	ready := os.NewFile(uintptr(reply), "nelder-mead-replies")
+
+	region, err := syscall.Mmap(int(memfd), 0, C.SHM_CHANNEL_SIZE, syscall.PROT_READ|syscall.PROT_WRITE, syscall.MAP_SHARED)
+	if err != nil {
+		wake.Close()
+		ready.Close()
+		return nil, fmt.Errorf("cannot map shared-memory channel: %w", err)
+	}
+	w := &workerProcess{
+		region:  region,
+		wake:    wake,
+		ready:   ready,
+		slots:   make(chan struct{}, C.SHM_RING_SLOTS),
+		drained: make(chan struct{}),
+		pending: make(map[uint64]chan nativeResult),
+	}
+
+	executable, err := os.Executable()
+	if err == nil {
+		w.cmd = exec.Command(executable)
+		w.cmd.Env = append(os.Environ(), nativeWorkerEnv+"=1")
+		w.cmd.ExtraFiles = []*os.File{mem, wake, ready}
+		w.cmd.Stderr = os.Stderr
+		w.cmd.SysProcAttr = &syscall.SysProcAttr{Pdeathsig: syscall.SIGKILL}
+		err = w.cmd.Start()
+	}
+	if err != nil {
+		w.release()
+		return nil, fmt.Errorf("cannot start native worker: %w", err)
+	}
+	for i := 0; i < C.SHM_RING_SLOTS; i++ {
+		w.slots <- struct{}{}
+	}
+	go w.receive()
+	return w, nil
+}
+
+// release освобождает канал после завершения процесса
+func (w *workerProcess) release() {
+	w.mu.Lock()
+	w.dead = true
+	w.mu.Unlock()
+	syscall.Munmap(w.region)
+	w.wake.Close()
+	w.ready.Close()
+}
+
+// watch ждет завершения исполнителя i и перезапускает его, если сервис
+// не останавливается
+func (p *nativeWorkers) watch(i int, w *workerProcess) {
+	defer p.wg.Done()
+	for {
+		err := w.cmd.Wait()
+		w.exited.Store(true)
+		w.ready.Write(eventSignal) // Будит receive, если он спит
+		<-w.drained
+		crashed, rerouted := w.fail()
+		w.release()
+
+		p.mu.Lock()
+		if p.closed {
+			p.mu.Unlock()
+			return
+		}
+		p.workers[i] = nil
+		p.mu.Unlock()
+		p.log.Error("native worker exited, restarting", "pid", w.cmd.Process.Pid, "error", err,
+			"failed_requests", crashed, "rerouted_requests", rerouted)
+
+		if w, err = p.start(); err != nil {
+			p.log.Error("cannot restart native worker", "error", err)
+			return
+		}
+		p.mu.Lock()
+		p.workers[i] = w
+		closed := p.closed
+		p.mu.Unlock()
+		if closed {
+			// Close прошел, пока процесс перезапускался, и не остановил его:
+			// следующий Wait вернется после остановки
+			w.stop()
+		}
+	}
+}
+
+// fail завершает запросы, оставшиеся без ответа. Исполнитель разбирает
+// кольцо запросов по порядку, так что выполнялся только запрос в хвосте
+// кольца (номера запросов на единицу больше позиций): он завершается
+// ErrWorkerCrashed, остальные не начинались и уходят пулу.
+func (w *workerProcess) fail() (crashed, rerouted int) {
+	w.mu.Lock()
+	defer w.mu.Unlock()
+	running := atomic.LoadUint64(w.word(C.SHM_CHANNEL_REQUESTS+C.SHM_RING_TAIL)) + 1
+	for id, result := range w.pending {
+		if id == running {
+			result <- nativeResult{err: ErrWorkerCrashed}
+			crashed++
+		} else {
+			result <- nativeResult{err: errNativeUnavailable}
+			rerouted++
+		}
+	}
+	w.pending = nil
+	return crashed, rerouted
+}
+
+// receive разбирает кольцо ответов. Ответы копируются в память Go прямо
+// из ячеек, после чего ячейка возвращается исполнителю.
+func (w *workerProcess) receive() {
+	defer close(w.drained)
+	ring := C.SHM_CHANNEL_REPLIES
+	head, tail, waiting := w.word(ring+C.SHM_RING_HEAD), w.word(ring+C.SHM_RING_TAIL), w.word(ring+C.SHM_RING_WAITING)
+	var position uint64
+	var event [8]byte
+	for {
+		for position != atomic.LoadUint64(head) {
+			cell := w.cell(ring, position)
+			reply := (*C.ShmReply)(cell)
+			id, result := uint64(reply.id), decodeReply(reply, cell)
+			position++
+			atomic.StoreUint64(tail, position)
+
+			w.mu.Lock()
+			done := w.pending[id]
+			delete(w.pending, id)
+			w.mu.Unlock()
+			w.slots <- struct{}{}
+			if done != nil {
+				done <- result
+			}
+		}
+		if w.exited.Load() {
+			return
+		}
+
+		// Флаг ожидания выставляется до повторной проверки: исполнитель,
+		// опубликовавший ответ после нее, увидит флаг и разбудит
+		atomic.StoreUint64(waiting, 1)
+		if position == atomic.LoadUint64(head) && !w.exited.Load() {
+			w.ready.Read(event[:])
+		}
+		atomic.StoreUint64(waiting, 0)
+	}
+}
+
+func decodeReply(reply *C.ShmReply, cell unsafe.Pointer) nativeResult {
+	data := unsafe.Add(cell, C.sizeof_ShmReply)
+	if reply.status == C.SHM_STATUS_INVALID {
+		message := unsafe.Slice((*byte)(data), int(reply.names_size))
+		return nativeResult{err: fmt.Errorf("native worker: %s", string(message[:len(message)-1]))}
+	}
+	if reply.status != 0 {
+		return nativeResult{err: ErrOptimizationFailed}
+	}
+
+	n := int(reply.dimension)
+	x := unsafe.Slice((*C.double)(data), n)
+	names := make([]string, 0, n)
+	buffer := unsafe.Slice((*byte)(unsafe.Add(data, n*C.sizeof_double)), int(reply.names_size))
+	for start, i := 0, 0; i < len(buffer); i++ {
+		if buffer[i] == 0 {
+			names = append(names, string(buffer[start:i]))
+			start = i + 1
+		}
+	}
+	return nativeResult{replay: makeReplay(names, x, reply.final_value)}
+}
+
+// pick выбирает живого исполнителя с наибольшим числом свободных мест
+func (p *nativeWorkers) pick() *workerProcess {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+	start := int(p.next.Add(1))
+	var best *workerProcess
+	for i := range p.workers {
+		w := p.workers[(start+i)%len(p.workers)]
+		if w != nil && !w.exited.Load() && (best == nil || len(w.slots) > len(best.slots)) {
+			best = w
+		}
+	}
+	return best
+}
+
+// fitsSlot - запрос и ответ помещаются в ячейку кольца
+func fitsSlot(program *NativeProgram, source string) bool {
+	if C.sizeof_ShmRequest+len(source) > C.SHM_SLOT_SIZE {
+		return false
+	}
+	size := C.sizeof_ShmReply + program.Dimension()*C.sizeof_double
+	for _, name := range program.VarNames() {
+		size += len(name) + 1
+	}
+	return size <= C.SHM_SLOT_SIZE
+}
+
+// Run выполняет запуск JOB_INCREMENTAL с начальной точкой из единиц
+// на наименее загруженном исполнителе
+func (p *nativeWorkers) Run(program *NativeProgram, query OptimizationQuery, polish bool) (OptimizationReplay, error) {
+	source := query.Function
+	if !fitsSlot(program, source) {
+		return OptimizationReplay{}, errNativeUnavailable
+	}
+	w := p.pick()
+	if w == nil {
+		return OptimizationReplay{}, errNativeUnavailable
+	}
+	select {
+	case <-w.slots:
+	case <-w.drained:
+		return OptimizationReplay{}, errNativeUnavailable
+	}
+
+	done := make(chan nativeResult, 1)
+	w.mu.Lock()
+	if w.pending == nil {
+		w.mu.Unlock()
+		return OptimizationReplay{}, errNativeUnavailable
+	}
+	w.nextID++
+	w.pending[w.nextID] = done
+
+	cell := w.cell(C.SHM_CHANNEL_REQUESTS, w.head)
+	request := (*C.ShmRequest)(cell)
+	request.id = C.uint64_t(w.nextID)
+	request.tolerance = C.double(query.Tolerance)
+	request.max_iter = C.int32_t(query.MaxIter)
+	request.polish = 0
+	if polish {
+		request.polish = 1
+	}
+	request.dimension = 0
+	request.source_size = C.int32_t(len(source))
+	copy(unsafe.Slice((*byte)(unsafe.Add(cell, C.sizeof_ShmRequest)), len(source)), source)
+
+	w.head++
+	atomic.StoreUint64(w.word(C.SHM_CHANNEL_REQUESTS+C.SHM_RING_HEAD), w.head)
+	if atomic.LoadUint64(w.word(C.SHM_CHANNEL_REQUESTS+C.SHM_RING_WAITING)) != 0 {
+		w.wake.Write(eventSignal)
+	}
+	w.mu.Unlock()
+
+	result := <-done
+	return result.replay, result.err
+}
+
+// Close останавливает исполнителей после выполнения принятых запросов
+func (p *nativeWorkers) Close() {
+	p.mu.Lock()
+	p.closed = true
+	workers := append([]*workerProcess(nil), p.workers...)
+	p.mu.Unlock()
+	for _, w := range workers {
+		if w != nil {
+			w.stop()
+		}
+	}
+	p.wg.Wait()
+}
+
+func (w *workerProcess) stop() {
+	w.mu.Lock()
+	defer w.mu.Unlock()
+	if w.dead {
+		return
+	}
+	header := (*C.ShmChannelHeader)(unsafe.Pointer(&w.region[0]))
+	atomic.StoreUint32((*uint32)(unsafe.Pointer(&header.stop)), 1)
+	w.wake.Write(eventSignal)
+}
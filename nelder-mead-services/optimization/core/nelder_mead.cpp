@@ -20,7 +20,7 @@ struct Vertex {
     std::vector<double> x;
     double value;
 
-    Vertex(int n) : x(n) {}
+    Vertex(int n) : x(n), value(HUGE_VAL) {}
     
     bool operator<(const Vertex& other) const {
         return value < other.value;
@@ -28,7 +28,7 @@ struct Vertex {
 };
 
 
-std::vector<Vertex> create_initial_simplex(ObjectiveFunction f, const double* x0, int n, void* context) {
+std::vector<Vertex> create_initial_simplex(ObjectiveFunction f, DeltaObjectiveFunction delta, const double* x0, int n, void* context) {
     std::vector<Vertex> vertices;
     
 
@@ -46,7 +46,11 @@ std::vector<Vertex> create_initial_simplex(ObjectiveFunction f, const double* x0
             vertices[i + 1].x[i] *= 1.05;
         }
         
-        vertices[i + 1].value = f(vertices[i + 1].x.data(), n, context);
+        if (delta) {
+            vertices[i + 1].value = delta(vertices[i + 1].x.data(), n, &i, 1, context);
+        } else {
+            vertices[i + 1].value = f(vertices[i + 1].x.data(), n, context);
+        }
     }
     
     return vertices;
@@ -102,7 +106,8 @@ void shrink_simplex(std::vector<Vertex>& vertices, double sigma, int n) {
     }
 }
 
-bool check_convergence(const std::vector<Vertex>& vertices, double tolerance) {
+// Стандартное отклонение значений в вершинах
+double value_spread(const std::vector<Vertex>& vertices) {
     double mean = 0.0;
     for (const auto& vertex : vertices) {
         mean += vertex.value;
@@ -116,85 +121,237 @@ bool check_convergence(const std::vector<Vertex>& vertices, double tolerance) {
     }
     variance /= vertices.size();
     
-    return std::sqrt(variance) < tolerance;
+    return std::sqrt(variance);
 }
 
-int nelder_mead_optimize(
-    ObjectiveFunction f,
-    double* x,
-    int n,
-    OptimizationParams* params,
-    void* context,
-    double* final_value
-) {
-    if (!x || !params || n <= 0) return -1;
+bool check_convergence(const std::vector<Vertex>& vertices, double tolerance) {
+    return value_spread(vertices) < tolerance;
+}
 
-    auto vertices = create_initial_simplex(f, x, n, context);
+struct NelderMeadState {
+    ObjectiveFunction f;
+    void* context;
+    OptimizationParams params;
+    ProgressParams progress;
+    int n;
+    int iterations;
+    long long evaluations;
+    bool done;
+    std::vector<Vertex> vertices;
+};
+
+inline double evaluate(NelderMeadState& state, Vertex& vertex) {
+    ++state.evaluations;
+    return state.f(vertex.x.data(), state.n, state.context);
+}
+
+// Сообщает наблюдателю ход метода, true - наблюдатель просит остановиться
+bool report_progress(const NelderMeadState& state) {
+    NelderMeadProgress progress;
+    progress.iteration = state.iterations;
+    progress.best_value = std::min_element(state.vertices.begin(), state.vertices.end())->value;
+    progress.spread = value_spread(state.vertices);
+    progress.evaluations = state.evaluations;
+    progress.state = &state;
+    return state.progress.callback(&progress, state.progress.context) != 0;
+}
+
+// Одна итерация метода над упорядоченным симплексом
+void perform_iteration(NelderMeadState& state) {
+    const OptimizationParams* params = &state.params;
+    std::vector<Vertex>& vertices = state.vertices;
+    int n = state.n;
+
+    auto centroid = compute_centroid(vertices, n);
+
+    auto reflected = reflect_point(centroid, vertices.back(), params->alpha, n);
+    reflected.value = evaluate(state, reflected);
     
-    for (int iter = 0; iter < params->max_iter; ++iter) {
-        std::sort(vertices.begin(), vertices.end());
+    if (reflected.value < vertices[0].value) {
 
-        if (check_convergence(vertices, params->tolerance)) {
-            break;
+        auto expanded = expand_point(centroid, reflected, params->gamma, n);
+        expanded.value = evaluate(state, expanded);
+        
+        if (expanded.value < reflected.value) {
+            vertices.back() = expanded;
+        } else {
+            vertices.back() = reflected;
         }
+    }
+    else if (reflected.value < vertices[vertices.size()-2].value) {
 
-        auto centroid = compute_centroid(vertices, n);
+        vertices.back() = reflected;
+    }
+    else {
 
-        auto reflected = reflect_point(centroid, vertices.back(), params->alpha, n);
-        reflected.value = f(reflected.x.data(), n, context);
+        bool do_shrink = true;
         
-        if (reflected.value < vertices[0].value) {
+        if (reflected.value < vertices.back().value) {
 
-            auto expanded = expand_point(centroid, reflected, params->gamma, n);
-            expanded.value = f(expanded.x.data(), n, context);
+            auto contracted = contract_point(centroid, reflected, params->rho, n);
+            contracted.value = evaluate(state, contracted);
             
-            if (expanded.value < reflected.value) {
-                vertices.back() = expanded;
-            } else {
-                vertices.back() = reflected;
+            if (contracted.value <= reflected.value) {
+                vertices.back() = contracted;
+                do_shrink = false;
             }
         }
-        else if (reflected.value < vertices[vertices.size()-2].value) {
-
-            vertices.back() = reflected;
-        }
         else {
-
-            bool do_shrink = true;
+            auto contracted = contract_point(centroid, vertices.back(), params->rho, n);
+            contracted.value = evaluate(state, contracted);
             
-            if (reflected.value < vertices.back().value) {
-
-                auto contracted = contract_point(centroid, reflected, params->rho, n);
-                contracted.value = f(contracted.x.data(), n, context);
-                
-                if (contracted.value <= reflected.value) {
-                    vertices.back() = contracted;
-                    do_shrink = false;
-                }
-            }
-            else {
-                auto contracted = contract_point(centroid, vertices.back(), params->rho, n);
-                contracted.value = f(contracted.x.data(), n, context);
-                
-                if (contracted.value < vertices.back().value) {
-                    vertices.back() = contracted;
-                    do_shrink = false;
-                }
+            if (contracted.value < vertices.back().value) {
+                vertices.back() = contracted;
+                do_shrink = false;
             }
-            
-            if (do_shrink) {
-                shrink_simplex(vertices, params->sigma, n);
-                for (size_t i = 1; i < vertices.size(); ++i) {
-                    vertices[i].value = f(vertices[i].x.data(), n, context);
-                }
+        }
+        
+        if (do_shrink) {
+            shrink_simplex(vertices, params->sigma, n);
+            for (size_t i = 1; i < vertices.size(); ++i) {
+                vertices[i].value = evaluate(state, vertices[i]);
             }
         }
     }
-    
+}
 
-    std::sort(vertices.begin(), vertices.end());
-    std::copy(vertices[0].x.begin(), vertices[0].x.end(), x);
-    if (final_value) *final_value = vertices[0].value;
-    
+NelderMeadState* nelder_mead_start(
+    ObjectiveFunction f,
+    DeltaObjectiveFunction delta,
+    const double* x,
+    int n,
+    const OptimizationParams* params,
+    void* context
+) {
+    if (!x || !params || n <= 0) return nullptr;
+
+    NelderMeadState* state = new NelderMeadState();
+    state->f = f;
+    state->context = context;
+    state->params = *params;
+    state->progress = ProgressParams();
+    state->n = n;
+    state->iterations = 0;
+    state->evaluations = n + 1;
+    state->done = false;
+    state->vertices = create_initial_simplex(f, delta, x, n, context);
+    return state;
+}
+
+int nelder_mead_step(NelderMeadState* state, int max_steps) {
+    for (int step = 0; step < max_steps && !state->done; ++step) {
+        if (state->iterations >= state->params.max_iter) {
+            state->done = true;
+            break;
+        }
+
+        std::sort(state->vertices.begin(), state->vertices.end());
+
+        if (check_convergence(state->vertices, state->params.tolerance)) {
+            state->done = true;
+            break;
+        }
+
+        perform_iteration(*state);
+        ++state->iterations;
+
+        if (state->progress.callback && state->iterations % state->progress.every == 0 &&
+            report_progress(*state)) {
+            state->done = true;
+            break;
+        }
+    }
+    if (state->iterations >= state->params.max_iter) state->done = true;
+    return state->done ? 1 : 0;
+}
+
+int nelder_mead_iterations(const NelderMeadState* state) {
+    return state->iterations;
+}
+
+void nelder_mead_observe(NelderMeadState* state, const ProgressParams* progress) {
+    state->progress = progress ? *progress : ProgressParams();
+    if (state->progress.every < 1) state->progress.every = 1;
+}
+
+double nelder_mead_best(NelderMeadState* state, double* x) {
+    std::sort(state->vertices.begin(), state->vertices.end());
+    if (x) std::copy(state->vertices[0].x.begin(), state->vertices[0].x.end(), x);
+    return state->vertices[0].value;
+}
+
+void nelder_mead_free(NelderMeadState* state) {
+    delete state;
+}
+
+int nelder_mead_snapshot_size(int n) {
+    return 2 + (n + 1) * (n + 1);
+}
+
+void nelder_mead_snapshot(const NelderMeadState* state, double* snapshot) {
+    *snapshot++ = state->iterations;
+    *snapshot++ = static_cast<double>(state->evaluations);
+    for (const Vertex& vertex : state->vertices) {
+        snapshot = std::copy(vertex.x.begin(), vertex.x.end(), snapshot);
+        *snapshot++ = vertex.value;
+    }
+}
+
+NelderMeadState* nelder_mead_restore(
+    ObjectiveFunction f,
+    const double* snapshot,
+    int n,
+    const OptimizationParams* params,
+    void* context
+) {
+    if (!snapshot || !params || n <= 0) return nullptr;
+
+    NelderMeadState* state = new NelderMeadState();
+    state->f = f;
+    state->context = context;
+    state->params = *params;
+    state->progress = ProgressParams();
+    state->n = n;
+    state->iterations = static_cast<int>(*snapshot++);
+    state->evaluations = static_cast<long long>(*snapshot++);
+    state->done = false;
+    for (int i = 0; i <= n; ++i) {
+        state->vertices.push_back(Vertex(n));
+        std::copy(snapshot, snapshot + n, state->vertices.back().x.begin());
+        state->vertices.back().value = snapshot[n];
+        snapshot += n + 1;
+    }
+    return state;
+}
+
+int nelder_mead_optimize(
+    ObjectiveFunction f,
+    double* x,
+    int n,
+    OptimizationParams* params,
+    void* context,
+    double* final_value
+) {
+    return nelder_mead_optimize_incremental(f, nullptr, x, n, params, context, final_value);
+}
+
+int nelder_mead_optimize_incremental(
+    ObjectiveFunction f,
+    DeltaObjectiveFunction delta,
+    double* x,
+    int n,
+    OptimizationParams* params,
+    void* context,
+    double* final_value
+) {
+    NelderMeadState* state = nelder_mead_start(f, delta, x, n, params, context);
+    if (!state) return -1;
+
+    while (!nelder_mead_step(state, params->max_iter)) {
+    }
+
+    double value = nelder_mead_best(state, x);
+    if (final_value) *final_value = value;
+    nelder_mead_free(state);
     return 0;
-} 
\ No newline at end of file
+}
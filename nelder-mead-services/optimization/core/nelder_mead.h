@@ -8,6 +8,24 @@ extern "C" {
 
 typedef double (*ObjectiveFunction)(double* x, int n, void* context);
 
+// Инкрементальная целевая функция: x отличается от точки последнего вызова
+// ObjectiveFunction только в координатах changed
+typedef double (*DeltaObjectiveFunction)(double* x, int n, const int* changed, int num_changed, void* context);
+
+typedef struct NelderMeadState NelderMeadState;
+
+// Ход метода для наблюдателя
+typedef struct {
+    int iteration;          // Выполнено итераций
+    double best_value;      // Значение в лучшей вершине
+    double spread;          // Разброс значений в вершинах (сравнивается с tolerance)
+    long long evaluations;  // Вычислений целевой функции
+    const NelderMeadState* state; // Для nelder_mead_snapshot на время вызова
+} NelderMeadProgress;
+
+// Наблюдатель: ненулевой результат досрочно завершает метод с лучшей вершиной
+typedef int (*ProgressCallback)(const NelderMeadProgress* progress, void* context);
+
 typedef struct {
     double tolerance;      // Точность для критерия остановки
     int max_iter;         // Максимальное число итераций
@@ -17,6 +35,14 @@ typedef struct {
     double sigma;        // Коэффициент глобального сжатия (обычно 0.5)
 } OptimizationParams;
 
+// Наблюдатель пошагового запуска (nelder_mead_observe). Отдельно от
+// OptimizationParams, чтобы не менять раскладку этой структуры.
+typedef struct {
+    ProgressCallback callback; // NULL - без наблюдения
+    void* context;
+    int every;                 // Вызывать наблюдателя раз в столько итераций
+} ProgressParams;
+
 
 OptimizationParams create_default_params(void);
 
@@ -30,6 +56,65 @@ int nelder_mead_optimize(
     double* final_value      // Итоговое значение функции
 );
 
+// То же, но вершины начального симплекса (отличаются от x0 одной координатой)
+// вычисляются через delta
+int nelder_mead_optimize_incremental(
+    ObjectiveFunction f,
+    DeltaObjectiveFunction delta,
+    double* x,
+    int n,
+    OptimizationParams* params,
+    void* context,
+    double* final_value
+);
+
+
+// Пошаговый режим: состояние метода (симплекс и счетчик итераций) живет между
+// вызовами nelder_mead_step, так что запуск можно прервать и продолжить
+// в другом потоке без потери прогресса
+
+// Строит начальный симплекс (как nelder_mead_optimize_incremental).
+// Параметры копируются, context должен жить до nelder_mead_free.
+NelderMeadState* nelder_mead_start(
+    ObjectiveFunction f,
+    DeltaObjectiveFunction delta,   // Может быть NULL
+    const double* x,
+    int n,
+    const OptimizationParams* params,
+    void* context
+);
+
+// Выполняет не больше max_steps итераций. Возвращает 1, если метод
+// завершен (сходимость или max_iter), 0, если работу можно продолжить.
+int nelder_mead_step(NelderMeadState* state, int max_steps);
+
+int nelder_mead_iterations(const NelderMeadState* state);
+
+// Подключает наблюдателя к запуску (NULL или callback == NULL - отключает).
+// Вызывается из nelder_mead_step раз в every итераций.
+void nelder_mead_observe(NelderMeadState* state, const ProgressParams* progress);
+
+// Лучшая вершина: точка копируется в x (если x != NULL), возвращается значение
+double nelder_mead_best(NelderMeadState* state, double* x);
+
+void nelder_mead_free(NelderMeadState* state);
+
+// Снимок состояния: счетчики итераций и вычислений, затем n + 1 вершин
+// (n координат и значение). Размер в double - nelder_mead_snapshot_size(n).
+int nelder_mead_snapshot_size(int n);
+
+void nelder_mead_snapshot(const NelderMeadState* state, double* snapshot);
+
+// Продолжение метода со снимка, в том числе в другом процессе: вершины
+// не вычисляются заново, ход метода совпадает с непрерывным запуском
+NelderMeadState* nelder_mead_restore(
+    ObjectiveFunction f,
+    const double* snapshot,
+    int n,
+    const OptimizationParams* params,
+    void* context
+);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,164 @@
+#include "polish.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <vector>
+
+namespace {
+
+// Константы условий Вольфе и предел числа проб линейного поиска
+const double kArmijo = 1e-4;
+const double kCurvature = 0.9;
+const int kLineSearchSteps = 40;
+
+struct Correction {
+    std::vector<double> s;   // шаг по x
+    std::vector<double> y;   // изменение градиента
+    double rho;              // 1 / (s, y)
+};
+
+double dot(const std::vector<double>& a, const std::vector<double>& b) {
+    double sum = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+double max_abs(const std::vector<double>& a) {
+    double result = 0.0;
+    for (double v : a) result = std::max(result, std::fabs(v));
+    return result;
+}
+
+// Двухцикловая рекурсия: d = -H g по сохраненным парам
+void search_direction(const std::deque<Correction>& history, const std::vector<double>& g, std::vector<double>& d) {
+    d = g;
+    std::vector<double> alpha(history.size());
+    for (size_t k = history.size(); k-- > 0;) {
+        alpha[k] = history[k].rho * dot(history[k].s, d);
+        for (size_t i = 0; i < d.size(); ++i) d[i] -= alpha[k] * history[k].y[i];
+    }
+    if (!history.empty()) {
+        const Correction& last = history.back();
+        double scale = 1.0 / (last.rho * dot(last.y, last.y));
+        for (double& v : d) v *= scale;
+    }
+    for (size_t k = 0; k < history.size(); ++k) {
+        double beta = history[k].rho * dot(history[k].y, d);
+        for (size_t i = 0; i < d.size(); ++i) d[i] += (alpha[k] - beta) * history[k].s[i];
+    }
+    for (double& v : d) v = -v;
+}
+
+} // namespace
+
+
+PolishParams create_default_polish_params(void) {
+    PolishParams params;
+    params.memory = 8;
+    params.max_iter = 200;
+    params.tolerance = 1e-10;
+    return params;
+}
+
+int lbfgs_polish(
+    GradientFunction gradient,
+    DirectionalFunction directional,
+    double* x,
+    int n,
+    const PolishParams* params,
+    void* context,
+    double* final_value
+) {
+    if (!gradient || !x || !params || n <= 0) return -1;
+
+    std::vector<double> point(x, x + n), g(n), d(n), trial(n), g_trial(n);
+    double value = gradient(point.data(), n, g.data(), context);
+    if (!std::isfinite(value)) {
+        if (final_value) *final_value = value;
+        return 0;
+    }
+
+    std::deque<Correction> history;
+    for (int iter = 0; iter < params->max_iter && max_abs(g) > params->tolerance; ++iter) {
+        search_direction(history, g, d);
+        double slope = dot(g, d);
+        if (!(slope < 0.0)) {
+            // Направление не ведет вниз - сброс памяти, шаг по антиградиенту
+            history.clear();
+            for (int i = 0; i < n; ++i) d[i] = -g[i];
+            slope = -dot(g, g);
+        }
+
+        // Поиск шага делением отрезка [lo, hi] по слабым условиям Вольфе
+        double step = history.empty() ? std::min(1.0, 1.0 / std::sqrt(-slope)) : 1.0;
+        double lo = 0.0, hi = std::numeric_limits<double>::infinity();
+        bool accepted = false;
+        for (int k = 0; k < kLineSearchSteps && !accepted; ++k) {
+            for (int i = 0; i < n; ++i) trial[i] = point[i] + step * d[i];
+            double derivative = 0.0;
+            double trial_value;
+            if (directional) {
+                trial_value = directional(trial.data(), n, d.data(), &derivative, context);
+            } else {
+                trial_value = gradient(trial.data(), n, g_trial.data(), context);
+                derivative = dot(g_trial, d);
+            }
+
+            if (!(trial_value <= value + kArmijo * step * slope)) {
+                hi = step;
+            } else if (derivative < kCurvature * slope) {
+                lo = step;
+            } else {
+                accepted = true;
+                break;
+            }
+            step = std::isinf(hi) ? 2.0 * step : 0.5 * (lo + hi);
+        }
+        if (!accepted) {
+            if (lo == 0.0) break;
+            step = lo;
+        }
+
+        for (int i = 0; i < n; ++i) trial[i] = point[i] + step * d[i];
+        double trial_value = gradient(trial.data(), n, g_trial.data(), context);
+        if (!(trial_value < value)) break;
+
+        Correction correction;
+        correction.s.resize(n);
+        correction.y.resize(n);
+        for (int i = 0; i < n; ++i) {
+            correction.s[i] = trial[i] - point[i];
+            correction.y[i] = g_trial[i] - g[i];
+        }
+        double sy = dot(correction.s, correction.y);
+        if (sy > 0.0) {
+            correction.rho = 1.0 / sy;
+            history.push_back(correction);
+            if (static_cast<int>(history.size()) > params->memory) history.pop_front();
+        }
+
+        point.swap(trial);
+        g.swap(g_trial);
+        value = trial_value;
+    }
+
+    std::copy(point.begin(), point.end(), x);
+    if (final_value) *final_value = value;
+    return 0;
+}
+
+int nelder_mead_optimize_polished(
+    ObjectiveFunction f,
+    GradientFunction gradient,
+    double* x,
+    int n,
+    OptimizationParams* params,
+    const PolishParams* polish_params,
+    void* context,
+    double* final_value
+) {
+    int result = nelder_mead_optimize(f, x, n, params, context, final_value);
+    if (result != 0) return result;
+    return lbfgs_polish(gradient, nullptr, x, n, polish_params, context, final_value);
+}
@@ -0,0 +1,55 @@
+#ifndef POLISH_H
+#define POLISH_H
+
+#include "nelder_mead.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// Значение и градиент в точке x
+typedef double (*GradientFunction)(double* x, int n, double* gradient, void* context);
+
+// Значение и производная по направлению direction в точке x
+typedef double (*DirectionalFunction)(double* x, int n, const double* direction, double* derivative, void* context);
+
+typedef struct {
+    int memory;          // Число запоминаемых пар шагов L-BFGS (обычно 8)
+    int max_iter;        // Максимальное число итераций (обычно 200)
+    double tolerance;    // Остановка по максимальной компоненте градиента
+} PolishParams;
+
+
+PolishParams create_default_polish_params(void);
+
+// Доводка L-BFGS от точки x (обычно лучшей вершины метода Нелдера-Мида).
+// Линейный поиск по условиям Вольфе использует directional, если он задан,
+// иначе gradient. x заменяется, только если значение функции уменьшилось.
+int lbfgs_polish(
+    GradientFunction gradient,
+    DirectionalFunction directional,   // Может быть NULL
+    double* x,
+    int n,
+    const PolishParams* params,
+    void* context,
+    double* final_value
+);
+
+// Метод Нелдера-Мида с последующей доводкой L-BFGS
+int nelder_mead_optimize_polished(
+    ObjectiveFunction f,
+    GradientFunction gradient,
+    double* x,
+    int n,
+    OptimizationParams* params,
+    const PolishParams* polish_params,
+    void* context,
+    double* final_value
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // POLISH_H
@@ -4,4 +4,31 @@ import "context"
 
 type Optimizator interface {
 	Optimization(ctx context.Context, query OptimizationQuery) (OptimizationReplay, error)
+	OptimizationProgress(ctx context.Context, query OptimizationQuery, report func(OptimizationProgress)) (OptimizationReplay, error)
+	OptimizationBatch(ctx context.Context, queries []OptimizationQuery, report func(index int, replay OptimizationReplay, err error))
+
+	SubmitJob(query OptimizationQuery) (JobStatus, error)
+	Job(id string) (JobStatus, error)
+	CancelJob(id string) (JobStatus, error)
+
+	// Island выполняет долю острова кооперативного multi-start, migrants -
+	// лучшие точки других островов от координатора
+	Island(ctx context.Context, task IslandTask, migrants <-chan IslandPoint, report func(IslandReport)) error
+}
+
+// ResultCache хранит ответы на уже решенные запросы: результат оптимизации
+// однозначно определяется выражением, параметрами и начальной точкой
+type ResultCache interface {
+	Get(key string) (OptimizationReplay, bool)
+	Put(key string, replay OptimizationReplay) error
+}
+
+// JobLog - журнал фоновых задач с дозаписью: по нему задачи, не завершенные
+// к остановке сервиса, продолжаются после запуска. Append с sync возвращается
+// после записи на диск, без sync - снимки, потеря которых откатывает задачу
+// к предыдущему снимку. Compact заменяет журнал записями records.
+type JobLog interface {
+	Append(record JobRecord, sync bool) error
+	Load() ([]JobRecord, error)
+	Compact(records []JobRecord) error
 }
@@ -0,0 +1,138 @@
+package core
+
+/*
+#include "worker_pool.h"
+#include <stdlib.h>
+
+// Наблюдатель за ходом метода, вызывается из потока пула
+extern int goProgress(NelderMeadProgress* progress, void* context);
+*/
+import "C"
+
+import (
+	"context"
+	"runtime/cgo"
+	"time"
+	"unsafe"
+)
+
+// progressEvery - итераций между вызовами наблюдателя из C++: переход в Go
+// дороже итерации небольшой задачи, частоту сообщений ограничивает interval
+const progressEvery = 32
+
+// progressSink - подписчик на ход одного запуска
+type progressSink struct {
+	ctx      context.Context
+	report   func(OptimizationProgress)
+	interval time.Duration
+	last     time.Time
+
+	// Снимки состояния метода для продолжения после перезапуска (фоновые
+	// задачи): snapshot получает снимок не чаще snapshotInterval и при отмене,
+	// resume - снимок, с которого продолжить, nil - с начальной точки
+	snapshot         func([]float64)
+	snapshotInterval time.Duration
+	lastSnapshot     time.Time
+	resume           []float64
+	dimension        int
+}
+
+// observe подключает наблюдателя к задаче. Метка и снимок хранятся в памяти C:
+// параметры задачи живут в ней после возврата из worker_pool_submit
+func (j *nativeJob) observe(sink *progressSink) {
+	j.progress = (*C.uintptr_t)(C.calloc(1, C.sizeof_uintptr_t))
+	*j.progress = C.uintptr_t(cgo.NewHandle(sink))
+	j.job.progress.callback = (C.ProgressCallback)(C.goProgress)
+	j.job.progress.context = unsafe.Pointer(j.progress)
+	j.job.progress.every = progressEvery
+
+	sink.dimension = len(j.x)
+	sink.lastSnapshot = time.Now()
+	if len(sink.resume) > 0 && len(sink.resume) == snapshotSize(sink.dimension) {
+		snapshot := (*C.double)(C.calloc(C.size_t(len(sink.resume)), C.sizeof_double))
+		values := unsafe.Slice(snapshot, len(sink.resume))
+		for i, v := range sink.resume {
+			values[i] = C.double(v)
+		}
+		j.job.snapshot = snapshot
+	}
+}
+
+func snapshotSize(dimension int) int {
+	return int(C.nelder_mead_snapshot_size(C.int(dimension)))
+}
+
+func (sink *progressSink) takeSnapshot(progress *C.NelderMeadProgress) {
+	snapshot := make([]float64, snapshotSize(sink.dimension))
+	C.nelder_mead_snapshot(progress.state, (*C.double)(unsafe.Pointer(&snapshot[0])))
+	sink.snapshot(snapshot)
+}
+
+//export goProgress
+func goProgress(progress *C.NelderMeadProgress, context unsafe.Pointer) C.int {
+	sink := cgo.Handle(*(*C.uintptr_t)(context)).Value().(*progressSink)
+	// Клиент отменил запрос: метод завершается с лучшей найденной точкой
+	if sink.ctx.Err() != nil {
+		if sink.snapshot != nil {
+			sink.takeSnapshot(progress)
+		}
+		return 1
+	}
+	now := time.Now()
+	if sink.snapshot != nil && now.Sub(sink.lastSnapshot) >= sink.snapshotInterval {
+		sink.lastSnapshot = now
+		sink.takeSnapshot(progress)
+	}
+	if now.Sub(sink.last) >= sink.interval {
+		sink.last = now
+		sink.report(OptimizationProgress{
+			Iteration:   int64(progress.iteration),
+			BestValue:   float64(progress.best_value),
+			Spread:      float64(progress.spread),
+			Evaluations: int64(progress.evaluations),
+		})
+	}
+	return 0
+}
+
+// OptimizationProgress решает задачу как Optimization, но одним запуском
+// метода без разбиения и глобального поиска, сообщая его ход через report
+// не чаще Options.ProgressInterval. report вызывается из потока пула и не
+// должен блокироваться. Отмена ctx досрочно завершает запуск. Выражения,
+// которые не компилируются в C++, решаются без сообщений. Результат одного
+// запуска может быть хуже результата Optimization, поэтому кэшируется
+// под своим ключом.
+func (s *Service) OptimizationProgress(ctx context.Context, query OptimizationQuery, report func(OptimizationProgress)) (OptimizationReplay, error) {
+	return s.optimizeObserved(ctx, query, &progressSink{ctx: ctx, report: report, interval: s.progressInterval}, "observed")
+}
+
+// optimizeObserved кэширует результат под ключом запроса с суффиксом mode.
+// Продолжение со снимка не сохраняется: его результат зависит от снимка.
+func (s *Service) optimizeObserved(ctx context.Context, query OptimizationQuery, sink *progressSink, mode string) (OptimizationReplay, error) {
+	program, err := compileNative(query.Function)
+	if err != nil {
+		return s.Optimization(ctx, query)
+	}
+	defer program.Free()
+
+	key := s.queryKey(program.Canonical(), query) + "|" + mode
+	if s.results != nil {
+		if replay, ok := s.results.Get(key); ok {
+			return replay, nil
+		}
+	}
+
+	replay, err := s.optimizeNative(program, query, sink)
+	if err != nil {
+		return OptimizationReplay{}, err
+	}
+	if err := ctx.Err(); err != nil {
+		return replay, err
+	}
+	if s.results != nil && len(sink.resume) == 0 {
+		if err := s.results.Put(key, replay); err != nil {
+			s.log.Debug("result cache store failed", "error", err)
+		}
+	}
+	return replay, nil
+}
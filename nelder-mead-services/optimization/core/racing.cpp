@@ -0,0 +1,190 @@
+#include "racing.h"
+#include "expression_impl.h"
+#include "worker_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace {
+
+// Запуск гонки: свой вычислитель (состояние метода ссылается на него между
+// раундами, а раунды идут в разных потоках) и счетчик вычислений
+struct Racer {
+    expr::Evaluator evaluator;
+    long long evaluations;
+    NelderMeadState* state;
+    std::vector<double> best;  // Точка снятого или завершенного запуска
+    double value;
+    bool done;
+
+    explicit Racer(const expr::Program& program)
+        : evaluator(program), evaluations(0), state(nullptr), value(HUGE_VAL), done(false) {}
+    ~Racer() { nelder_mead_free(state); }
+
+    // Сохраняет лучшую вершину и освобождает состояние метода
+    void stop() {
+        value = nelder_mead_best(state, best.data());
+        if (std::isnan(value)) value = HUGE_VAL;
+        nelder_mead_free(state);
+        state = nullptr;
+    }
+};
+
+double racer_objective(double* x, int /*n*/, void* context) {
+    Racer* racer = static_cast<Racer*>(context);
+    ++racer->evaluations;
+    return racer->evaluator.evaluate(x);
+}
+
+double racer_objective_delta(double* x, int /*n*/, const int* changed, int num_changed, void* context) {
+    Racer* racer = static_cast<Racer*>(context);
+    ++racer->evaluations;
+    return racer->evaluator.evaluate_delta(x, changed, num_changed);
+}
+
+// Атомарный минимум без блокировок: значение только уменьшается
+void publish(std::atomic<double>& best, double value) {
+    double current = best.load();
+    while (value < current && !best.compare_exchange_weak(current, value)) {
+    }
+}
+
+// Число из [0, 1) генератора splitmix64
+double uniform(unsigned long long& state) {
+    state += 0x9e3779b97f4a7c15ULL;
+    unsigned long long z = state;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z ^= z >> 31;
+    return static_cast<double>(z >> 11) / 9007199254740992.0;
+}
+
+} // namespace
+
+
+RacingParams create_default_racing_params(void) {
+    RacingParams params;
+    params.starts = 16;
+    params.round_iter = 20;
+    params.keep = 0.5;
+    params.gap = 0.1;
+    params.max_starts = 64;
+    params.seed = 0;
+    return params;
+}
+
+int nelder_mead_optimize_racing(
+    const ExprProgram* program,
+    double* x,
+    int n,
+    const double* lower,
+    const double* upper,
+    OptimizationParams* params,
+    const RacingParams* race_params,
+    double* final_value,
+    RacingStats* stats
+) {
+    if (!program || !x || !lower || !upper || !params || !race_params || n <= 0) return -1;
+    if (race_params->starts <= 0 || race_params->round_iter <= 0 || params->max_iter <= 0) return -1;
+    const expr::Program& p = *program->program;
+    if (p.dimension() != n) return -1;
+
+    std::vector<std::unique_ptr<Racer>> racers;
+    std::vector<Racer*> live;
+    int max_starts = std::max(race_params->starts, race_params->max_starts);
+    std::vector<double> point(n);
+
+    // Точка k общей последовательности: 0 - x, остальные равномерно в боксе
+    auto launch = [&]() {
+        int k = static_cast<int>(racers.size());
+        unsigned long long state = race_params->seed ^ (static_cast<unsigned long long>(k) + 1) * 0x9e3779b97f4a7c15ULL;
+        for (int i = 0; i < n; ++i) point[i] = k == 0 ? x[i] : lower[i] + (upper[i] - lower[i]) * uniform(state);
+        racers.push_back(std::unique_ptr<Racer>(new Racer(p)));
+        Racer* racer = racers.back().get();
+        racer->best.resize(n);
+        racer->state = nelder_mead_start(racer_objective, racer_objective_delta, point.data(), n, params, racer);
+        if (!racer->state) return false;
+        live.push_back(racer);
+        return true;
+    };
+    for (int k = 0; k < race_params->starts && k < max_starts; ++k) {
+        if (!launch()) return -1;
+    }
+
+    // Бюджет - итерации, которые заняли бы starts полных запусков
+    long long budget = static_cast<long long>(race_params->starts) * params->max_iter;
+    long long spent = 0;
+    std::atomic<double> best(HUGE_VAL);
+    int pruned = 0;
+    int rounds = 0;
+
+    while (!live.empty()) {
+        std::vector<int> iterations(live.size());
+        std::atomic<int> next(0);
+        auto work = [&](int) {
+            for (int k = next++; k < static_cast<int>(live.size()); k = next++) {
+                Racer* racer = live[k];
+                int before = nelder_mead_iterations(racer->state);
+                racer->done = nelder_mead_step(racer->state, race_params->round_iter) != 0;
+                iterations[k] = nelder_mead_iterations(racer->state) - before;
+                double value = nelder_mead_best(racer->state, nullptr);
+                racer->value = std::isnan(value) ? HUGE_VAL : value;
+                publish(best, racer->value);
+            }
+        };
+
+        worker_pool_parallel(static_cast<int>(live.size()), work);
+        ++rounds;
+
+        // Контрольная точка: завершенные выбывают, отстающие вне лучшей доли снимаются
+        for (int k : iterations) spent += k;
+        std::vector<Racer*> racing;
+        for (Racer* racer : live) {
+            if (racer->done) racer->stop();
+            else racing.push_back(racer);
+        }
+        std::stable_sort(racing.begin(), racing.end(),
+                         [](const Racer* a, const Racer* b) { return a->value < b->value; });
+        double leader = best.load();
+        size_t protect = static_cast<size_t>(std::ceil(race_params->keep * racing.size()));
+        live.clear();
+        for (size_t k = 0; k < racing.size(); ++k) {
+            Racer* racer = racing[k];
+            if (race_params->gap >= 0 && k >= protect && std::isfinite(leader) &&
+                racer->value - leader > race_params->gap * (1.0 + std::fabs(leader))) {
+                racer->stop();
+                ++pruned;
+                continue;
+            }
+            live.push_back(racer);
+        }
+
+        // Новые запуски - на бюджет, не нужный оставшимся до их max_iter
+        long long reserved = 0;
+        for (Racer* racer : live) reserved += params->max_iter - nelder_mead_iterations(racer->state);
+        while (static_cast<int>(live.size()) < race_params->starts && static_cast<int>(racers.size()) < max_starts &&
+               spent + reserved + params->max_iter <= budget) {
+            if (!launch()) return -1;
+            reserved += params->max_iter;
+        }
+    }
+
+    Racer* winner = racers[0].get();
+    long long evaluations = 0;
+    for (const auto& racer : racers) {
+        evaluations += racer->evaluations;
+        if (racer->value < winner->value) winner = racer.get();
+    }
+    if (stats) {
+        stats->evaluations = evaluations;
+        stats->started = static_cast<int>(racers.size());
+        stats->pruned = pruned;
+        stats->rounds = rounds;
+    }
+    if (std::isinf(winner->value)) return -1;
+    std::copy(winner->best.begin(), winner->best.end(), x);
+    if (final_value) *final_value = winner->value;
+    return 0;
+}
@@ -0,0 +1,55 @@
+#ifndef RACING_H
+#define RACING_H
+
+#include "expression.h"
+#include "nelder_mead.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+typedef struct {
+    int starts;          // Одновременных запусков (обычно 16)
+    int round_iter;      // Итераций запуска между контрольными точками (обычно 20)
+    double keep;         // Доля лучших живых запусков, которые не снимаются (обычно 0.5)
+    double gap;          // Снимается запуск хуже лучшего больше чем на gap * (1 + |лучшее|) (обычно 0.1),
+                         // отрицательное - без снятия (обычный multi-start)
+    int max_starts;      // Предел запусков вместе с новыми на освобожденный бюджет (обычно 4 * starts)
+    unsigned long long seed; // Последовательность начальных точек
+} RacingParams;
+
+typedef struct {
+    long long evaluations;   // Вычислений функции всеми запусками
+    int started;             // Запусков начато
+    int pruned;              // Снято на контрольных точках
+    int rounds;              // Контрольных точек
+} RacingStats;
+
+
+RacingParams create_default_racing_params(void);
+
+// Multi-start на боксе [lower, upper] с отсевом: первый запуск из x,
+// остальные из псевдослучайных точек бокса. Запуски идут раундами по
+// round_iter итераций параллельно и публикуют свое лучшее значение в общий
+// атомарный минимум. На контрольной точке после раунда запуски вне лучшей
+// доли keep, отстающие от минимума больше чем на gap, снимаются; бюджет
+// starts * max_iter итераций, который им остался, получают новые запуски.
+// В x возвращается лучшая найденная точка, stats может быть NULL.
+int nelder_mead_optimize_racing(
+    const ExprProgram* program,
+    double* x,
+    int n,
+    const double* lower,
+    const double* upper,
+    OptimizationParams* params,
+    const RacingParams* race_params,
+    double* final_value,
+    RacingStats* stats
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RACING_H
@@ -0,0 +1,163 @@
+#include "screen.h"
+#include "expression_impl.h"
+#include "worker_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+namespace {
+
+// Примитивные многочлены и начальные направляющие числа Sobol для осей
+// 2..SCREEN_SOBOL_MAX_DIMENSION (Joe, Kuo, new-joe-kuo-6.21201)
+struct SobolAxis {
+    int degree;
+    unsigned a;
+    unsigned m[6];
+};
+
+const SobolAxis kSobolAxes[SCREEN_SOBOL_MAX_DIMENSION - 1] = {
+    {1, 0, {1}},
+    {2, 1, {1, 3}},
+    {3, 1, {1, 3, 1}},
+    {3, 2, {1, 1, 1}},
+    {4, 1, {1, 1, 3, 3}},
+    {4, 4, {1, 3, 5, 13}},
+    {5, 2, {1, 1, 5, 5, 17}},
+    {5, 4, {1, 1, 5, 5, 5}},
+    {5, 7, {1, 1, 7, 11, 19}},
+    {5, 11, {1, 1, 5, 1, 1}},
+    {5, 13, {1, 1, 1, 3, 11}},
+    {5, 14, {1, 3, 5, 5, 31}},
+    {6, 1, {1, 3, 3, 9, 7, 49}},
+    {6, 13, {1, 1, 1, 15, 21, 21}},
+    {6, 16, {1, 3, 1, 13, 27, 49}},
+};
+
+const int kSobolBits = 32;
+const int kChunk = 64;  // Точек плана на одну выборку задания потоком
+
+uint64_t splitmix(uint64_t& state) {
+    state += 0x9e3779b97f4a7c15ULL;
+    uint64_t z = state;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Направляющие числа оси axis (0 - ван дер Корпут)
+std::vector<uint32_t> sobol_directions(int axis) {
+    std::vector<uint32_t> v(kSobolBits);
+    if (axis == 0) {
+        for (int k = 0; k < kSobolBits; ++k) v[k] = 1u << (kSobolBits - 1 - k);
+        return v;
+    }
+    const SobolAxis& p = kSobolAxes[axis - 1];
+    int s = p.degree;
+    for (int k = 0; k < s; ++k) v[k] = p.m[k] << (kSobolBits - 1 - k);
+    for (int k = s; k < kSobolBits; ++k) {
+        v[k] = v[k - s] ^ (v[k - s] >> s);
+        for (int l = 1; l < s; ++l) {
+            if ((p.a >> (s - 1 - l)) & 1u) v[k] ^= v[k - l];
+        }
+    }
+    return v;
+}
+
+// Точки плана в единичном кубе, samples * n координат
+void sobol_design(int n, int samples, uint64_t seed, std::vector<double>& u) {
+    for (int axis = 0; axis < n; ++axis) {
+        std::vector<uint32_t> v = sobol_directions(axis);
+        uint64_t state = seed ^ (static_cast<uint64_t>(axis) + 1) * 0x9e3779b97f4a7c15ULL;
+        uint32_t x = static_cast<uint32_t>(splitmix(state) >> 32);  // Цифровой сдвиг
+        for (int i = 0; i < samples; ++i) {
+            u[static_cast<size_t>(i) * n + axis] = (x + 0.5) / 4294967296.0;
+            // Код Грея: следующая точка отличается направлением младшего нулевого бита i
+            int c = 0;
+            while ((i >> c) & 1) ++c;
+            x ^= v[std::min(c, kSobolBits - 1)];
+        }
+    }
+}
+
+void latin_hypercube_design(int n, int samples, uint64_t seed, std::vector<double>& u) {
+    std::vector<int> strata(samples);
+    for (int axis = 0; axis < n; ++axis) {
+        uint64_t state = seed ^ (static_cast<uint64_t>(axis) + 1) * 0x9e3779b97f4a7c15ULL;
+        std::iota(strata.begin(), strata.end(), 0);
+        for (int i = samples - 1; i > 0; --i) std::swap(strata[i], strata[splitmix(state) % (i + 1)]);
+        for (int i = 0; i < samples; ++i) {
+            double jitter = static_cast<double>(splitmix(state) >> 11) / 9007199254740992.0;
+            u[static_cast<size_t>(i) * n + axis] = (strata[i] + jitter) / samples;
+        }
+    }
+}
+
+} // namespace
+
+
+ScreenParams create_default_screen_params(void) {
+    ScreenParams params;
+    params.samples = 256;
+    params.design = SCREEN_SOBOL;
+    params.seed = 0;
+    return params;
+}
+
+int expr_screen(
+    const ExprProgram* program,
+    int n,
+    const double* lower,
+    const double* upper,
+    const ScreenParams* params,
+    int k,
+    double* points,
+    double* values
+) {
+    if (!program || !lower || !upper || !params || !points || !values || n <= 0 || k <= 0) return -1;
+    if (params->samples <= 0) return -1;
+    const expr::Program& p = *program->program;
+    if (p.dimension() != n) return -1;
+
+    int samples = params->samples;
+    std::vector<double> design(static_cast<size_t>(samples) * n);
+    if (params->design == SCREEN_SOBOL && n <= SCREEN_SOBOL_MAX_DIMENSION) {
+        sobol_design(n, samples, params->seed, design);
+    } else {
+        latin_hypercube_design(n, samples, params->seed, design);
+    }
+    for (int i = 0; i < samples; ++i) {
+        double* point = &design[static_cast<size_t>(i) * n];
+        for (int j = 0; j < n; ++j) point[j] = lower[j] + (upper[j] - lower[j]) * point[j];
+    }
+
+    std::vector<double> results(samples, HUGE_VAL);
+    std::atomic<int> next(0);
+    int chunks = (samples + kChunk - 1) / kChunk;
+    auto work = [&](int) {
+        expr::Evaluator evaluator(p);
+        for (int c = next++; c < chunks; c = next++) {
+            for (int i = c * kChunk; i < std::min(samples, (c + 1) * kChunk); ++i) {
+                double value = evaluator.evaluate(&design[static_cast<size_t>(i) * n]);
+                if (!std::isnan(value)) results[i] = value;
+            }
+        }
+    };
+
+    worker_pool_parallel(chunks, work);
+
+    std::vector<int> order(samples);
+    std::iota(order.begin(), order.end(), 0);
+    int best = std::min(k, samples);
+    std::partial_sort(order.begin(), order.begin() + best, order.end(),
+                      [&](int a, int b) { return results[a] < results[b]; });
+    int found = 0;
+    for (; found < best && std::isfinite(results[order[found]]); ++found) {
+        std::copy(&design[static_cast<size_t>(order[found]) * n], &design[static_cast<size_t>(order[found]) * n] + n,
+                  points + static_cast<size_t>(found) * n);
+        values[found] = results[order[found]];
+    }
+    return found;
+}
@@ -0,0 +1,106 @@
+package core
+
+/*
+#include "screen.h"
+#include "worker_pool.h"
+*/
+import "C"
+
+import (
+	"strconv"
+	"sync/atomic"
+)
+
+// defaultScreenStarts - запусков из лучших точек просмотра, если
+// Options.ScreenStarts не задан
+const defaultScreenStarts = 4
+
+// screener - настройки и счетчики предварительного просмотра бокса
+type screener struct {
+	samples  int
+	starts   int
+	runs     atomic.Int64
+	improved atomic.Int64
+}
+
+func newScreener(options Options) *screener {
+	starts := options.ScreenStarts
+	if starts <= 0 {
+		starts = defaultScreenStarts
+	}
+	return &screener{samples: options.ScreenSamples, starts: starts}
+}
+
+// screenKey - настройки просмотра для ключа запроса
+func (s *Service) screenKey() string {
+	if s.screen == nil || s.searchRadius <= 0 {
+		return "0"
+	}
+	return strconv.Itoa(s.screen.samples) + "/" + strconv.Itoa(s.screen.starts)
+}
+
+func (s *Service) ScreenStats() ScreenStats {
+	if s.screen == nil {
+		return ScreenStats{}
+	}
+	return ScreenStats{Runs: s.screen.runs.Load(), Improved: s.screen.improved.Load()}
+}
+
+// optimizeScreened просматривает бокс [1 - SearchRadius, 1 + SearchRadius]
+// по плану Sobol и запускает метод из единиц и из лучших точек плана одним
+// пакетом пула: методы пакета идут поочередно по итерации в одном потоке
+func (s *Service) optimizeScreened(program *NativeProgram, query OptimizationQuery) (OptimizationReplay, error) {
+	n := program.Dimension()
+	lower := make([]C.double, n)
+	upper := make([]C.double, n)
+	for i := range lower {
+		lower[i] = C.double(1 - s.searchRadius)
+		upper[i] = C.double(1 + s.searchRadius)
+	}
+	k := s.screen.starts
+	points := make([]C.double, k*n)
+	values := make([]C.double, k)
+	params := C.create_default_screen_params()
+	params.samples = C.int(s.screen.samples)
+	found := int(C.expr_screen(program.program, C.int(n), &lower[0], &upper[0], &params, C.int(k), &points[0], &values[0]))
+	if found < 0 {
+		return OptimizationReplay{}, ErrOptimizationFailed
+	}
+
+	// Дорожка 0 - обычный запуск из единиц, с ним сравнивается просмотр
+	jobs := make([]*nativeJob, found+1)
+	for i := range jobs {
+		jobs[i] = newNativeJob(program, makeParams(query), query.Priority)
+		defer jobs[i].Free()
+		for j := range jobs[i].x {
+			jobs[i].x[j] = 1.0
+			if i > 0 {
+				jobs[i].x[j] = points[(i-1)*n+j]
+			}
+		}
+		if s.polish {
+			jobs[i].job.polish = 1
+			jobs[i].job.polish_params = C.create_default_polish_params()
+		}
+	}
+	if err := s.pool.RunBatch(jobs); err != nil {
+		return OptimizationReplay{}, err
+	}
+
+	best := -1
+	for i, job := range jobs {
+		if job.job.status == 0 && (best < 0 || job.job.final_value < jobs[best].job.final_value) {
+			best = i
+		}
+	}
+	if best < 0 {
+		return OptimizationReplay{}, ErrOptimizationFailed
+	}
+	s.screen.runs.Add(1)
+	if best > 0 && (jobs[0].job.status != 0 || float64(jobs[0].job.final_value-jobs[best].job.final_value) > query.Tolerance) {
+		s.screen.improved.Add(1)
+	}
+	s.log.Debug("screened starts", "samples", s.screen.samples, "starts", found,
+		"single", float64(jobs[0].job.final_value), "best", float64(jobs[best].job.final_value))
+	return makeReplay(program.VarNames(), jobs[best].x, jobs[best].job.final_value), nil
+}
@@ -0,0 +1,49 @@
+#ifndef SCREEN_H
+#define SCREEN_H
+
+#include "expression.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// Предварительный просмотр бокса: функция вычисляется в точках
+// равномерного плана, лучшие точки становятся начальными для метода
+
+#define SCREEN_SOBOL_MAX_DIMENSION 16   // Направляющие числа Sobol (Joe, Kuo) есть для стольких переменных
+
+typedef enum {
+    SCREEN_SOBOL,             // Последовательность Sobol со случайным цифровым сдвигом
+    SCREEN_LATIN_HYPERCUBE    // Латинский гиперкуб: по точке в каждой полосе каждой оси
+} ScreenDesign;
+
+typedef struct {
+    int samples;              // Точек плана (обычно 256)
+    int design;               // ScreenDesign; Sobol выше SCREEN_SOBOL_MAX_DIMENSION заменяется гиперкубом
+    unsigned long long seed;  // Сдвиг Sobol или перестановки гиперкуба
+} ScreenParams;
+
+
+ScreenParams create_default_screen_params(void);
+
+// Вычисляет выражение в точках плана на боксе [lower, upper] параллельно
+// (по вычислителю на поток) и пишет k лучших точек по возрастанию значения:
+// points - k * n координат, values - k значений. Возвращает число записанных
+// точек (меньше k, если конечных значений меньше) или -1.
+int expr_screen(
+    const ExprProgram* program,
+    int n,
+    const double* lower,
+    const double* upper,
+    const ScreenParams* params,
+    int k,
+    double* points,
+    double* values
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SCREEN_H
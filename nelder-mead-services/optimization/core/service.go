@@ -1,9 +1,14 @@
 package core
 
-// #cgo CXXFLAGS: -std=c++11
-// #cgo LDFLAGS: -L. -lnelder_mead
+// #cgo CXXFLAGS: -std=c++11 -pthread
+// #cgo LDFLAGS: -L. -lnelder_mead -pthread
 /*
 #include "nelder_mead.h"
+#include "expression.h"
+#include "decomposition.h"
+#include "polish.h"
+#include "branch_bound.h"
+#include "worker_pool.h"
 #include <stdlib.h>
 
 // Функция-обертка для вызова Go-функции из C++
@@ -17,18 +22,143 @@ import (
 	"log/slog"
 	"math"
 	"regexp"
+	"runtime/cgo"
 	"strconv"
 	"strings"
+	"time"
 	"unsafe"
 )
 
 type Service struct {
-	log *slog.Logger
+	log              *slog.Logger
+	pool             *WorkerPool
+	natives          *nativeWorkers
+	batcher          *batcher
+	flights          *coalescer
+	jobs             *jobTable
+	results          ResultCache
+	polish           bool
+	searchRadius     float64
+	racingStarts     int
+	screen           *screener
+	progressInterval time.Duration
 }
 
-func NewService(log *slog.Logger) (*Service, error) {
-	return &Service{
-		log: log}, nil
+// Глобальный поиск ветвями и границами применяется к выражениям не больше
+// чем от branchBoundMaxDimension переменных: число боксов растет экспоненциально
+const branchBoundMaxDimension = 8
+
+type Options struct {
+	CacheEntries int   // Программ в кэше скомпилированных выражений, 0 - без кэша
+	CacheNodes   int64 // Суммарный размер программ в кэше (узлов DAG)
+	Polish       bool  // Доводка результата L-BFGS по градиенту выражения
+
+	// Полуширина бокса вокруг начальной точки для глобального поиска
+	// ветвями и границами, 0 - только локальный поиск
+	SearchRadius float64
+
+	// Запусков гонки multi-start на том же боксе (nelder_mead_optimize_racing)
+	// вместо ветвей и границ, 0 - ветви и границы
+	RacingStarts int
+
+	// Точек предварительного просмотра того же бокса по плану Sobol: метод
+	// запускается из единиц и из ScreenStarts лучших точек (0 - 4) одним
+	// пакетом. Применяется вместо гонки и ветвей и границ, 0 - без просмотра
+	ScreenSamples int
+	ScreenStarts  int
+
+	Workers    int  // Потоков пула оптимизации, 0 - по числу доступных ядер
+	PinThreads bool // Закрепить потоки пула за ядрами
+	QueueLimit int  // Предел очереди пула, сверх него запросы отклоняются
+
+	// Стоимость задачи - размерность * число узлов выражения * MaxIter.
+	// Задачи дороже MaxJobCost отклоняются (0 - без ограничения), интерактивные
+	// дороже DeferCost уходят в фоновую очередь (0 - никогда)
+	MaxJobCost float64
+	DeferCost  float64
+
+	// Квант, после которого долгий запуск уступает ядро ожидающим задачам
+	// и продолжается позже с того же симплекса, 0 - без вытеснения
+	TimeSlice time.Duration
+
+	// Окно сбора мелких задач в общий пакет, 0 - без пакетов
+	BatchWindow time.Duration
+	BatchSize   int // Наибольший размер пакета
+
+	// Хранилище готовых ответов, общее для процессов, nil - без него
+	Results ResultCache
+
+	// Наименьший интервал между сообщениями о ходе метода
+	ProgressInterval time.Duration
+
+	// Процессы-исполнители обычных интерактивных запусков с каналом в общей
+	// памяти: падение нативного кода не роняет сервис. Пакетные и фоновые
+	// запросы остаются в пуле. 0 - все задачи в пуле.
+	NativeWorkers int
+
+	// Журнал фоновых задач, nil - задачи не переживают перезапуск
+	Jobs                JobLog
+	JobRetention        time.Duration // Хранение завершенных задач, 0 - бессрочно
+	JobSnapshotInterval time.Duration // Интервал снимков задачи в журнал, 0 - без снимков
+}
+
+func NewService(log *slog.Logger, options Options) (*Service, error) {
+	configureExpressionCache(options.CacheEntries, options.CacheNodes)
+	pool, err := newWorkerPool(options)
+	if err != nil {
+		return nil, err
+	}
+	log.Debug("optimization worker pool", "workers", pool.Size())
+	service := &Service{
+		log:              log,
+		pool:             pool,
+		flights:          newCoalescer(),
+		results:          options.Results,
+		polish:           options.Polish,
+		searchRadius:     options.SearchRadius,
+		racingStarts:     options.RacingStarts,
+		progressInterval: options.ProgressInterval}
+	if options.NativeWorkers > 0 {
+		if service.natives, err = startNativeWorkers(log, options); err != nil {
+			pool.Close()
+			return nil, err
+		}
+		log.Debug("native worker processes", "workers", options.NativeWorkers)
+	}
+	if options.BatchWindow > 0 {
+		service.batcher = newBatcher(pool, options.BatchWindow, options.BatchSize)
+	}
+	if options.ScreenSamples > 0 {
+		service.screen = newScreener(options)
+	}
+	service.jobs = newJobTable(options, pool.Size())
+	if err := service.jobs.resume(service); err != nil {
+		service.Close()
+		return nil, fmt.Errorf("failed to resume jobs: %w", err)
+	}
+	go service.jobs.sweep()
+	return service, nil
+}
+
+func (s *Service) WorkerPoolStats() WorkerPoolStats {
+	return s.pool.Stats()
+}
+
+func (s *Service) CoalesceStats() CoalesceStats {
+	return s.flights.Stats()
+}
+
+// Close останавливает пул после выполнения принятых задач. Фоновые задачи
+// прерываются и продолжатся после запуска по журналу.
+func (s *Service) Close() {
+	s.jobs.close()
+	if s.batcher != nil {
+		s.batcher.flush()
+	}
+	if s.natives != nil {
+		s.natives.Close()
+	}
+	s.pool.Close()
 }
 
 type OptimizationFunction interface {
@@ -37,19 +167,71 @@ type OptimizationFunction interface {
 	VarNames() []string
 }
 
+type opcode uint8
+
+const (
+	opConst opcode = iota
+	opVar
+	opAdd
+	opSub
+	opMul
+	opDiv
+	opPow
+)
+
+// Инструкция постфиксной программы: константы разобраны заранее,
+// переменные заменены номерами позиций во входном векторе
+type instruction struct {
+	op    opcode
+	slot  int
+	value float64
+}
+
+// Глубина стека, до которой вычисление обходится без выделения памяти
+const inlineStackSize = 32
+
+// ParsedFunction неизменяема после parseFunction и может вычисляться
+// из нескольких горутин одновременно
 type ParsedFunction struct {
 	expression string
 	variables  []string
-	tokens     []string
+	program    []instruction
+	stackDepth int
 	dimension  int
 }
 
 func (f *ParsedFunction) Evaluate(vars []float64) float64 {
-	values := make(map[string]float64)
-	for i, name := range f.variables {
-		values[name] = vars[i]
+	var inline [inlineStackSize]float64
+	stack := inline[:0]
+	if f.stackDepth > inlineStackSize {
+		stack = make([]float64, 0, f.stackDepth)
+	}
+
+	for _, in := range f.program {
+		switch in.op {
+		case opConst:
+			stack = append(stack, in.value)
+		case opVar:
+			stack = append(stack, vars[in.slot])
+		default:
+			top := len(stack) - 1
+			a, b := stack[top-1], stack[top]
+			stack = stack[:top]
+			switch in.op {
+			case opAdd:
+				stack[top-1] = a + b
+			case opSub:
+				stack[top-1] = a - b
+			case opMul:
+				stack[top-1] = a * b
+			case opDiv:
+				stack[top-1] = a / b
+			case opPow:
+				stack[top-1] = math.Pow(a, b)
+			}
+		}
 	}
-	return evaluateExpression(f.tokens, values)
+	return stack[0]
 }
 
 func (f *ParsedFunction) Dimension() int {
@@ -60,104 +242,105 @@ func (f *ParsedFunction) VarNames() []string {
 	return f.variables
 }
 
-var currentFunction OptimizationFunction
-
+// goObjectiveFunction вызывается из C++; context указывает на cgo.Handle
+// функции конкретного запроса, так что параллельные оптимизации не делят состояние.
+// Вектор x читается на месте, без копирования
+//
 //export goObjectiveFunction
 func goObjectiveFunction(x *C.double, n C.int, context unsafe.Pointer) C.double {
-	slice := unsafe.Slice(x, int(n))
+	f := (*(*cgo.Handle)(context)).Value().(OptimizationFunction)
+	vars := unsafe.Slice((*float64)(unsafe.Pointer(x)), int(n))
+	return C.double(f.Evaluate(vars))
+}
+
+var (
+	varRegex      = regexp.MustCompile(`x\d+`)
+	operatorRegex = regexp.MustCompile(`([\+\-\*\/\(\)\^])`)
 
-	vars := make([]float64, len(slice))
-	for i, v := range slice {
-		vars[i] = float64(v)
+	precedence = map[string]int{
+		"+": 1,
+		"-": 1,
+		"*": 2,
+		"/": 2,
+		"^": 3,
 	}
 
-	result := currentFunction.Evaluate(vars)
-	return C.double(result)
-}
+	operators = map[string]opcode{
+		"+": opAdd,
+		"-": opSub,
+		"*": opMul,
+		"/": opDiv,
+		"^": opPow,
+	}
+)
 
 func parseFunction(expr string) (*ParsedFunction, error) {
 	expr = strings.ToLower(strings.ReplaceAll(expr, " ", ""))
 
-	varRegex := regexp.MustCompile(`x\d+`)
 	vars := varRegex.FindAllString(expr, -1)
 
-	uniqueVars := make(map[string]bool)
+	slots := make(map[string]int)
 	var variables []string
 	for _, v := range vars {
-		if !uniqueVars[v] {
-			uniqueVars[v] = true
+		if _, ok := slots[v]; !ok {
+			slots[v] = len(variables)
 			variables = append(variables, v)
 		}
 	}
 
-	tokens := tokenizeExpression(expr)
+	program, depth, err := compilePostfix(infixToPostfix(tokenizeExpression(expr)), slots)
+	if err != nil {
+		return nil, err
+	}
 
 	return &ParsedFunction{
 		expression: expr,
 		variables:  variables,
-		tokens:     tokens,
+		program:    program,
+		stackDepth: depth,
 		dimension:  len(variables),
 	}, nil
 }
 
 func tokenizeExpression(expr string) []string {
-	expr = regexp.MustCompile(`([\+\-\*\/\(\)\^])`).ReplaceAllString(expr, " $1 ")
+	expr = operatorRegex.ReplaceAllString(expr, " $1 ")
 	return strings.Fields(expr)
 }
 
-func evaluateExpression(tokens []string, values map[string]float64) float64 {
-	postfix := infixToPostfix(tokens)
-
-	var stack []float64
+// compilePostfix переводит постфиксную запись в инструкции и заранее
+// проверяет баланс стека, чтобы Evaluate не мог выйти за его границы
+func compilePostfix(postfix []string, slots map[string]int) ([]instruction, int, error) {
+	program := make([]instruction, 0, len(postfix))
+	depth, maxDepth := 0, 0
 
 	for _, token := range postfix {
-		switch token {
-		case "+", "-", "*", "/", "^":
-			b := stack[len(stack)-1]
-			stack = stack[:len(stack)-1]
-			a := stack[len(stack)-1]
-			stack = stack[:len(stack)-1]
-
-			var result float64
-			switch token {
-			case "+":
-				result = a + b
-			case "-":
-				result = a - b
-			case "*":
-				result = a * b
-			case "/":
-				result = a / b
-			case "^":
-				result = math.Pow(a, b)
-			}
-			stack = append(stack, result)
-		default:
-			if val, ok := values[token]; ok {
-				stack = append(stack, val)
-			} else {
-				if num, err := strconv.ParseFloat(token, 64); err == nil {
-					stack = append(stack, num)
-				}
+		if op, ok := operators[token]; ok {
+			if depth < 2 {
+				return nil, 0, fmt.Errorf("operator %q is missing an operand", token)
 			}
+			depth--
+			program = append(program, instruction{op: op})
+			continue
+		}
+
+		if slot, ok := slots[token]; ok {
+			program = append(program, instruction{op: opVar, slot: slot})
+		} else if num, err := strconv.ParseFloat(token, 64); err == nil {
+			program = append(program, instruction{op: opConst, value: num})
+		} else {
+			return nil, 0, fmt.Errorf("unexpected token %q", token)
 		}
+		depth++
+		maxDepth = max(maxDepth, depth)
 	}
 
-	if len(stack) > 0 {
-		return stack[len(stack)-1]
+	if depth != 1 {
+		return nil, 0, fmt.Errorf("invalid expression")
 	}
-	return 0
+	return program, maxDepth, nil
 }
 
 func infixToPostfix(tokens []string) []string {
-	precedence := map[string]int{
-		"+": 1,
-		"-": 1,
-		"*": 2,
-		"/": 2,
-		"^": 3,
-	}
-
 	var output []string
 	var stack []string
 
@@ -193,29 +376,69 @@ func infixToPostfix(tokens []string) []string {
 	return output
 }
 
-func toFloat64Slice(x []C.double) []float64 {
-	result := make([]float64, len(x))
-	for i, v := range x {
-		result[i] = float64(v)
+func (s *Service) Optimization(ctx context.Context, query OptimizationQuery) (OptimizationReplay, error) {
+	program, err := compileNative(query.Function)
+	if err == nil {
+		defer program.Free()
+		return s.optimizeOnce(ctx, s.queryKey(program.Canonical(), query), func() (OptimizationReplay, error) {
+			return s.optimizeNative(program, query, nil)
+		})
 	}
-	return result
-}
+	s.log.Debug("native compilation failed, using Go evaluator", "error", err)
 
-func (s *Service) Optimization(ctx context.Context, query OptimizationQuery) (OptimizationReplay, error) {
 	f, err := parseFunction(query.Function)
 	if err != nil {
 		fmt.Printf("Error parsing function: %v\n", err)
 		return OptimizationReplay{}, err
 	}
 
-	currentFunction = f
+	return s.optimizeOnce(ctx, s.queryKey("go:"+f.expression, query), func() (OptimizationReplay, error) {
+		return optimizeGo(f, query)
+	})
+}
 
-	params := C.create_default_params()
+// optimizeOnce отвечает из хранилища готовых ответов, если запрос уже
+// решался, иначе объединяет одинаковые одновременные запросы в один запуск
+func (s *Service) optimizeOnce(ctx context.Context, key string, optimize func() (OptimizationReplay, error)) (OptimizationReplay, error) {
+	if s.results != nil {
+		if replay, ok := s.results.Get(key); ok {
+			return replay, nil
+		}
+	}
+	return s.flights.Do(ctx, key, func() (OptimizationReplay, error) {
+		replay, err := optimize()
+		if err == nil && s.results != nil {
+			if err := s.results.Put(key, replay); err != nil {
+				s.log.Debug("result cache store failed", "error", err)
+			}
+		}
+		return replay, err
+	})
+}
 
-	params.tolerance = C.double(query.Tolerance)
-	params.max_iter = C.int(query.MaxIter)
+// queryKey - ключ одинаковых запросов: выражение в нормальной форме,
+// точность, число итераций, начальная точка (все координаты 1) и настройки
+// сервиса, влияющие на результат
+func (s *Service) queryKey(expression string, query OptimizationQuery) string {
+	return expression + "|tol=" + strconv.FormatFloat(query.Tolerance, 'g', -1, 64) +
+		"|iter=" + strconv.FormatInt(query.MaxIter, 10) + "|x0=1" +
+		"|polish=" + strconv.FormatBool(s.polish) +
+		"|radius=" + strconv.FormatFloat(s.searchRadius, 'g', -1, 64) +
+		"|racing=" + strconv.Itoa(s.racingStarts) +
+		"|screen=" + s.screenKey()
+}
+
+func optimizeGo(f OptimizationFunction, query OptimizationQuery) (OptimizationReplay, error) {
+	handle := cgo.NewHandle(f)
+	defer handle.Delete()
 
 	n := f.Dimension()
+	if n == 0 {
+		return OptimizationReplay{}, ErrOptimizationFailed
+	}
+
+	params := makeParams(query)
+
 	x := make([]C.double, n)
 	for i := range x {
 		x[i] = 1.0
@@ -228,17 +451,113 @@ func (s *Service) Optimization(ctx context.Context, query OptimizationQuery) (Op
 		(*C.double)(&x[0]),
 		C.int(n),
 		&params,
-		nil,
+		unsafe.Pointer(&handle),
 		&finalValue,
 	)
 	if result != 0 {
 		return OptimizationReplay{}, ErrOptimizationFailed
 	}
 
-	variables := make([]Variable, 0, f.Dimension())
+	return makeReplay(f.VarNames(), x, finalValue), nil
+}
+
+func (s *Service) optimizeNative(program *NativeProgram, query OptimizationQuery, sink *progressSink) (OptimizationReplay, error) {
+	n := program.Dimension()
+	if n == 0 {
+		return OptimizationReplay{}, ErrOptimizationFailed
+	}
+
+	// Просмотр бокса заменяет глобальный поиск; подписчик видит один запуск
+	if sink == nil && s.screen != nil && s.searchRadius > 0 {
+		return s.optimizeScreened(program, query)
+	}
+
+	job := newNativeJob(program, makeParams(query), query.Priority)
+	defer job.Free()
+	for i := range job.x {
+		job.x[i] = 1.0
+	}
+
+	batched := false
+	switch {
+	case sink != nil:
+		// Подписчик видит ход одного запуска метода
+		job.observe(sink)
+	case s.searchRadius > 0 && s.racingStarts > 0:
+		job.job.mode = C.JOB_RACING
+		job.job.race_params = C.create_default_racing_params()
+		job.job.race_params.starts = C.int(s.racingStarts)
+		job.job.race_params.max_starts = C.int(4 * s.racingStarts)
+		job.setBox(s.searchRadius)
+	case s.searchRadius > 0 && n <= branchBoundMaxDimension:
+		job.job.mode = C.JOB_BRANCH_BOUND
+		job.job.bb_params = C.create_default_branch_bound_params()
+		job.setBox(s.searchRadius)
+		s.log.Debug("branch-and-bound global search", "dimension", n, "radius", s.searchRadius)
+	case s.batcher != nil && n <= batchMaxDimension && query.Priority == PriorityInteractive:
+		// Разбиение задачи такой размерности не дает выигрыша, а пакет экономит на очереди
+		batched = true
+	case program.Components() > 1:
+		job.job.mode = C.JOB_SEPARABLE
+		s.log.Debug("separable objective", "components", program.Components())
+	case program.Sparse():
+		blockParams := C.create_default_block_params()
+		blockParams.max_sweeps = C.int(max(1, query.MaxIter/int64(blockParams.sweep_iter)))
+		job.job.mode = C.JOB_BLOCKS
+		job.job.block_params = blockParams
+		s.log.Debug("sparse objective, block-coordinate mode", "dimension", n)
+	}
+	if s.polish {
+		job.job.polish = 1
+		job.job.polish_params = C.create_default_polish_params()
+	}
+
+	// Обычный интерактивный запуск уходит процессу-исполнителю, если он
+	// доступен. Кольцо исполнителей не знает приоритетов, поэтому фоновые
+	// запросы остаются в очереди пула, а пакетные - в пакетировщике.
+	if s.natives != nil && sink == nil && job.job.mode == C.JOB_INCREMENTAL && !batched &&
+		query.Priority == PriorityInteractive {
+		replay, err := s.natives.Run(program, query, s.polish)
+		if err != errNativeUnavailable {
+			return replay, err
+		}
+	}
+
+	run := s.pool.Run
+	if batched {
+		run = s.batcher.Run
+	}
+	if err := run(job); err != nil {
+		return OptimizationReplay{}, err
+	}
+	if job.job.status != 0 {
+		return OptimizationReplay{}, ErrOptimizationFailed
+	}
+	if job.job.mode == C.JOB_RACING {
+		stats := job.job.race_stats
+		s.log.Debug("racing multi-start", "started", int(stats.started), "pruned", int(stats.pruned),
+			"rounds", int(stats.rounds), "evaluations", int64(stats.evaluations))
+	}
+	if s.polish {
+		s.log.Debug("gradient polish", "before", float64(job.job.unpolished_value), "after", float64(job.job.final_value))
+	}
+
+	return makeReplay(program.VarNames(), job.x, job.job.final_value), nil
+}
+
+func makeParams(query OptimizationQuery) C.OptimizationParams {
+	params := C.create_default_params()
+
+	params.tolerance = C.double(query.Tolerance)
+	params.max_iter = C.int(query.MaxIter)
+	return params
+}
+
+func makeReplay(names []string, x []C.double, finalValue C.double) OptimizationReplay {
+	variables := make([]Variable, 0, len(x))
 	for i, val := range x {
 		variables = append(variables, Variable{
-			Name:  f.VarNames()[i],
+			Name:  names[i],
 			Value: int64(val),
 		})
 	}
@@ -246,5 +565,5 @@ func (s *Service) Optimization(ctx context.Context, query OptimizationQuery) (Op
 	return OptimizationReplay{
 		Variable:      variables,
 		FunctionValue: float64(finalValue),
-	}, nil
+	}
 }
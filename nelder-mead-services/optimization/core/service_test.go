@@ -0,0 +1,936 @@
+package core
+
+import (
+	"context"
+	"errors"
+	"fmt"
+	"io"
+	"log/slog"
+	"math"
+	"os"
+	"sort"
+	"strings"
+	"sync"
+	"sync/atomic"
+	"testing"
+	"time"
+)
+
+// Процессы-исполнители (Options.NativeWorkers) запускают тот же файл,
+// здесь - тестовый
+func TestMain(m *testing.M) {
+	if RunNativeWorker() {
+		return
+	}
+	os.Exit(m.Run())
+}
+
+// Каждый вызов несет свою функцию через cgo.Handle: одновременные
+// оптимизации разных выражений не должны видеть чужую функцию
+func TestGoBridgeConcurrent(t *testing.T) {
+	const workers = 16
+	var wg sync.WaitGroup
+	errs := make(chan error, workers)
+	for w := 0; w < workers; w++ {
+		wg.Add(1)
+		go func(shift int) {
+			defer wg.Done()
+			f, err := parseFunction(fmt.Sprintf("(x1-%d)^2+(x2+%d)^2", shift, shift))
+			if err != nil {
+				errs <- err
+				return
+			}
+			for i := 0; i < 20; i++ {
+				replay, err := optimizeGo(f, OptimizationQuery{Tolerance: 1e-10, MaxIter: 2000})
+				if err != nil {
+					errs <- err
+					return
+				}
+				if replay.FunctionValue > 1e-6 {
+					errs <- fmt.Errorf("shift %d: value %g", shift, replay.FunctionValue)
+					return
+				}
+			}
+		}(w)
+	}
+	wg.Wait()
+	close(errs)
+	for err := range errs {
+		t.Error(err)
+	}
+}
+
+// Запуск: go test -bench GoBridgeParallel -cpu 1,2,4,8
+// При линейном масштабировании ns/op падает пропорционально числу ядер
+func BenchmarkGoBridgeParallel(b *testing.B) {
+	f, err := parseFunction("100*(x2-x1^2)^2+(1-x1)^2")
+	if err != nil {
+		b.Fatal(err)
+	}
+	query := OptimizationQuery{Tolerance: 1e-8, MaxIter: 500}
+	b.RunParallel(func(pb *testing.PB) {
+		for pb.Next() {
+			replay, err := optimizeGo(f, query)
+			if err != nil || math.IsNaN(replay.FunctionValue) {
+				b.Error("optimization failed")
+				return
+			}
+		}
+	})
+}
+
+func TestParsedFunctionEvaluate(t *testing.T) {
+	f, err := parseFunction("100*(x2-x1^2)^2+(1-x1)^2 + x3/4")
+	if err != nil {
+		t.Fatal(err)
+	}
+	if got := f.VarNames(); len(got) != 3 || got[0] != "x2" || got[1] != "x1" || got[2] != "x3" {
+		t.Fatalf("variables %v", got)
+	}
+	// Порядок значений соответствует VarNames: x2, x1, x3
+	if got, want := f.Evaluate([]float64{3, 2, 8}), 100.0+1.0+2.0; got != want {
+		t.Errorf("Evaluate = %g, want %g", got, want)
+	}
+
+	for _, bad := range []string{"x1+", "x1 x2", "(x1+y)", "*x1"} {
+		if _, err := parseFunction(bad); err == nil {
+			t.Errorf("parseFunction(%q) succeeded", bad)
+		}
+	}
+}
+
+func TestParsedFunctionEvaluateAllocs(t *testing.T) {
+	f, err := parseFunction("100*(x2-x1^2)^2+(1-x1)^2")
+	if err != nil {
+		t.Fatal(err)
+	}
+	vars := []float64{1.5, -0.5}
+	if allocs := testing.AllocsPerRun(1000, func() { f.Evaluate(vars) }); allocs != 0 {
+		t.Errorf("Evaluate allocates %g times per call", allocs)
+	}
+}
+
+// Запуск: go test -bench ParsedFunctionEvaluate -benchmem, ожидается 0 allocs/op
+func BenchmarkParsedFunctionEvaluate(b *testing.B) {
+	f, err := parseFunction("100*(x2-x1^2)^2+(1-x1)^2")
+	if err != nil {
+		b.Fatal(err)
+	}
+	vars := []float64{1.5, -0.5}
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		f.Evaluate(vars)
+	}
+}
+
+// Запросы сверх числа потоков пула ждут в очереди и получают свой результат
+func TestServiceWorkerPool(t *testing.T) {
+	service, err := NewService(slog.New(slog.NewTextHandler(io.Discard, nil)),
+		Options{CacheEntries: 16, CacheNodes: 1 << 16, Workers: 2, QueueLimit: 64, TimeSlice: time.Millisecond})
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer service.Close()
+
+	const requests = 32
+	var wg sync.WaitGroup
+	errs := make(chan error, requests)
+	for r := 0; r < requests; r++ {
+		wg.Add(1)
+		go func(shift int) {
+			defer wg.Done()
+			query := OptimizationQuery{
+				// Слагаемое-константа делает запросы различными, иначе они объединяются
+				Function:  fmt.Sprintf("(x1-%d)^2+(x2+%d)^2+x1*x2/100+%d", shift%4, shift%4, shift),
+				Tolerance: 1e-10,
+				MaxIter:   2000,
+			}
+			replay, err := service.Optimization(context.Background(), query)
+			if errors.Is(err, ErrOverloaded) {
+				return
+			}
+			if err != nil {
+				errs <- err
+				return
+			}
+			if replay.Variable[0].Value != int64(shift%4) {
+				errs <- fmt.Errorf("shift %d: %+v", shift, replay)
+			}
+		}(r)
+	}
+	wg.Wait()
+	close(errs)
+	for err := range errs {
+		t.Error(err)
+	}
+
+	stats := service.WorkerPoolStats()
+	if stats.Completed != stats.Admitted || stats.Admitted+stats.RejectedFull != requests {
+		t.Errorf("pool stats %+v", stats)
+	}
+}
+
+func TestServiceAdmissionControl(t *testing.T) {
+	service, err := NewService(slog.New(slog.NewTextHandler(io.Discard, nil)),
+		Options{Workers: 1, MaxJobCost: 1e6})
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer service.Close()
+
+	query := OptimizationQuery{Function: "(x1-1)^2+(x2-2)^2", Tolerance: 1e-8, MaxIter: 100}
+	if _, err := service.Optimization(context.Background(), query); err != nil {
+		t.Fatal(err)
+	}
+	query.MaxIter = 1e9
+	if _, err := service.Optimization(context.Background(), query); !errors.Is(err, ErrJobTooCostly) {
+		t.Errorf("expected ErrJobTooCostly, got %v", err)
+	}
+	if stats := service.WorkerPoolStats(); stats.RejectedCost != 1 || stats.Completed != 1 {
+		t.Errorf("pool stats %+v", stats)
+	}
+}
+
+func TestServiceBatching(t *testing.T) {
+	service, err := NewService(slog.New(slog.NewTextHandler(io.Discard, nil)),
+		Options{CacheEntries: 16, CacheNodes: 1 << 16, Workers: 1, BatchWindow: 5 * time.Millisecond, BatchSize: 8})
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer service.Close()
+
+	const requests = 16
+	var wg sync.WaitGroup
+	errs := make(chan error, requests)
+	for r := 0; r < requests; r++ {
+		wg.Add(1)
+		go func(shift int) {
+			defer wg.Done()
+			query := OptimizationQuery{Function: fmt.Sprintf("(x1-%d)^2+(x2+1)^2", shift), Tolerance: 1e-10, MaxIter: 2000}
+			replay, err := service.Optimization(context.Background(), query)
+			if err != nil {
+				errs <- err
+				return
+			}
+			// Значения переменных в ответе усекаются до целых
+			if math.Abs(float64(replay.Variable[0].Value-int64(shift))) > 1 || replay.FunctionValue > 1e-6 {
+				errs <- fmt.Errorf("shift %d: %+v", shift, replay)
+			}
+		}(r)
+	}
+	wg.Wait()
+	close(errs)
+	for err := range errs {
+		t.Error(err)
+	}
+
+	if stats := service.WorkerPoolStats(); stats.Batches == 0 || stats.Completed != requests {
+		t.Errorf("pool stats %+v", stats)
+	}
+}
+
+// Одинаковые одновременные запросы, в том числе записанные по-разному,
+// выполняются один раз и получают один и тот же ответ
+func TestServiceCoalescing(t *testing.T) {
+	service, err := NewService(slog.New(slog.NewTextHandler(io.Discard, nil)),
+		Options{CacheEntries: 16, CacheNodes: 1 << 16, Workers: 1})
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer service.Close()
+
+	var terms []string
+	for i := 1; i < 12; i++ {
+		terms = append(terms, fmt.Sprintf("100*(x%d-x%d^2)^2+(1-x%d)^2", i+1, i, i))
+	}
+	function := strings.Join(terms, "+")
+	spelled := strings.Join(terms, " + ")
+
+	const requests = 16
+	replays := make([]OptimizationReplay, requests)
+	var wg sync.WaitGroup
+	errs := make(chan error, requests)
+	for r := 0; r < requests; r++ {
+		wg.Add(1)
+		go func(r int) {
+			defer wg.Done()
+			query := OptimizationQuery{Function: function, Tolerance: 0, MaxIter: 20000}
+			if r%2 == 1 {
+				query.Function = spelled
+			}
+			replay, err := service.Optimization(context.Background(), query)
+			if err != nil {
+				errs <- err
+				return
+			}
+			replays[r] = replay
+		}(r)
+	}
+	wg.Wait()
+	close(errs)
+	for err := range errs {
+		t.Fatal(err)
+	}
+
+	for r := 1; r < requests; r++ {
+		if replays[r].FunctionValue != replays[0].FunctionValue || len(replays[r].Variable) != len(replays[0].Variable) {
+			t.Errorf("request %d: %+v, want %+v", r, replays[r], replays[0])
+		}
+	}
+	stats := service.CoalesceStats()
+	if stats.Coalesced == 0 || stats.Leaders+stats.Coalesced != requests || stats.InFlight != 0 {
+		t.Errorf("coalesce stats %+v", stats)
+	}
+	if pool := service.WorkerPoolStats(); pool.Completed != stats.Leaders {
+		t.Errorf("pool completed %d jobs for %d leaders", pool.Completed, stats.Leaders)
+	}
+}
+
+// Ход долгого запуска приходит по мере работы, отмена запроса его прерывает
+func TestServiceProgress(t *testing.T) {
+	service, err := NewService(slog.New(slog.NewTextHandler(io.Discard, nil)),
+		Options{CacheEntries: 16, CacheNodes: 1 << 16, Workers: 1, ProgressInterval: time.Millisecond})
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer service.Close()
+
+	short := OptimizationQuery{Function: "(x1-3)^2+(x2+2)^2+x1*x2/10", Tolerance: 1e-10, MaxIter: 2000}
+	var reports []OptimizationProgress
+	observed, err := service.OptimizationProgress(context.Background(), short, func(progress OptimizationProgress) {
+		reports = append(reports, progress)
+	})
+	if err != nil {
+		t.Fatal(err)
+	}
+	plain, err := service.Optimization(context.Background(), short)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if observed.FunctionValue != plain.FunctionValue || len(reports) == 0 {
+		t.Errorf("observed %+v, plain %+v, %d reports", observed, plain, len(reports))
+	}
+	for i := 1; i < len(reports); i++ {
+		if reports[i].Iteration <= reports[i-1].Iteration || reports[i].BestValue > reports[i-1].BestValue {
+			t.Errorf("report %d: %+v after %+v", i, reports[i], reports[i-1])
+		}
+	}
+
+	var terms []string
+	for i := 1; i < 12; i++ {
+		terms = append(terms, fmt.Sprintf("100*(x%d-x%d^2)^2+(1-x%d)^2", i+1, i, i))
+	}
+	long := OptimizationQuery{Function: strings.Join(terms, "+"), Tolerance: 0, MaxIter: 1 << 30}
+	ctx, cancel := context.WithCancel(context.Background())
+	defer cancel()
+	count := 0
+	start := time.Now()
+	_, err = service.OptimizationProgress(ctx, long, func(progress OptimizationProgress) {
+		if count++; count == 3 {
+			cancel()
+		}
+	})
+	if !errors.Is(err, context.Canceled) || count < 3 || time.Since(start) > 10*time.Second {
+		t.Errorf("cancelled run: %v after %d reports, %v", err, count, time.Since(start))
+	}
+}
+
+func TestServiceOptimizationBatch(t *testing.T) {
+	service, err := NewService(slog.New(slog.NewTextHandler(io.Discard, nil)),
+		Options{CacheEntries: 16, CacheNodes: 1 << 16, Workers: 2})
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer service.Close()
+
+	const problems = 40
+	queries := make([]OptimizationQuery, problems)
+	for i := range queries {
+		queries[i] = OptimizationQuery{Function: fmt.Sprintf("(x1-%d)^2+(x2+1)^2", i), Tolerance: 1e-10, MaxIter: 2000}
+	}
+	queries[7].Function = "x1+"
+
+	seen := make([]bool, problems)
+	service.OptimizationBatch(context.Background(), queries, func(index int, replay OptimizationReplay, err error) {
+		if seen[index] {
+			t.Errorf("problem %d reported twice", index)
+		}
+		seen[index] = true
+		switch {
+		case index == 7:
+			if err == nil {
+				t.Errorf("invalid problem succeeded: %+v", replay)
+			}
+		case err != nil:
+			t.Errorf("problem %d: %v", index, err)
+		case math.Abs(float64(replay.Variable[0].Value-int64(index))) > 1:
+			t.Errorf("problem %d: %+v", index, replay)
+		}
+	})
+	for i, ok := range seen {
+		if !ok {
+			t.Errorf("problem %d not reported", i)
+		}
+	}
+}
+
+type mapResultCache struct {
+	mu      sync.Mutex
+	replays map[string]OptimizationReplay
+}
+
+func (c *mapResultCache) Get(key string) (OptimizationReplay, bool) {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	replay, ok := c.replays[key]
+	return replay, ok
+}
+
+func (c *mapResultCache) Put(key string, replay OptimizationReplay) error {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	c.replays[key] = replay
+	return nil
+}
+
+// Повторный запрос, в том числе записанный иначе, отвечается из хранилища
+func TestServiceResultCache(t *testing.T) {
+	results := &mapResultCache{replays: make(map[string]OptimizationReplay)}
+	service, err := NewService(slog.New(slog.NewTextHandler(io.Discard, nil)),
+		Options{CacheEntries: 16, CacheNodes: 1 << 16, Workers: 1, Results: results})
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer service.Close()
+
+	query := OptimizationQuery{Function: "(x1-3)^2+(x2+2)^2", Tolerance: 1e-10, MaxIter: 2000}
+	first, err := service.Optimization(context.Background(), query)
+	if err != nil {
+		t.Fatal(err)
+	}
+	query.Function = "(x2+2)^2 + (x1-3)^2"
+	second, err := service.Optimization(context.Background(), query)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if second.FunctionValue != first.FunctionValue || len(results.replays) != 1 {
+		t.Errorf("first %+v, second %+v, stored %d", first, second, len(results.replays))
+	}
+	if stats := service.WorkerPoolStats(); stats.Completed != 1 {
+		t.Errorf("pool stats %+v", stats)
+	}
+
+	// Запуск с сообщениями о ходе не отвечается результатом Optimization и не подменяет его
+	if _, err := service.OptimizationProgress(context.Background(), query, func(OptimizationProgress) {}); err != nil {
+		t.Fatal(err)
+	}
+	if stats := service.WorkerPoolStats(); stats.Completed != 2 || len(results.replays) != 2 {
+		t.Errorf("pool stats %+v, stored %d", stats, len(results.replays))
+	}
+
+	// Фоновая задача тоже хранит результат отдельно
+	submitted, err := service.SubmitJob(query)
+	if err != nil {
+		t.Fatal(err)
+	}
+	status := waitJob(t, service, submitted.ID, func(status JobStatus) bool { return status.State == JobDone })
+	jobs := 0
+	for key := range results.replays {
+		if strings.HasSuffix(key, "|job") {
+			jobs++
+		}
+	}
+	if status.Replay.FunctionValue != second.FunctionValue || jobs != 1 {
+		t.Errorf("job %+v, stored %d under a job key", status, jobs)
+	}
+	if stats := service.WorkerPoolStats(); stats.Completed != 3 || len(results.replays) != 3 {
+		t.Errorf("pool stats %+v, stored %d", stats, len(results.replays))
+	}
+}
+
+// Поток мелких задач от многих клиентов сразу.
+// Запуск: go test -bench SmallProblemBurst -cpu 1,4
+func BenchmarkSmallProblemBurst(b *testing.B) {
+	for _, bench := range []struct {
+		name   string
+		window time.Duration
+	}{
+		{"direct", 0},
+		{"batched", 200 * time.Microsecond},
+	} {
+		b.Run(bench.name, func(b *testing.B) {
+			service, err := NewService(slog.New(slog.NewTextHandler(io.Discard, nil)),
+				Options{CacheEntries: 16, CacheNodes: 1 << 16, BatchWindow: bench.window, BatchSize: 32})
+			if err != nil {
+				b.Fatal(err)
+			}
+			defer service.Close()
+
+			// Разные сдвиги, чтобы одинаковые запросы не объединялись
+			var shift atomic.Int64
+			b.SetParallelism(32)
+			b.RunParallel(func(pb *testing.PB) {
+				for pb.Next() {
+					query := OptimizationQuery{
+						Function:  fmt.Sprintf("(x1-%d)^2+(x2+2)^2+x1*x2/10", shift.Add(1)%1000),
+						Tolerance: 1e-8,
+						MaxIter:   500,
+					}
+					if _, err := service.Optimization(context.Background(), query); err != nil {
+						b.Error(err)
+						return
+					}
+				}
+			})
+		})
+	}
+}
+
+// memJobLog - журнал задач в памяти: новый сервис с тем же журналом
+// ведет себя как перезапущенный
+type memJobLog struct {
+	mu      sync.Mutex
+	records []JobRecord
+}
+
+func (l *memJobLog) Append(record JobRecord, sync bool) error {
+	l.mu.Lock()
+	defer l.mu.Unlock()
+	l.records = append(l.records, record)
+	return nil
+}
+
+func (l *memJobLog) Load() ([]JobRecord, error) {
+	l.mu.Lock()
+	defer l.mu.Unlock()
+	return append([]JobRecord(nil), l.records...), nil
+}
+
+func (l *memJobLog) Compact(records []JobRecord) error {
+	l.mu.Lock()
+	defer l.mu.Unlock()
+	l.records = append([]JobRecord(nil), records...)
+	return nil
+}
+
+func (l *memJobLog) count(id string, kind JobRecordKind) int {
+	l.mu.Lock()
+	defer l.mu.Unlock()
+	count := 0
+	for _, record := range l.records {
+		if record.ID == id && record.Kind == kind {
+			count++
+		}
+	}
+	return count
+}
+
+func waitJob(t *testing.T, service *Service, id string, done func(JobStatus) bool) JobStatus {
+	t.Helper()
+	deadline := time.Now().Add(30 * time.Second)
+	for {
+		status, err := service.Job(id)
+		if err != nil {
+			t.Fatal(err)
+		}
+		if done(status) {
+			return status
+		}
+		if time.Now().After(deadline) {
+			t.Fatalf("job %s stuck: %+v", id, status)
+		}
+		time.Sleep(time.Millisecond)
+	}
+}
+
+func TestServiceJobs(t *testing.T) {
+	log := &memJobLog{}
+	options := Options{CacheEntries: 16, CacheNodes: 1 << 16, Workers: 1, Jobs: log, JobSnapshotInterval: time.Millisecond}
+	service, err := NewService(slog.New(slog.NewTextHandler(io.Discard, nil)), options)
+	if err != nil {
+		t.Fatal(err)
+	}
+	finished := func(status JobStatus) bool {
+		return status.State != JobQueued && status.State != JobRunning
+	}
+
+	short := OptimizationQuery{Function: "(x1-3)^2+(x2+2)^2+x1*x2/10", Tolerance: 1e-10, MaxIter: 2000}
+	submitted, err := service.SubmitJob(short)
+	if err != nil {
+		t.Fatal(err)
+	}
+	status := waitJob(t, service, submitted.ID, finished)
+	plain, err := service.Optimization(context.Background(), short)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if status.State != JobDone || status.Replay.FunctionValue != plain.FunctionValue {
+		t.Errorf("short job %+v, plain %+v", status, plain)
+	}
+	if _, err := service.Job("missing"); !errors.Is(err, ErrJobNotFound) {
+		t.Errorf("missing job: %v", err)
+	}
+
+	endless := OptimizationQuery{Function: "(x1-3)^2+(x2+2)^2", Tolerance: 0, MaxIter: 1 << 30}
+	submitted, err = service.SubmitJob(endless)
+	if err != nil {
+		t.Fatal(err)
+	}
+	waitJob(t, service, submitted.ID, func(status JobStatus) bool { return status.Progress.Iteration > 0 })
+	if _, err := service.CancelJob(submitted.ID); err != nil {
+		t.Fatal(err)
+	}
+	if status := waitJob(t, service, submitted.ID, finished); status.State != JobCancelled {
+		t.Errorf("cancelled job %+v", status)
+	}
+
+	// Остановка сервиса посреди задачи: новый экземпляр продолжает ее
+	// со снимка и приходит в ту же точку, что и непрерывный запуск
+	var terms []string
+	for i := 1; i < 12; i++ {
+		terms = append(terms, fmt.Sprintf("100*(x%d-x%d^2)^2+(1-x%d)^2", i+1, i, i))
+	}
+	long := OptimizationQuery{Function: strings.Join(terms, "+"), Tolerance: 0, MaxIter: 60000}
+	submitted, err = service.SubmitJob(long)
+	if err != nil {
+		t.Fatal(err)
+	}
+	waitJob(t, service, submitted.ID, func(JobStatus) bool { return log.count(submitted.ID, JobSnapshot) > 0 })
+	service.Close()
+	if log.count(submitted.ID, JobFinished) != 0 {
+		t.Fatal("job finished before the restart")
+	}
+
+	service, err = NewService(slog.New(slog.NewTextHandler(io.Discard, nil)), options)
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer service.Close()
+	status = waitJob(t, service, submitted.ID, finished)
+	continuous, err := service.OptimizationProgress(context.Background(), long, func(OptimizationProgress) {})
+	if err != nil {
+		t.Fatal(err)
+	}
+	if status.State != JobDone || status.Replay.FunctionValue != continuous.FunctionValue {
+		t.Errorf("resumed job %+v, continuous %+v", status, continuous)
+	}
+	if status.Progress.Iteration <= 0 {
+		t.Errorf("resumed job reports no progress: %+v", status.Progress)
+	}
+}
+
+// Процессы-исполнители дают тот же ответ, что и пул потоков, выдерживают
+// больше одновременных запросов, чем ячеек в кольцах, и перезапускаются
+// после падения
+func TestServiceNativeWorkers(t *testing.T) {
+	log := slog.New(slog.NewTextHandler(io.Discard, nil))
+	options := Options{CacheEntries: 16, CacheNodes: 1 << 16, Workers: 1, Polish: true}
+	reference, err := NewService(log, options)
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer reference.Close()
+	options.NativeWorkers = 2
+	service, err := NewService(log, options)
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer service.Close()
+
+	const requests = 300
+	var wg sync.WaitGroup
+	errs := make(chan error, requests)
+	for r := 0; r < requests; r++ {
+		wg.Add(1)
+		go func(shift int) {
+			defer wg.Done()
+			query := OptimizationQuery{Function: fmt.Sprintf("(x2+%d)^2+(x1-%d)^2+x1*x2/100", shift%7, shift%5), Tolerance: 1e-10, MaxIter: 2000}
+			replay, err := service.Optimization(context.Background(), query)
+			if err != nil {
+				errs <- err
+				return
+			}
+			expected, err := reference.Optimization(context.Background(), query)
+			if err != nil {
+				errs <- err
+				return
+			}
+			if fmt.Sprint(replay) != fmt.Sprint(expected) {
+				errs <- fmt.Errorf("shift %d: native %+v, pool %+v", shift, replay, expected)
+			}
+		}(r)
+	}
+	wg.Wait()
+	close(errs)
+	for err := range errs {
+		t.Error(err)
+	}
+	if stats := service.WorkerPoolStats(); stats.Completed != 0 {
+		t.Errorf("requests reached the thread pool: %+v", stats)
+	}
+
+	service.natives.mu.Lock()
+	crashed := service.natives.workers[0]
+	service.natives.mu.Unlock()
+	if err := crashed.cmd.Process.Kill(); err != nil {
+		t.Fatal(err)
+	}
+	query := OptimizationQuery{Function: "(x1-1)^2+(x2-2)^2", Tolerance: 1e-8, MaxIter: 500}
+	for deadline := time.Now().Add(5 * time.Second); ; {
+		if _, err := service.Optimization(context.Background(), query); err != nil {
+			t.Fatal(err)
+		}
+		service.natives.mu.Lock()
+		restarted := service.natives.workers[0]
+		service.natives.mu.Unlock()
+		if restarted != nil && restarted != crashed {
+			break
+		}
+		if time.Now().After(deadline) {
+			t.Fatal("native worker was not restarted")
+		}
+		time.Sleep(time.Millisecond)
+	}
+}
+
+// Пакетные и фоновые запросы не уходят процессам-исполнителям
+func TestServiceNativeWorkersRouting(t *testing.T) {
+	service, err := NewService(slog.New(slog.NewTextHandler(io.Discard, nil)),
+		Options{CacheEntries: 16, CacheNodes: 1 << 16, Workers: 1, NativeWorkers: 1, BatchWindow: time.Millisecond})
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer service.Close()
+
+	small := OptimizationQuery{Function: "(x1-3)^2+(x2+2)^2+x1*x2/100", Tolerance: 1e-10, MaxIter: 2000}
+	if _, err := service.Optimization(context.Background(), small); err != nil {
+		t.Fatal(err)
+	}
+	if stats := service.WorkerPoolStats(); stats.Completed != 1 {
+		t.Errorf("batched query left the pool: %+v", stats)
+	}
+
+	// Вне пакетирования интерактивный запрос уходит исполнителю, фоновый - в пул
+	large := OptimizationQuery{Function: "(x1+x2+x3+x4+x5+x6-3)^2+(x1-1)^2+(x2-2)^2+(x3-3)^2+(x4-1)^2+(x5-2)^2+(x6-3)^2",
+		Tolerance: 1e-10, MaxIter: 4000}
+	if _, err := service.Optimization(context.Background(), large); err != nil {
+		t.Fatal(err)
+	}
+	if stats := service.WorkerPoolStats(); stats.Completed != 1 {
+		t.Errorf("interactive query stayed in the pool: %+v", stats)
+	}
+	large.Priority = PriorityBatch
+	large.Tolerance = 1e-9
+	if _, err := service.Optimization(context.Background(), large); err != nil {
+		t.Fatal(err)
+	}
+	if stats := service.WorkerPoolStats(); stats.Completed != 2 {
+		t.Errorf("background query left the pool: %+v", stats)
+	}
+}
+
+// Падение исполнителя завершает ошибкой только выполнявшийся запрос,
+// очередь за ним решается пулом
+func TestServiceNativeWorkerCrash(t *testing.T) {
+	service, err := NewService(slog.New(slog.NewTextHandler(io.Discard, nil)),
+		Options{CacheEntries: 16, CacheNodes: 1 << 16, Workers: 1, NativeWorkers: 1})
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer service.Close()
+	service.natives.mu.Lock()
+	worker := service.natives.workers[0]
+	service.natives.mu.Unlock()
+
+	const requests = 8
+	errs := make(chan error, requests)
+	for r := 0; r < requests; r++ {
+		go func(shift int) {
+			query := OptimizationQuery{Function: fmt.Sprintf("(x1+x2+x3+x4+x5+x6-%d)^2+(x1-1)^2+(x2-2)^2+(x3-3)^2+(x4-1)^2+(x5-2)^2+(x6-3)^2", shift),
+				Tolerance: 0, MaxIter: 50000}
+			_, err := service.Optimization(context.Background(), query)
+			errs <- err
+		}(r)
+	}
+	for deadline := time.Now().Add(5 * time.Second); ; {
+		worker.mu.Lock()
+		queued := len(worker.pending)
+		worker.mu.Unlock()
+		if queued == requests {
+			break
+		}
+		if time.Now().After(deadline) {
+			t.Fatalf("only %d requests reached the worker", queued)
+		}
+		time.Sleep(time.Millisecond)
+	}
+	if err := worker.cmd.Process.Kill(); err != nil {
+		t.Fatal(err)
+	}
+
+	crashed := 0
+	for r := 0; r < requests; r++ {
+		switch err := <-errs; {
+		case errors.Is(err, ErrWorkerCrashed):
+			crashed++
+		case err != nil:
+			t.Error(err)
+		}
+	}
+	if crashed != 1 {
+		t.Errorf("%d requests failed with the worker, want 1", crashed)
+	}
+}
+
+// Сравнение с пулом потоков в процессе:
+// go test -bench NativeWorkers -run ^$
+func BenchmarkNativeWorkers(b *testing.B) {
+	for _, natives := range []int{0, 4} {
+		name := "cgo"
+		if natives > 0 {
+			name = "processes"
+		}
+		b.Run(name, func(b *testing.B) {
+			service, err := NewService(slog.New(slog.NewTextHandler(io.Discard, nil)),
+				Options{CacheEntries: 256, CacheNodes: 1 << 20, Workers: 4, NativeWorkers: natives})
+			if err != nil {
+				b.Fatal(err)
+			}
+			defer service.Close()
+
+			var next atomic.Int64
+			var mu sync.Mutex
+			var latencies []time.Duration
+			b.ResetTimer()
+			b.RunParallel(func(pb *testing.PB) {
+				var local []time.Duration
+				for pb.Next() {
+					query := OptimizationQuery{Function: fmt.Sprintf("(x1-%d)^2+(x2+1)^2+x1*x2/100", next.Add(1)%512), Tolerance: 1e-8, MaxIter: 500}
+					start := time.Now()
+					if _, err := service.Optimization(context.Background(), query); err != nil {
+						b.Error(err)
+						return
+					}
+					local = append(local, time.Since(start))
+				}
+				mu.Lock()
+				latencies = append(latencies, local...)
+				mu.Unlock()
+			})
+			b.StopTimer()
+			if len(latencies) > 0 {
+				sort.Slice(latencies, func(i, j int) bool { return latencies[i] < latencies[j] })
+				b.ReportMetric(float64(latencies[len(latencies)*99/100].Microseconds()), "p99-us")
+			}
+		})
+	}
+}
+
+// Доли островов вместе находят глобальный минимум многоэкстремальной
+// функции, недоступный обычному запуску из единиц; мигрант с лучшей
+// точкой принимается островом
+func TestServiceIsland(t *testing.T) {
+	service, err := NewService(slog.New(slog.NewTextHandler(io.Discard, nil)),
+		Options{CacheEntries: 16, CacheNodes: 1 << 16, Workers: 2})
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer service.Close()
+
+	// Минимумы у x1 = 10 (значение -100) и у x1 = 1 (значение 0)
+	query := OptimizationQuery{Function: "(x1-1)^2*(x1-10)^2-x1^2+(x2-3)^2", Tolerance: 1e-10, MaxIter: 2000}
+	plain, err := service.Optimization(context.Background(), query)
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	const islands = 3
+	best := math.Inf(1)
+	total := 0
+	for i := 0; i < islands; i++ {
+		var last IslandReport
+		task := IslandTask{Query: query, Island: i, Islands: islands, Starts: 24, Seed: 7, Radius: 12}
+		if err := service.Island(context.Background(), task, nil, func(report IslandReport) { last = report }); err != nil {
+			t.Fatal(err)
+		}
+		if !last.Done || last.Starts != 8 {
+			t.Errorf("island %d: last report %+v", i, last)
+		}
+		total += last.Starts
+		best = math.Min(best, last.Best.Value)
+	}
+	if total != 24 || best >= plain.FunctionValue-1 {
+		t.Errorf("islands: %d starts, best %g, plain %g", total, best, plain.FunctionValue)
+	}
+
+	// Единственный запуск доли начинается из единиц; мигрант не ухудшает ответ
+	migrants := make(chan IslandPoint, 1)
+	migrants <- IslandPoint{Names: []string{"x2", "x1"}, Point: []float64{3, 10}, Value: best}
+	close(migrants)
+	var last IslandReport
+	task := IslandTask{Query: query, Island: 0, Islands: 1, Starts: 1, Radius: 12}
+	if err := service.Island(context.Background(), task, migrants, func(report IslandReport) { last = report }); err != nil {
+		t.Fatal(err)
+	}
+	if last.Best.Value != plain.FunctionValue {
+		t.Errorf("single start %g, plain %g", last.Best.Value, plain.FunctionValue)
+	}
+	if err := service.Island(context.Background(), IslandTask{Query: query, Island: 2, Islands: 2, Starts: 1}, nil, func(IslandReport) {}); !errors.Is(err, ErrInvalidIsland) {
+		t.Errorf("expected ErrInvalidIsland, got %v", err)
+	}
+}
+
+func TestServiceRacing(t *testing.T) {
+	log := slog.New(slog.NewTextHandler(io.Discard, nil))
+	plain, err := NewService(log, Options{Workers: 2})
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer plain.Close()
+	racing, err := NewService(log, Options{SearchRadius: 5.12, RacingStarts: 16, Workers: 2})
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer racing.Close()
+
+	// Из единиц метод останавливается в ближайшем локальном минимуме
+	query := OptimizationQuery{Function: "sum(i, 1, 2, x[i]^2 - 10*cos(2*pi*x[i])) + 20", Tolerance: 1e-8, MaxIter: 2000}
+	local, err := plain.Optimization(context.Background(), query)
+	if err != nil {
+		t.Fatal(err)
+	}
+	replay, err := racing.Optimization(context.Background(), query)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if replay.FunctionValue > local.FunctionValue-0.5 {
+		t.Errorf("racing multi-start value %g, single start %g", replay.FunctionValue, local.FunctionValue)
+	}
+}
+
+func TestServiceScreening(t *testing.T) {
+	service, err := NewService(slog.New(slog.NewTextHandler(io.Discard, nil)),
+		Options{SearchRadius: 5, ScreenSamples: 256, ScreenStarts: 4, Workers: 2})
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer service.Close()
+
+	// Сдвинутые Растригин и Экли: из единиц метод не доходит до глобального минимума
+	var functions []string
+	for _, shift := range []string{"0.5", "1.7", "-2.3", "3.1", "-0.9"} {
+		functions = append(functions,
+			fmt.Sprintf("sum(i, 1, 2, (x[i]-%s)^2 - 10*cos(2*pi*(x[i]-%s))) + 20", shift, shift),
+			fmt.Sprintf("-20*exp(-0.2*sqrt(sum(i, 1, 2, (x[i]-%s)^2)/2)) - exp(sum(i, 1, 2, cos(2*pi*(x[i]-%s)))/2) + 20 + exp(1)", shift, shift))
+	}
+	for _, function := range functions {
+		if _, err := service.Optimization(context.Background(), OptimizationQuery{Function: function, Tolerance: 1e-8, MaxIter: 2000}); err != nil {
+			t.Fatal(err)
+		}
+	}
+	stats := service.ScreenStats()
+	t.Logf("screening found a better basin in %d of %d problems", stats.Improved, stats.Runs)
+	if stats.Runs != int64(len(functions)) || stats.Improved < stats.Runs/2 {
+		t.Errorf("screen stats %+v", stats)
+	}
+}
@@ -0,0 +1,214 @@
+#include "shm_channel.h"
+#include "expression.h"
+#include "nelder_mead.h"
+#include "polish.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+// Счетчики колец меняются парой процессов: публикация и проверка флага
+// ожидания упорядочены полностью (seq_cst), чтобы пробуждение не терялось
+uint64_t load(const uint8_t* p) {
+    return __atomic_load_n(reinterpret_cast<const uint64_t*>(p), __ATOMIC_SEQ_CST);
+}
+
+void store(uint8_t* p, uint64_t value) {
+    __atomic_store_n(reinterpret_cast<uint64_t*>(p), value, __ATOMIC_SEQ_CST);
+}
+
+void wait_event(int fd) {
+    uint64_t count;
+    while (read(fd, &count, sizeof(count)) < 0 && errno == EINTR) {
+    }
+}
+
+void signal_event(int fd) {
+    uint64_t one = 1;
+    while (write(fd, &one, sizeof(one)) < 0 && errno == EINTR) {
+    }
+}
+
+uint8_t* slot(uint8_t* ring, uint64_t index) {
+    return ring + SHM_RING_DATA + (index & (SHM_RING_SLOTS - 1)) * SHM_SLOT_SIZE;
+}
+
+// Вычислитель последнего выражения переиспользуется, пока запросы
+// приходят с тем же выражением
+struct Workspace {
+    ExprProgram* program;
+    ExprEvaluator* evaluator;
+
+    Workspace() : program(nullptr), evaluator(nullptr) {}
+    ~Workspace() { reset(); }
+
+    void reset() {
+        expr_evaluator_free(evaluator);
+        expr_program_free(program);
+        evaluator = nullptr;
+        program = nullptr;
+    }
+
+    void bind(ExprProgram* next) {
+        if (program && std::strcmp(expr_canonical_form(program), expr_canonical_form(next)) == 0) {
+            expr_program_free(next);
+            return;
+        }
+        reset();
+        program = next;
+        evaluator = expr_evaluator_create(program);
+    }
+};
+
+// Выполняет запрос и пишет ответ в ячейку reply
+void serve_request(const uint8_t* cell, uint8_t* reply_cell, Workspace& workspace) {
+    const ShmRequest* request = reinterpret_cast<const ShmRequest*>(cell);
+    const double* start = reinterpret_cast<const double*>(cell + sizeof(ShmRequest));
+    std::string source(reinterpret_cast<const char*>(start + request->dimension), request->source_size);
+
+    ShmReply* reply = reinterpret_cast<ShmReply*>(reply_cell);
+    double* x = reinterpret_cast<double*>(reply_cell + sizeof(ShmReply));
+    std::memset(reply, 0, sizeof(ShmReply));
+    reply->id = request->id;
+
+    char error[256];
+    ExprProgram* program = expr_compile_cached(source.c_str(), error, sizeof(error));
+    if (!program) {
+        reply->status = SHM_STATUS_INVALID;
+        reply->names_size = static_cast<int32_t>(std::strlen(error) + 1);
+        std::memcpy(x, error, reply->names_size);
+        return;
+    }
+    workspace.bind(program);
+    int n = expr_dimension(workspace.program);
+
+    // Имена должны уместиться в ячейку вместе с координатами
+    char* names = reinterpret_cast<char*>(x + n);
+    size_t names_capacity = SHM_SLOT_SIZE - sizeof(ShmReply) - n * sizeof(double);
+    size_t names_size = 0;
+    for (int i = 0; i < n; ++i) names_size += std::strlen(expr_variable_name(workspace.program, i)) + 1;
+    if (sizeof(ShmReply) + n * sizeof(double) > SHM_SLOT_SIZE || names_size > names_capacity ||
+        (request->dimension != 0 && request->dimension != n)) {
+        reply->status = SHM_STATUS_INVALID;
+        const char message[] = "problem does not fit the shared-memory slot";
+        reply->names_size = sizeof(message);
+        std::memcpy(x, message, sizeof(message));
+        return;
+    }
+
+    for (int i = 0; i < n; ++i) x[i] = request->dimension ? start[i] : 1.0;
+    OptimizationParams params = create_default_params();
+    params.tolerance = request->tolerance;
+    params.max_iter = request->max_iter;
+    double value = 0.0;
+    reply->status = nelder_mead_optimize_incremental(expr_objective, expr_objective_delta, x, n,
+                                                     &params, workspace.evaluator, &value);
+    if (reply->status == 0 && request->polish) {
+        PolishParams polish = create_default_polish_params();
+        lbfgs_polish(expr_objective_gradient, expr_objective_directional, x, n, &polish,
+                     workspace.evaluator, &value);
+    }
+    reply->final_value = value;
+    reply->dimension = n;
+
+    for (int i = 0; i < n; ++i) {
+        const char* name = expr_variable_name(workspace.program, i);
+        size_t size = std::strlen(name) + 1;
+        std::memcpy(names, name, size);
+        names += size;
+    }
+    reply->names_size = static_cast<int32_t>(names_size);
+}
+
+} // namespace
+
+int shm_channel_create(int cache_entries, long long cache_nodes,
+                       int* memfd, int* request_event, int* reply_event) {
+    int fd = static_cast<int>(syscall(SYS_memfd_create, "nelder-mead-channel", MFD_CLOEXEC));
+    if (fd < 0) return -1;
+    if (ftruncate(fd, SHM_CHANNEL_SIZE) != 0) {
+        close(fd);
+        return -1;
+    }
+    void* region = mmap(nullptr, SHM_CHANNEL_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (region == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+    ShmChannelHeader* header = static_cast<ShmChannelHeader*>(region);
+    header->magic = SHM_CHANNEL_MAGIC;
+    header->cache_entries = cache_entries;
+    header->cache_nodes = cache_nodes;
+    munmap(region, SHM_CHANNEL_SIZE);
+
+    int request = eventfd(0, EFD_CLOEXEC);
+    int reply = eventfd(0, EFD_CLOEXEC);
+    if (request < 0 || reply < 0) {
+        close(fd);
+        if (request >= 0) close(request);
+        if (reply >= 0) close(reply);
+        return -1;
+    }
+    *memfd = fd;
+    *request_event = request;
+    *reply_event = reply;
+    return 0;
+}
+
+int shm_channel_serve(int memfd, int request_event, int reply_event) {
+    void* region = mmap(nullptr, SHM_CHANNEL_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (region == MAP_FAILED) return -1;
+    uint8_t* base = static_cast<uint8_t*>(region);
+    ShmChannelHeader* header = reinterpret_cast<ShmChannelHeader*>(base);
+    if (header->magic != SHM_CHANNEL_MAGIC) {
+        munmap(region, SHM_CHANNEL_SIZE);
+        return -1;
+    }
+    expr_cache_configure(header->cache_entries, header->cache_nodes);
+
+    uint8_t* requests = base + SHM_CHANNEL_REQUESTS;
+    uint8_t* replies = base + SHM_CHANNEL_REPLIES;
+    Workspace workspace;
+    uint64_t tail = load(requests + SHM_RING_TAIL);
+    for (;;) {
+        if (tail == load(requests + SHM_RING_HEAD)) {
+            store(requests + SHM_RING_WAITING, 1);
+            if (tail == load(requests + SHM_RING_HEAD)) {
+                if (__atomic_load_n(&header->stop, __ATOMIC_SEQ_CST)) break;
+                wait_event(request_event);
+            }
+            store(requests + SHM_RING_WAITING, 0);
+            continue;
+        }
+
+        // Сервис держит в работе не больше SHM_RING_SLOTS запросов,
+        // так что ответу всегда есть место
+        uint64_t head = load(replies + SHM_RING_HEAD);
+        serve_request(slot(requests, tail), slot(replies, head), workspace);
+        store(requests + SHM_RING_TAIL, ++tail);
+        store(replies + SHM_RING_HEAD, head + 1);
+        if (load(replies + SHM_RING_WAITING)) signal_event(reply_event);
+    }
+
+    munmap(region, SHM_CHANNEL_SIZE);
+    return 0;
+}
+
+#else
+
+int shm_channel_create(int, long long, int*, int*, int*) {
+    return -1;
+}
+
+int shm_channel_serve(int, int, int) {
+    return -1;
+}
+
+#endif
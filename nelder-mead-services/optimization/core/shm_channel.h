@@ -0,0 +1,81 @@
+#ifndef SHM_CHANNEL_H
+#define SHM_CHANNEL_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// Канал сервиса с процессом-исполнителем: область memfd с двумя кольцами
+// одного производителя и одного потребителя (запросы к исполнителю и ответы
+// от него) и по eventfd на кольцо, которыми будится спящий потребитель.
+// Записи читаются прямо из ячеек кольца, без сериализации.
+
+#define SHM_CHANNEL_MAGIC 0x4e4d4348u
+#define SHM_RING_SLOTS 64        // Степень двойки
+#define SHM_SLOT_SIZE 16384
+
+// Смещения в кольце: счетчики на отдельных строках кэша
+#define SHM_RING_HEAD 0          // Записей опубликовано производителем (монотонный счетчик)
+#define SHM_RING_TAIL 64         // Записей разобрано потребителем
+#define SHM_RING_WAITING 128     // 1, пока потребитель спит на eventfd
+#define SHM_RING_DATA 192
+#define SHM_RING_SIZE (SHM_RING_DATA + SHM_RING_SLOTS * SHM_SLOT_SIZE)
+
+// Область: заголовок, кольцо запросов, кольцо ответов
+#define SHM_CHANNEL_REQUESTS 64
+#define SHM_CHANNEL_REPLIES (SHM_CHANNEL_REQUESTS + SHM_RING_SIZE)
+#define SHM_CHANNEL_SIZE (SHM_CHANNEL_REPLIES + SHM_RING_SIZE)
+
+// Выражение не компилируется, вместо имен в ответе сообщение об ошибке
+#define SHM_STATUS_INVALID (-100)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t stop;             // Исполнитель завершается, разобрав очередь
+    int32_t cache_entries;     // Настройки кэша выражений исполнителя
+    int32_t reserved;
+    int64_t cache_nodes;
+} ShmChannelHeader;
+
+// Запрос JOB_INCREMENTAL; за ним в ячейке double start[dimension]
+// и char source[source_size]
+typedef struct {
+    uint64_t id;               // Возвращается в ответе
+    double tolerance;
+    int32_t max_iter;
+    int32_t polish;            // Доводка L-BFGS с параметрами по умолчанию
+    int32_t dimension;         // Координат начальной точки, 0 - все координаты 1
+    int32_t source_size;       // Длина выражения без завершающего нуля
+} ShmRequest;
+
+// Ответ; за ним double x[dimension] и char names[names_size] - имена
+// переменных, каждое с завершающим нулем, в порядке x
+typedef struct {
+    uint64_t id;
+    double final_value;
+    int32_t status;            // Код метода, SHM_STATUS_INVALID - ошибка компиляции
+    int32_t dimension;
+    int32_t names_size;
+    int32_t reserved;
+} ShmReply;
+
+
+// Создает область memfd размера SHM_CHANNEL_SIZE с заголовком и два
+// блокирующих eventfd с O_CLOEXEC. Возвращает 0 или -1 (ошибка системы,
+// не Linux).
+int shm_channel_create(int cache_entries, long long cache_nodes,
+                       int* memfd, int* request_event, int* reply_event);
+
+// Цикл процесса-исполнителя над каналом, унаследованным от сервиса:
+// задачи выполняются по одной в вызывающем потоке. Возвращает 0 после
+// остановки (stop), -1, если канал недоступен.
+int shm_channel_serve(int memfd, int request_event, int reply_event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SHM_CHANNEL_H
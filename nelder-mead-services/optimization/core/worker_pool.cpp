@@ -0,0 +1,701 @@
+#include "worker_pool.h"
+#include "expression_impl.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+thread_local WorkerPool* current_pool = nullptr;  // Пул, которому принадлежит поток
+
+// Распараллеленная часть задачи (worker_pool_parallel). Помощник начинает
+// work, только пока вызывающий поток не закрыл запуск, и тот ждет лишь
+// начавшихся: не выбранные вовремя записи помощников ничего не держат.
+struct ParallelRun {
+    const std::function<void(int)>* work;
+    std::mutex mutex;
+    std::condition_variable finished;
+    int running;
+    bool closed;
+
+    explicit ParallelRun(const std::function<void(int)>& work) : work(&work), running(0), closed(false) {}
+
+    void help(int worker) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (closed) return;
+            ++running;
+        }
+        (*work)(worker);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--running == 0) finished.notify_all();
+    }
+
+    void close() {
+        std::unique_lock<std::mutex> lock(mutex);
+        closed = true;
+        finished.wait(lock, [this]() { return running == 0; });
+    }
+};
+
+// Квота CPU cgroup в ядрах (с округлением вверх), 0 - квоты нет
+int cgroup_cpu_limit() {
+#ifdef __linux__
+    // cgroup v2: "<quota> <period>" или "max <period>"
+    std::ifstream v2("/sys/fs/cgroup/cpu.max");
+    std::string quota;
+    double period = 0;
+    if (v2 >> quota >> period) {
+        if (quota == "max" || period <= 0) return 0;
+        return static_cast<int>(std::ceil(std::strtod(quota.c_str(), nullptr) / period));
+    }
+
+    std::ifstream v1_quota("/sys/fs/cgroup/cpu/cpu.cfs_quota_us");
+    std::ifstream v1_period("/sys/fs/cgroup/cpu/cpu.cfs_period_us");
+    double q = 0;
+    if (v1_quota >> q && v1_period >> period && q > 0 && period > 0) {
+        return static_cast<int>(std::ceil(q / period));
+    }
+#endif
+    return 0;
+}
+
+// Ядра из маски привязки процесса
+std::vector<int> allowed_cpus() {
+    std::vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+    }
+#endif
+    return cpus;
+}
+
+void pin_current_thread(int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpu;
+#endif
+}
+
+// Рабочая область потока: вычислитель последней программы переиспользуется,
+// пока задачи приходят с тем же выражением
+struct Workspace {
+    std::shared_ptr<const expr::Program> program;
+    std::unique_ptr<ExprEvaluator> evaluator;
+
+    ExprEvaluator* bind(const ExprProgram* source) {
+        if (!evaluator || program != source->program) {
+            evaluator.reset();
+            program = source->program;
+            evaluator.reset(new ExprEvaluator(*program));
+        }
+        return evaluator.get();
+    }
+
+    // Отдает вычислитель вытесняемой задаче, на которую ссылается ее состояние
+    std::unique_ptr<ExprEvaluator> take() {
+        program.reset();
+        return std::move(evaluator);
+    }
+};
+
+// Вытесненная задача: пошаговый метод со своим вычислителем
+struct JobRun {
+    std::shared_ptr<const expr::Program> program;
+    std::unique_ptr<ExprEvaluator> evaluator;
+    NelderMeadState* state;
+
+    JobRun() : state(nullptr) {}
+    ~JobRun() { nelder_mead_free(state); }
+};
+
+// Доводка и запись результата
+void finish_job(OptimizationJob* job, ExprEvaluator* evaluator, double value) {
+    int n = job->program->program->dimension();
+    job->unpolished_value = value;
+    if (job->status == 0 && job->polish) {
+        lbfgs_polish(expr_objective_gradient, expr_objective_directional, job->x, n,
+                     &job->polish_params, evaluator, &value);
+    }
+    job->final_value = value;
+}
+
+// Пошаговый метод задачи JOB_INCREMENTAL: с начальной точки или со снимка
+NelderMeadState* start_state(OptimizationJob* job, ExprEvaluator* evaluator) {
+    int n = job->program->program->dimension();
+    NelderMeadState* state = job->snapshot
+        ? nelder_mead_restore(expr_objective, job->snapshot, n, &job->params, evaluator)
+        : nelder_mead_start(expr_objective, expr_objective_delta, job->x, n, &job->params, evaluator);
+    if (state) nelder_mead_observe(state, &job->progress);
+    return state;
+}
+
+void run_job(OptimizationJob* job, ExprEvaluator* evaluator) {
+    int n = job->program->program->dimension();
+    double value = 0.0;
+
+    switch (job->mode) {
+    case JOB_SEPARABLE:
+        job->status = nelder_mead_optimize_separable(job->program, job->x, n, &job->params, &value);
+        break;
+    case JOB_BLOCKS:
+        job->status = nelder_mead_optimize_blocks(job->program, job->x, n, &job->params, &job->block_params, &value);
+        break;
+    case JOB_BRANCH_BOUND:
+        job->status = nelder_mead_optimize_branch_bound(job->program, job->x, n, job->lower, job->upper,
+                                                        &job->params, &job->bb_params, &value);
+        break;
+    case JOB_RACING:
+        job->status = nelder_mead_optimize_racing(job->program, job->x, n, job->lower, job->upper,
+                                                  &job->params, &job->race_params, &value, &job->race_stats);
+        break;
+    default: {
+        NelderMeadState* state = start_state(job, evaluator);
+        if (!state) {
+            job->status = -1;
+            break;
+        }
+        while (!nelder_mead_step(state, job->params.max_iter)) {
+        }
+        value = nelder_mead_best(state, job->x);
+        nelder_mead_free(state);
+        job->status = 0;
+        break;
+    }
+    }
+    finish_job(job, evaluator, value);
+}
+
+typedef std::chrono::steady_clock Clock;
+
+// Ограниченная очередь многих производителей и потребителей без блокировок
+// (кольцо с номерами поколений в ячейках, схема Вьюкова)
+template <typename T>
+class MpmcQueue {
+public:
+    explicit MpmcQueue(size_t capacity) : cells_(round_up(capacity)), mask_(cells_.size() - 1) {
+        for (size_t i = 0; i < cells_.size(); ++i) cells_[i].sequence.store(i, std::memory_order_relaxed);
+        head_.store(0, std::memory_order_relaxed);
+        tail_.store(0, std::memory_order_relaxed);
+    }
+
+    bool push(const T& value) {
+        Cell* cell;
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = value;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& value) {
+        Cell* cell;
+        size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+        value = cell->value;
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static size_t round_up(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size *= 2;
+        return size;
+    }
+
+    // Отступы разносят счетчики по разным строкам кэша (alignas потребовал
+    // бы выровненного new из C++17)
+    std::vector<Cell> cells_;
+    size_t mask_;
+    char pad_head_[64];
+    std::atomic<size_t> head_;
+    char pad_tail_[64];
+    std::atomic<size_t> tail_;
+};
+
+} // namespace
+
+
+struct WorkerPool {
+    struct Entry {
+        OptimizationJob* job;
+        JobCallback done;
+        Clock::time_point enqueued;
+        JobRun* run;                 // Состояние вытесненной задачи, NULL для новой
+        int lanes;                   // Задач в пакете (цепочка job->next), 1 - одиночная
+    };
+
+    // Фоновый класс получает первую попытку на каждом kBatchTurn-м выборе,
+    // чтобы поток интерактивных задач не откладывал его бесконечно
+    static const unsigned kBatchTurn = 8;
+
+    // Истечение кванта проверяется раз в kSliceCheck итераций метода
+    static const int kSliceCheck = 16;
+
+    // Помощник распараллеленной задачи: выбирается раньше очередей классов
+    struct Helper {
+        std::shared_ptr<ParallelRun> run;
+        int worker;
+    };
+
+    std::vector<std::unique_ptr<MpmcQueue<Entry>>> queues;
+    std::unique_ptr<MpmcQueue<Helper>> helpers;
+    std::atomic<int> helping;        // Помощников в очереди
+    std::atomic<int> depth[JOB_PRIORITY_CLASSES];
+    std::atomic<int> pending;
+    int queue_limit;
+    double max_job_cost;
+    double defer_cost;
+    Clock::duration time_slice;
+
+    // Очереди без блокировок; мьютекс нужен только, чтобы уснуть без потери сигнала
+    std::mutex park_mutex;
+    std::condition_variable ready;
+    std::atomic<int> sleepers;
+    std::atomic<bool> stopping;
+    std::vector<std::thread> threads;
+
+    std::atomic<long long> admitted;
+    std::atomic<long long> deferred;
+    std::atomic<long long> rejected_full;
+    std::atomic<long long> rejected_cost;
+    std::atomic<long long> completed;
+    std::atomic<long long> preempted;
+    std::atomic<long long> batches;
+    std::atomic<long long> wait_total_ns;
+    std::atomic<long long> wait_max_ns;
+
+    bool pop(Entry& entry, unsigned turn) {
+        int first = turn % kBatchTurn == 0 ? JOB_BATCH : JOB_INTERACTIVE;
+        for (int k = 0; k < JOB_PRIORITY_CLASSES; ++k) {
+            int c = (first + k) % JOB_PRIORITY_CLASSES;
+            if (queues[c]->pop(entry)) {
+                --depth[c];
+                --pending;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void record_wait(const Entry& entry) {
+        long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - entry.enqueued).count();
+        wait_total_ns += ns;
+        long long max = wait_max_ns.load();
+        while (ns > max && !wait_max_ns.compare_exchange_weak(max, ns)) {
+        }
+    }
+
+    void enqueue(int c, Entry& entry) {
+        entry.enqueued = Clock::now();
+        ++pending;
+        queues[c]->push(entry);
+    }
+
+    // Пошаговое выполнение JOB_INCREMENTAL квантами time_slice. Если по
+    // истечении кванта ждут задачи, которым текущая уступает (интерактивная -
+    // только интерактивным, фоновая - любым), она уходит в конец очереди
+    // своего класса и возвращается false.
+    bool run_sliced(Entry& entry, Workspace& workspace) {
+        OptimizationJob* job = entry.job;
+        ExprEvaluator* evaluator = entry.run ? entry.run->evaluator.get() : workspace.bind(job->program);
+        NelderMeadState* state = entry.run ? entry.run->state : nullptr;
+        if (!state) {
+            state = start_state(job, evaluator);
+            if (!state) {
+                job->status = -1;
+                return true;
+            }
+        }
+
+        int c = job->priority == JOB_BATCH ? JOB_BATCH : JOB_INTERACTIVE;
+        for (;;) {
+            Clock::time_point deadline = Clock::now() + time_slice;
+            bool done = false;
+            while (!(done = nelder_mead_step(state, kSliceCheck) != 0) && Clock::now() < deadline) {
+            }
+            if (done) break;
+            if (c == JOB_INTERACTIVE ? depth[JOB_INTERACTIVE] > 0 : pending > 0) {
+                if (!entry.run) {
+                    entry.run = new JobRun();
+                    entry.run->program = workspace.program;
+                    entry.run->evaluator = workspace.take();
+                    entry.run->state = state;
+                }
+                ++preempted;
+                ++depth[c];
+                enqueue(c, entry);
+                return false;
+            }
+        }
+
+        job->status = 0;
+        double value = nelder_mead_best(state, job->x);
+        finish_job(job, evaluator, value);
+        if (entry.run) {
+            delete entry.run;
+            entry.run = nullptr;
+        } else {
+            nelder_mead_free(state);
+        }
+        return true;
+    }
+
+    // Пакет мелких задач: методы всех дорожек выполняются поочередно по одной
+    // итерации, завершенная дорожка сразу отдает результат
+    void run_lanes(Entry& entry, Workspace& workspace) {
+        // Цепочку читаем заранее: после done задача может быть освобождена
+        std::vector<OptimizationJob*> jobs;
+        for (OptimizationJob* job = entry.job; job && static_cast<int>(jobs.size()) < entry.lanes; job = job->next) {
+            jobs.push_back(job);
+        }
+
+        // Дорожки одной программы делят вычислитель: шаг метода вычисляет
+        // функцию целиком и не опирается на базовую точку прошлого вызова
+        std::vector<std::unique_ptr<ExprEvaluator>> owned;
+        std::vector<ExprEvaluator*> evaluators(jobs.size(), nullptr);
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            const expr::Program* program = jobs[i]->program->program.get();
+            for (size_t j = 0; j < i && !evaluators[i]; ++j) {
+                if (jobs[j]->program->program.get() == program) evaluators[i] = evaluators[j];
+            }
+            if (evaluators[i]) continue;
+            if (i == 0) {
+                evaluators[i] = workspace.bind(jobs[i]->program);
+            } else {
+                owned.push_back(std::unique_ptr<ExprEvaluator>(new ExprEvaluator(*program)));
+                evaluators[i] = owned.back().get();
+            }
+        }
+
+        std::vector<NelderMeadState*> states(jobs.size(), nullptr);
+        size_t active = 0;
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            states[i] = start_state(jobs[i], evaluators[i]);
+            if (states[i]) {
+                ++active;
+            } else {
+                jobs[i]->status = -1;
+                complete(jobs[i], entry.done);
+            }
+        }
+
+        while (active > 0) {
+            for (size_t i = 0; i < jobs.size(); ++i) {
+                if (!states[i] || !nelder_mead_step(states[i], 1)) continue;
+                jobs[i]->status = 0;
+                double value = nelder_mead_best(states[i], jobs[i]->x);
+                nelder_mead_free(states[i]);
+                states[i] = nullptr;
+                --active;
+                finish_job(jobs[i], evaluators[i], value);
+                complete(jobs[i], entry.done);
+            }
+        }
+    }
+
+    void complete(OptimizationJob* job, JobCallback done) {
+        ++completed;
+        if (done) done(job);
+    }
+
+    void execute(Entry& entry, Workspace& workspace) {
+        if (entry.lanes > 1) {
+            run_lanes(entry, workspace);
+            return;
+        }
+        if (entry.job->mode == JOB_INCREMENTAL && time_slice > Clock::duration::zero()) {
+            if (!run_sliced(entry, workspace)) return;
+        } else {
+            run_job(entry.job, workspace.bind(entry.job->program));
+        }
+        complete(entry.job, entry.done);
+    }
+
+    void work(int cpu) {
+        current_pool = this;
+        if (cpu >= 0) pin_current_thread(cpu);
+        Workspace workspace;
+
+        for (unsigned turn = 1;; ++turn) {
+            Helper helper;
+            if (helping > 0 && helpers->pop(helper)) {
+                --helping;
+                helper.run->help(helper.worker);
+                continue;
+            }
+            Entry entry;
+            if (pop(entry, turn)) {
+                record_wait(entry);
+                execute(entry, workspace);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(park_mutex);
+            ++sleepers;
+            ready.wait(lock, [this]() { return stopping || pending > 0 || helping > 0; });
+            --sleepers;
+            if (stopping && pending == 0 && helping == 0) return;
+        }
+    }
+};
+
+
+WorkerPoolParams create_default_worker_pool_params(void) {
+    WorkerPoolParams params;
+    params.workers = 0;
+    params.pin_threads = 0;
+    params.queue_limit = 1024;
+    params.max_job_cost = 0.0;
+    params.defer_cost = 1e8;
+    params.time_slice = 0.05;
+    return params;
+}
+
+int available_cpus(void) {
+    int cpus = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<int> allowed = allowed_cpus();
+    if (!allowed.empty()) cpus = std::min(cpus, static_cast<int>(allowed.size()));
+    int limit = cgroup_cpu_limit();
+    if (limit > 0) cpus = std::min(cpus, limit);
+    return cpus;
+}
+
+WorkerPool* worker_pool_create(const WorkerPoolParams* params) {
+    if (!params || params->workers < 0 || params->queue_limit <= 0) return nullptr;
+
+    WorkerPool* pool = new WorkerPool();
+    pool->queue_limit = params->queue_limit;
+    pool->max_job_cost = params->max_job_cost;
+    pool->defer_cost = params->defer_cost;
+    pool->time_slice = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(std::max(0.0, params->time_slice)));
+
+    // Вытесненные задачи возвращаются в очередь сверх queue_limit,
+    // их не больше числа потоков
+    int workers = params->workers > 0 ? params->workers : available_cpus();
+    for (int c = 0; c < JOB_PRIORITY_CLASSES; ++c) {
+        pool->queues.push_back(std::unique_ptr<MpmcQueue<WorkerPool::Entry>>(
+            new MpmcQueue<WorkerPool::Entry>(params->queue_limit + workers)));
+        pool->depth[c] = 0;
+    }
+    // Помощников у каждой выполняемой задачи меньше, чем потоков
+    pool->helpers.reset(new MpmcQueue<WorkerPool::Helper>(static_cast<size_t>(workers) * workers));
+    pool->helping = 0;
+    pool->pending = 0;
+    pool->sleepers = 0;
+    pool->stopping = false;
+    pool->admitted = 0;
+    pool->deferred = 0;
+    pool->rejected_full = 0;
+    pool->rejected_cost = 0;
+    pool->completed = 0;
+    pool->preempted = 0;
+    pool->batches = 0;
+    pool->wait_total_ns = 0;
+    pool->wait_max_ns = 0;
+
+    std::vector<int> cpus;
+    if (params->pin_threads) cpus = allowed_cpus();
+    for (int t = 0; t < workers; ++t) {
+        int cpu = cpus.empty() ? -1 : cpus[t % cpus.size()];
+        pool->threads.push_back(std::thread(&WorkerPool::work, pool, cpu));
+    }
+    return pool;
+}
+
+void worker_pool_free(WorkerPool* pool) {
+    if (!pool) return;
+    {
+        std::lock_guard<std::mutex> lock(pool->park_mutex);
+        pool->stopping = true;
+    }
+    pool->ready.notify_all();
+    for (auto& thread : pool->threads) thread.join();
+    delete pool;
+}
+
+int worker_pool_size(const WorkerPool* pool) {
+    return static_cast<int>(pool->threads.size());
+}
+
+int worker_pool_pending(WorkerPool* pool) {
+    return pool->pending;
+}
+
+double worker_pool_job_cost(const OptimizationJob* job) {
+    const expr::Program& program = *job->program->program;
+    double iterations = std::max(1, job->params.max_iter);
+    if (job->mode == JOB_RACING) iterations *= std::max(1, job->race_params.starts);
+    return static_cast<double>(program.dimension()) * static_cast<double>(expr::program_nodes(program)) * iterations;
+}
+
+namespace {
+
+int submit_entry(WorkerPool* pool, OptimizationJob* head, int lanes, JobCallback done) {
+    if (!pool || !head || pool->stopping) return -1;
+
+    // Ограничение стоимости действует на каждую задачу, перевод в фоновый
+    // класс - на суммарную стоимость пакета
+    double total = 0.0;
+    OptimizationJob* job = head;
+    for (int i = 0; i < lanes; ++i, job = job->next) {
+        if (!job || !job->program || !job->x) return -1;
+        double cost = worker_pool_job_cost(job);
+        if (pool->max_job_cost > 0 && cost > pool->max_job_cost) {
+            ++pool->rejected_cost;
+            return -2;
+        }
+        total += cost;
+    }
+    int c = head->priority == JOB_BATCH ? JOB_BATCH : JOB_INTERACTIVE;
+    bool defer = c == JOB_INTERACTIVE && pool->defer_cost > 0 && total > pool->defer_cost;
+    if (defer) c = JOB_BATCH;
+
+    // Счетчик глубины не дает занять больше queue_limit ячеек кольца
+    if (++pool->depth[c] > pool->queue_limit) {
+        --pool->depth[c];
+        pool->rejected_full += lanes;
+        return -1;
+    }
+    job = head;
+    for (int i = 0; i < lanes; ++i, job = job->next) job->priority = c;
+
+    WorkerPool::Entry entry;
+    entry.job = head;
+    entry.done = done;
+    entry.run = nullptr;
+    entry.lanes = lanes;
+    pool->enqueue(c, entry);
+    pool->admitted += lanes;
+    if (defer) pool->deferred += lanes;
+    if (lanes > 1) ++pool->batches;
+
+    if (pool->sleepers > 0) {
+        std::lock_guard<std::mutex> lock(pool->park_mutex);
+        pool->ready.notify_one();
+    }
+    return 0;
+}
+
+} // namespace
+
+int worker_pool_submit(WorkerPool* pool, OptimizationJob* job, JobCallback done) {
+    return submit_entry(pool, job, 1, done);
+}
+
+int worker_pool_submit_batch(WorkerPool* pool, OptimizationJob* jobs, JobCallback done) {
+    int lanes = 0;
+    for (OptimizationJob* job = jobs; job; job = job->next) ++lanes;
+    return submit_entry(pool, jobs, lanes, done);
+}
+
+WorkerPoolStats worker_pool_stats(WorkerPool* pool) {
+    WorkerPoolStats stats;
+    stats.interactive_depth = pool->depth[JOB_INTERACTIVE];
+    stats.batch_depth = pool->depth[JOB_BATCH];
+    stats.admitted = pool->admitted;
+    stats.deferred = pool->deferred;
+    stats.rejected_full = pool->rejected_full;
+    stats.rejected_cost = pool->rejected_cost;
+    stats.completed = pool->completed;
+    stats.preempted = pool->preempted;
+    stats.batches = pool->batches;
+    stats.wait_total = pool->wait_total_ns * 1e-9;
+    stats.wait_max = pool->wait_max_ns * 1e-9;
+    return stats;
+}
+
+int worker_pool_parallelism(int jobs) {
+    static const int cpus = available_cpus();
+    if (jobs <= 1) return 1;
+    if (current_pool) return std::min(worker_pool_size(current_pool), jobs);
+    return std::min(cpus, jobs);
+}
+
+void worker_pool_parallel(int jobs, const std::function<void(int)>& work) {
+    int workers = worker_pool_parallelism(jobs);
+    WorkerPool* pool = current_pool;
+    if (!pool) {
+        std::vector<std::thread> threads;
+        for (int t = 1; t < workers; ++t) threads.push_back(std::thread(work, t));
+        work(0);
+        for (auto& thread : threads) thread.join();
+        return;
+    }
+
+    // Помощники только для спящих потоков: занятые потоки не откладывают
+    // ради них свои очереди
+    std::shared_ptr<ParallelRun> run = std::make_shared<ParallelRun>(work);
+    int posted = 0;
+    for (int t = 1; t < std::min(workers, pool->sleepers.load() + 1); ++t) {
+        WorkerPool::Helper helper;
+        helper.run = run;
+        helper.worker = t;
+        ++pool->helping;
+        if (!pool->helpers->push(helper)) {
+            --pool->helping;
+            break;
+        }
+        ++posted;
+    }
+    if (posted > 0) {
+        std::lock_guard<std::mutex> lock(pool->park_mutex);
+        pool->ready.notify_all();
+    }
+    work(0);
+    run->close();
+}
@@ -0,0 +1,177 @@
+package core
+
+/*
+#include "worker_pool.h"
+#include <stdlib.h>
+
+// Уведомление Go о завершении задачи, вызывается из потока пула
+extern void goJobDone(OptimizationJob* job);
+*/
+import "C"
+
+import (
+	"errors"
+	"runtime/cgo"
+	"unsafe"
+)
+
+// WorkerPool - потоки C++ с очередями по приоритетам: число потоков ОС, занятых
+// оптимизацией, не растет вместе с числом одновременных запросов
+type WorkerPool struct {
+	pool *C.WorkerPool
+}
+
+func newWorkerPool(options Options) (*WorkerPool, error) {
+	params := C.create_default_worker_pool_params()
+	params.workers = C.int(options.Workers)
+	if options.PinThreads {
+		params.pin_threads = 1
+	}
+	if options.QueueLimit > 0 {
+		params.queue_limit = C.int(options.QueueLimit)
+	}
+	params.max_job_cost = C.double(options.MaxJobCost)
+	params.defer_cost = C.double(options.DeferCost)
+	params.time_slice = C.double(options.TimeSlice.Seconds())
+
+	pool := C.worker_pool_create(&params)
+	if pool == nil {
+		return nil, errors.New("invalid worker pool parameters")
+	}
+	return &WorkerPool{pool: pool}, nil
+}
+
+func (p *WorkerPool) Size() int {
+	return int(C.worker_pool_size(p.pool))
+}
+
+// Close дожидается уже принятых задач
+func (p *WorkerPool) Close() {
+	C.worker_pool_free(p.pool)
+}
+
+func (p *WorkerPool) Stats() WorkerPoolStats {
+	stats := C.worker_pool_stats(p.pool)
+	return WorkerPoolStats{
+		InteractiveDepth: int(stats.interactive_depth),
+		BatchDepth:       int(stats.batch_depth),
+		Admitted:         int64(stats.admitted),
+		Deferred:         int64(stats.deferred),
+		RejectedFull:     int64(stats.rejected_full),
+		RejectedCost:     int64(stats.rejected_cost),
+		Completed:        int64(stats.completed),
+		Preempted:        int64(stats.preempted),
+		Batches:          int64(stats.batches),
+		WaitTotal:        float64(stats.wait_total),
+		WaitMax:          float64(stats.wait_max),
+	}
+}
+
+// nativeJob - задача и ее буферы в памяти C: пул держит указатели на них
+// после возврата из worker_pool_submit, что запрещено для памяти Go
+type nativeJob struct {
+	job      *C.OptimizationJob
+	x        []C.double
+	done     chan error   // Уведомление о завершении, сигналит goJobDone
+	progress *C.uintptr_t // Метка наблюдателя (observe), nil - без него
+}
+
+func newNativeJob(program *NativeProgram, params C.OptimizationParams, priority Priority) *nativeJob {
+	n := program.Dimension()
+	job := (*C.OptimizationJob)(C.calloc(1, C.sizeof_OptimizationJob))
+	job.program = program.program
+	job.x = (*C.double)(C.calloc(C.size_t(n), C.sizeof_double))
+	job.mode = C.JOB_INCREMENTAL
+	job.params = params
+	if priority == PriorityBatch {
+		job.priority = C.JOB_BATCH
+	}
+	return &nativeJob{job: job, x: unsafe.Slice(job.x, n)}
+}
+
+// setBox задает бокс глобального поиска [x - radius, x + radius]
+func (j *nativeJob) setBox(radius float64) {
+	n := len(j.x)
+	lower := (*C.double)(C.calloc(C.size_t(n), C.sizeof_double))
+	upper := (*C.double)(C.calloc(C.size_t(n), C.sizeof_double))
+	lowerSlice, upperSlice := unsafe.Slice(lower, n), unsafe.Slice(upper, n)
+	for i, v := range j.x {
+		lowerSlice[i] = v - C.double(radius)
+		upperSlice[i] = v + C.double(radius)
+	}
+	j.job.lower, j.job.upper = lower, upper
+}
+
+func (j *nativeJob) Free() {
+	if j.progress != nil {
+		cgo.Handle(*j.progress).Delete()
+		C.free(unsafe.Pointer(j.progress))
+	}
+	C.free(unsafe.Pointer(j.job.snapshot))
+	C.free(unsafe.Pointer(j.job.lower))
+	C.free(unsafe.Pointer(j.job.upper))
+	C.free(unsafe.Pointer(j.job.x))
+	C.free(unsafe.Pointer(j.job))
+}
+
+// wait связывает задачу с каналом завершения на время ожидания
+func (j *nativeJob) wait() (cgo.Handle, chan error) {
+	j.done = make(chan error, 1)
+	handle := cgo.NewHandle(j.done)
+	j.job.tag = C.uintptr_t(handle)
+	return handle, j.done
+}
+
+// Run ставит задачу в очередь и ждет ее выполнения, не занимая поток ОС
+func (p *WorkerPool) Run(j *nativeJob) error {
+	handle, done := j.wait()
+	defer handle.Delete()
+
+	if err := submitError(C.worker_pool_submit(p.pool, j.job, (C.JobCallback)(C.goJobDone))); err != nil {
+		return err
+	}
+	return <-done
+}
+
+// RunBatch ставит задачи в очередь одним пакетом и ждет выполнения всех
+func (p *WorkerPool) RunBatch(jobs []*nativeJob) error {
+	dones := make([]chan error, len(jobs))
+	for i, j := range jobs {
+		handle, done := j.wait()
+		defer handle.Delete()
+		dones[i] = done
+		if i > 0 {
+			jobs[i-1].job.next = j.job
+		}
+	}
+	if err := p.submitBatch(jobs[0].job); err != nil {
+		return err
+	}
+	for _, done := range dones {
+		if err := <-done; err != nil {
+			return err
+		}
+	}
+	return nil
+}
+
+// submitBatch ставит в очередь цепочку задач, связанных через next
+func (p *WorkerPool) submitBatch(head *C.OptimizationJob) error {
+	return submitError(C.worker_pool_submit_batch(p.pool, head, (C.JobCallback)(C.goJobDone)))
+}
+
+func submitError(code C.int) error {
+	switch code {
+	case 0:
+		return nil
+	case -2:
+		return ErrJobTooCostly
+	default:
+		return ErrOverloaded
+	}
+}
+
+//export goJobDone
+func goJobDone(job *C.OptimizationJob) {
+	cgo.Handle(job.tag).Value().(chan error) <- nil
+}
@@ -0,0 +1,136 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <stdint.h>
+#include "branch_bound.h"
+#include "decomposition.h"
+#include "expression.h"
+#include "nelder_mead.h"
+#include "polish.h"
+#include "racing.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+typedef struct WorkerPool WorkerPool;    // Потоки-исполнители с очередями задач по приоритетам
+
+typedef struct {
+    int workers;         // Число потоков, 0 - по числу доступных ядер
+    int pin_threads;     // Закрепить каждый поток за своим ядром
+    int queue_limit;     // Предел числа ожидающих задач в каждом классе приоритета
+    double max_job_cost; // Задачи дороже отклоняются, 0 - без ограничения
+    double defer_cost;   // Интерактивные задачи дороже переводятся в фоновый класс, 0 - никогда
+    double time_slice;   // Квант JOB_INCREMENTAL в секундах (обычно 0.05), 0 - без вытеснения
+} WorkerPoolParams;
+
+typedef enum {
+    JOB_INTERACTIVE,     // Короткие запросы пользователей, выбираются первыми
+    JOB_BATCH,           // Пакетные и отложенные задачи
+    JOB_PRIORITY_CLASSES
+} JobPriority;
+
+typedef enum {
+    JOB_INCREMENTAL,     // nelder_mead_optimize_incremental над выражением
+    JOB_SEPARABLE,       // nelder_mead_optimize_separable
+    JOB_BLOCKS,          // nelder_mead_optimize_blocks
+    JOB_BRANCH_BOUND,    // nelder_mead_optimize_branch_bound на боксе [lower, upper]
+    JOB_RACING           // nelder_mead_optimize_racing на боксе [lower, upper]
+} JobMode;
+
+typedef struct OptimizationJob {
+    const ExprProgram* program;
+    double* x;                     // Начальное приближение (будет содержать результат), n = expr_dimension
+    int mode;                      // JobMode
+    int priority;                  // JobPriority
+    OptimizationParams params;
+    BlockParams block_params;      // Для JOB_BLOCKS
+    BranchBoundParams bb_params;   // Для JOB_BRANCH_BOUND
+    RacingParams race_params;      // Для JOB_RACING
+    const double* lower;
+    const double* upper;
+    int polish;                    // Доводка L-BFGS после метода
+    PolishParams polish_params;
+    const double* snapshot;        // JOB_INCREMENTAL продолжается с этого снимка (nelder_mead_snapshot), NULL - с x
+    ProgressParams progress;       // Наблюдатель JOB_INCREMENTAL, callback NULL - без него
+    uintptr_t tag;                 // Метка вызывающей стороны, пулом не используется
+    struct OptimizationJob* next;  // Следующая задача пакета (worker_pool_submit_batch)
+
+    int status;                    // Результат: код возврата метода
+    double final_value;            // Итоговое значение функции
+    double unpolished_value;       // Значение до доводки
+    RacingStats race_stats;        // Счетчики JOB_RACING
+} OptimizationJob;
+
+// Вызывается из потока пула после выполнения задачи
+typedef void (*JobCallback)(OptimizationJob* job);
+
+typedef struct {
+    int interactive_depth;     // Задач в очереди интерактивного класса
+    int batch_depth;           // Задач в очереди фонового класса
+    long long admitted;        // Принято задач
+    long long deferred;        // Из них переведено в фоновый класс по стоимости
+    long long rejected_full;   // Отклонено: очередь класса заполнена
+    long long rejected_cost;   // Отклонено: стоимость выше max_job_cost
+    long long completed;       // Выполнено задач
+    long long preempted;       // Вытеснений по истечении кванта
+    long long batches;         // Пакетов из нескольких задач
+    double wait_total;         // Суммарное ожидание в очереди выполненных задач, с
+    double wait_max;           // Наибольшее ожидание в очереди, с
+} WorkerPoolStats;
+
+
+WorkerPoolParams create_default_worker_pool_params(void);
+
+// Число ядер, доступных процессу: с учетом маски привязки и квоты CPU cgroup
+int available_cpus(void);
+
+WorkerPool* worker_pool_create(const WorkerPoolParams* params);
+
+// Останавливает прием задач, дожидается выполнения уже принятых
+void worker_pool_free(WorkerPool* pool);
+
+int worker_pool_size(const WorkerPool* pool);
+
+// Число задач в очередях (без выполняемых)
+int worker_pool_pending(WorkerPool* pool);
+
+// Оценка стоимости задачи: размерность * число узлов выражения * max_iter
+// (для JOB_RACING - на весь бюджет starts * max_iter)
+double worker_pool_job_cost(const OptimizationJob* job);
+
+// Ставит задачу в очередь ее класса приоритета. Задача JOB_INCREMENTAL,
+// не уложившаяся в квант при непустой очереди, сохраняет состояние метода
+// и продолжается позже из конца фоновой очереди. Задача и все ее буферы
+// должны жить до вызова done. Возвращает -1, если очередь заполнена или пул
+// останавливается, -2, если стоимость задачи выше max_job_cost.
+int worker_pool_submit(WorkerPool* pool, OptimizationJob* job, JobCallback done);
+
+// Пакет мелких задач JOB_INCREMENTAL, связанных через next, ставится в очередь
+// одной записью. Методы всех задач выполняются в одном потоке поочередно по
+// итерации, done вызывается для каждой задачи сразу по ее завершении.
+// Коды возврата как у worker_pool_submit.
+int worker_pool_submit_batch(WorkerPool* pool, OptimizationJob* jobs, JobCallback done);
+
+WorkerPoolStats worker_pool_stats(WorkerPool* pool);
+
+// Наибольшее число потоков для распараллеливания внутри одной задачи
+// из jobs независимых частей: в потоке пула - по числу его потоков,
+// иначе по числу доступных ядер
+int worker_pool_parallelism(int jobs);
+
+#ifdef __cplusplus
+}
+
+#include <functional>
+
+// Выполняет work(0) в вызывающем потоке и work(1..) в помощниках, всего не
+// больше worker_pool_parallelism(jobs). В потоке пула помощники - записи
+// пула для его спящих потоков, так что ядра не делятся сверх числа потоков;
+// не успевший начаться помощник пропускается. work должна разбирать части
+// из общего счетчика: номер нужен только для данных потока.
+void worker_pool_parallel(int jobs, const std::function<void(int)>& work);
+#endif
+
+#endif // WORKER_POOL_H
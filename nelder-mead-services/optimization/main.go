@@ -2,22 +2,32 @@ package main
 
 import (
 	grpc2 "awesomeProject2/optimization/adapters/grpc"
+	"awesomeProject2/optimization/adapters/joblog"
+	"awesomeProject2/optimization/adapters/resultstore"
 	"awesomeProject2/optimization/config"
 	"awesomeProject2/optimization/core"
 	__ "awesomeProject2/proto/optimizator"
 	"context"
+	"expvar"
 	"flag"
 	"fmt"
 	"log/slog"
 	"net"
+	"net/http"
 	"os"
 	"os/signal"
+	"strings"
 
 	"google.golang.org/grpc"
 	"google.golang.org/grpc/reflection"
 )
 
 func main() {
+	// Процессы-исполнители (native_workers) - этот же файл
+	if core.RunNativeWorker() {
+		return
+	}
+
 	var configPath string
 	flag.StringVar(&configPath, "config", "config.yaml", "server configuration file")
 	flag.Parse()
@@ -35,12 +45,83 @@ func run(cfg config.Config, log *slog.Logger) error {
 	log.Info("starting server")
 	log.Debug("debug messages are enabled")
 
-	optimizator, err := core.NewService(log)
+	// Хранилище ответов, общее для экземпляров сервиса на хосте
+	var results core.ResultCache
+	if cfg.ResultCachePath != "" {
+		store, err := resultstore.Open(cfg.ResultCachePath, cfg.ResultCacheSize)
+		if err != nil {
+			return fmt.Errorf("failed to open result cache: %v", err)
+		}
+		defer store.Close()
+		results = store
+		if cfg.MetricsAddress != "" {
+			expvar.Publish("result_cache", expvar.Func(func() any {
+				return store.Stats()
+			}))
+		}
+	}
+
+	// Журнал фоновых задач: незавершенные задачи продолжаются после перезапуска
+	var jobs core.JobLog
+	if cfg.JobLogPath != "" {
+		jobLog, err := joblog.Open(cfg.JobLogPath)
+		if err != nil {
+			return fmt.Errorf("failed to open job log: %v", err)
+		}
+		defer jobLog.Close()
+		jobs = jobLog
+	}
+
+	optimizator, err := core.NewService(log, core.Options{
+		CacheEntries:        cfg.CacheEntries,
+		CacheNodes:          cfg.CacheNodes,
+		Polish:              cfg.Polish,
+		SearchRadius:        cfg.SearchRadius,
+		RacingStarts:        cfg.RacingStarts,
+		ScreenSamples:       cfg.ScreenSamples,
+		ScreenStarts:        cfg.ScreenStarts,
+		Workers:             cfg.Workers,
+		PinThreads:          cfg.PinThreads,
+		QueueLimit:          cfg.QueueLimit,
+		MaxJobCost:          cfg.MaxJobCost,
+		DeferCost:           cfg.DeferCost,
+		TimeSlice:           cfg.TimeSlice,
+		NativeWorkers:       cfg.NativeWorkers,
+		BatchWindow:         cfg.BatchWindow,
+		BatchSize:           cfg.BatchSize,
+		Results:             results,
+		ProgressInterval:    cfg.ProgressInterval,
+		Jobs:                jobs,
+		JobRetention:        cfg.JobRetention,
+		JobSnapshotInterval: cfg.JobSnapshotInterval,
+	})
 	if err != nil {
 		return fmt.Errorf("failed create Optimizator client: %v", err)
 	}
+	defer optimizator.Close()
 
-	listener, err := net.Listen("tcp", cfg.Address)
+	if cfg.MetricsAddress != "" {
+		expvar.Publish("expression_cache", expvar.Func(func() any {
+			return core.ExpressionCacheStats()
+		}))
+		expvar.Publish("worker_pool", expvar.Func(func() any {
+			return optimizator.WorkerPoolStats()
+		}))
+		expvar.Publish("coalescing", expvar.Func(func() any {
+			return optimizator.CoalesceStats()
+		}))
+		expvar.Publish("screening", expvar.Func(func() any {
+			return optimizator.ScreenStats()
+		}))
+		go func() {
+			log.Info("serving metrics", "address", cfg.MetricsAddress)
+			if err := http.ListenAndServe(cfg.MetricsAddress, nil); err != nil {
+				log.Error("metrics server failed", "error", err)
+			}
+		}()
+	}
+
+	listener, err := listen(cfg.Address)
 	if err != nil {
 		return fmt.Errorf("failed to listen: %v", err)
 	}
@@ -65,6 +146,20 @@ func run(cfg config.Config, log *slog.Logger) error {
 	return nil
 }
 
+// listen открывает TCP-адрес или Unix-сокет "unix:///path": для API на том же
+// хосте сокет дешевле TCP loopback. Сокет, оставшийся от прошлого запуска, удаляется.
+func listen(address string) (net.Listener, error) {
+	path, ok := strings.CutPrefix(address, "unix:")
+	if !ok {
+		return net.Listen("tcp", address)
+	}
+	path = strings.TrimPrefix(path, "//")
+	if info, err := os.Stat(path); err == nil && info.Mode()&os.ModeSocket != 0 {
+		os.Remove(path)
+	}
+	return net.Listen("unix", path)
+}
+
 func mustMakeLogger(logLevel string) *slog.Logger {
 	var level slog.Level
 	switch logLevel {
@@ -186,6 +186,588 @@ func (x *OptimizationReply) GetFunctionValue() float64 {
 	return 0
 }
 
+// Ход метода; последнее сообщение потока содержит result
+type OptimizationProgress struct {
+	state         protoimpl.MessageState `protogen:"open.v1"`
+	Iteration     int64                  `protobuf:"varint,1,opt,name=iteration,proto3" json:"iteration,omitempty"`
+	BestValue     float64                `protobuf:"fixed64,2,opt,name=bestValue,proto3" json:"bestValue,omitempty"`
+	Spread        float64                `protobuf:"fixed64,3,opt,name=spread,proto3" json:"spread,omitempty"`
+	Evaluations   int64                  `protobuf:"varint,4,opt,name=evaluations,proto3" json:"evaluations,omitempty"`
+	Result        *OptimizationReply     `protobuf:"bytes,5,opt,name=result,proto3" json:"result,omitempty"`
+	unknownFields protoimpl.UnknownFields
+	sizeCache     protoimpl.SizeCache
+}
+
+func (x *OptimizationProgress) Reset() {
+	*x = OptimizationProgress{}
+	mi := &file_optimizator_proto_msgTypes[3]
+	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+	ms.StoreMessageInfo(mi)
+}
+
+func (x *OptimizationProgress) String() string {
+	return protoimpl.X.MessageStringOf(x)
+}
+
+func (*OptimizationProgress) ProtoMessage() {}
+
+func (x *OptimizationProgress) ProtoReflect() protoreflect.Message {
+	mi := &file_optimizator_proto_msgTypes[3]
+	if x != nil {
+		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+		if ms.LoadMessageInfo() == nil {
+			ms.StoreMessageInfo(mi)
+		}
+		return ms
+	}
+	return mi.MessageOf(x)
+}
+
+// Deprecated: Use OptimizationProgress.ProtoReflect.Descriptor instead.
+func (*OptimizationProgress) Descriptor() ([]byte, []int) {
+	return file_optimizator_proto_rawDescGZIP(), []int{3}
+}
+
+func (x *OptimizationProgress) GetIteration() int64 {
+	if x != nil {
+		return x.Iteration
+	}
+	return 0
+}
+
+func (x *OptimizationProgress) GetBestValue() float64 {
+	if x != nil {
+		return x.BestValue
+	}
+	return 0
+}
+
+func (x *OptimizationProgress) GetSpread() float64 {
+	if x != nil {
+		return x.Spread
+	}
+	return 0
+}
+
+func (x *OptimizationProgress) GetEvaluations() int64 {
+	if x != nil {
+		return x.Evaluations
+	}
+	return 0
+}
+
+func (x *OptimizationProgress) GetResult() *OptimizationReply {
+	if x != nil {
+		return x.Result
+	}
+	return nil
+}
+
+type BatchRequest struct {
+	state         protoimpl.MessageState `protogen:"open.v1"`
+	Problems      []*OptimizationRequest `protobuf:"bytes,1,rep,name=problems,proto3" json:"problems,omitempty"`
+	unknownFields protoimpl.UnknownFields
+	sizeCache     protoimpl.SizeCache
+}
+
+func (x *BatchRequest) Reset() {
+	*x = BatchRequest{}
+	mi := &file_optimizator_proto_msgTypes[4]
+	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+	ms.StoreMessageInfo(mi)
+}
+
+func (x *BatchRequest) String() string {
+	return protoimpl.X.MessageStringOf(x)
+}
+
+func (*BatchRequest) ProtoMessage() {}
+
+func (x *BatchRequest) ProtoReflect() protoreflect.Message {
+	mi := &file_optimizator_proto_msgTypes[4]
+	if x != nil {
+		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+		if ms.LoadMessageInfo() == nil {
+			ms.StoreMessageInfo(mi)
+		}
+		return ms
+	}
+	return mi.MessageOf(x)
+}
+
+// Deprecated: Use BatchRequest.ProtoReflect.Descriptor instead.
+func (*BatchRequest) Descriptor() ([]byte, []int) {
+	return file_optimizator_proto_rawDescGZIP(), []int{4}
+}
+
+func (x *BatchRequest) GetProblems() []*OptimizationRequest {
+	if x != nil {
+		return x.Problems
+	}
+	return nil
+}
+
+// Результат одной задачи пакета, приходит по мере готовности
+type BatchResult struct {
+	state         protoimpl.MessageState `protogen:"open.v1"`
+	Index         int32                  `protobuf:"varint,1,opt,name=index,proto3" json:"index,omitempty"`
+	Reply         *OptimizationReply     `protobuf:"bytes,2,opt,name=reply,proto3" json:"reply,omitempty"`
+	Error         string                 `protobuf:"bytes,3,opt,name=error,proto3" json:"error,omitempty"`
+	unknownFields protoimpl.UnknownFields
+	sizeCache     protoimpl.SizeCache
+}
+
+func (x *BatchResult) Reset() {
+	*x = BatchResult{}
+	mi := &file_optimizator_proto_msgTypes[5]
+	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+	ms.StoreMessageInfo(mi)
+}
+
+func (x *BatchResult) String() string {
+	return protoimpl.X.MessageStringOf(x)
+}
+
+func (*BatchResult) ProtoMessage() {}
+
+func (x *BatchResult) ProtoReflect() protoreflect.Message {
+	mi := &file_optimizator_proto_msgTypes[5]
+	if x != nil {
+		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+		if ms.LoadMessageInfo() == nil {
+			ms.StoreMessageInfo(mi)
+		}
+		return ms
+	}
+	return mi.MessageOf(x)
+}
+
+// Deprecated: Use BatchResult.ProtoReflect.Descriptor instead.
+func (*BatchResult) Descriptor() ([]byte, []int) {
+	return file_optimizator_proto_rawDescGZIP(), []int{5}
+}
+
+func (x *BatchResult) GetIndex() int32 {
+	if x != nil {
+		return x.Index
+	}
+	return 0
+}
+
+func (x *BatchResult) GetReply() *OptimizationReply {
+	if x != nil {
+		return x.Reply
+	}
+	return nil
+}
+
+func (x *BatchResult) GetError() string {
+	if x != nil {
+		return x.Error
+	}
+	return ""
+}
+
+type JobRequest struct {
+	state         protoimpl.MessageState `protogen:"open.v1"`
+	Id            string                 `protobuf:"bytes,1,opt,name=id,proto3" json:"id,omitempty"`
+	unknownFields protoimpl.UnknownFields
+	sizeCache     protoimpl.SizeCache
+}
+
+func (x *JobRequest) Reset() {
+	*x = JobRequest{}
+	mi := &file_optimizator_proto_msgTypes[6]
+	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+	ms.StoreMessageInfo(mi)
+}
+
+func (x *JobRequest) String() string {
+	return protoimpl.X.MessageStringOf(x)
+}
+
+func (*JobRequest) ProtoMessage() {}
+
+func (x *JobRequest) ProtoReflect() protoreflect.Message {
+	mi := &file_optimizator_proto_msgTypes[6]
+	if x != nil {
+		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+		if ms.LoadMessageInfo() == nil {
+			ms.StoreMessageInfo(mi)
+		}
+		return ms
+	}
+	return mi.MessageOf(x)
+}
+
+// Deprecated: Use JobRequest.ProtoReflect.Descriptor instead.
+func (*JobRequest) Descriptor() ([]byte, []int) {
+	return file_optimizator_proto_rawDescGZIP(), []int{6}
+}
+
+func (x *JobRequest) GetId() string {
+	if x != nil {
+		return x.Id
+	}
+	return ""
+}
+
+// Состояние фоновой задачи: queued, running, done, failed, cancelled.
+// result задан для done и cancelled (лучшая точка на момент отмены)
+type JobStatus struct {
+	state         protoimpl.MessageState `protogen:"open.v1"`
+	Id            string                 `protobuf:"bytes,1,opt,name=id,proto3" json:"id,omitempty"`
+	State         string                 `protobuf:"bytes,2,opt,name=state,proto3" json:"state,omitempty"`
+	Iteration     int64                  `protobuf:"varint,3,opt,name=iteration,proto3" json:"iteration,omitempty"`
+	BestValue     float64                `protobuf:"fixed64,4,opt,name=bestValue,proto3" json:"bestValue,omitempty"`
+	Evaluations   int64                  `protobuf:"varint,5,opt,name=evaluations,proto3" json:"evaluations,omitempty"`
+	Result        *OptimizationReply     `protobuf:"bytes,6,opt,name=result,proto3" json:"result,omitempty"`
+	Error         string                 `protobuf:"bytes,7,opt,name=error,proto3" json:"error,omitempty"`
+	unknownFields protoimpl.UnknownFields
+	sizeCache     protoimpl.SizeCache
+}
+
+func (x *JobStatus) Reset() {
+	*x = JobStatus{}
+	mi := &file_optimizator_proto_msgTypes[7]
+	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+	ms.StoreMessageInfo(mi)
+}
+
+func (x *JobStatus) String() string {
+	return protoimpl.X.MessageStringOf(x)
+}
+
+func (*JobStatus) ProtoMessage() {}
+
+func (x *JobStatus) ProtoReflect() protoreflect.Message {
+	mi := &file_optimizator_proto_msgTypes[7]
+	if x != nil {
+		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+		if ms.LoadMessageInfo() == nil {
+			ms.StoreMessageInfo(mi)
+		}
+		return ms
+	}
+	return mi.MessageOf(x)
+}
+
+// Deprecated: Use JobStatus.ProtoReflect.Descriptor instead.
+func (*JobStatus) Descriptor() ([]byte, []int) {
+	return file_optimizator_proto_rawDescGZIP(), []int{7}
+}
+
+func (x *JobStatus) GetId() string {
+	if x != nil {
+		return x.Id
+	}
+	return ""
+}
+
+func (x *JobStatus) GetState() string {
+	if x != nil {
+		return x.State
+	}
+	return ""
+}
+
+func (x *JobStatus) GetIteration() int64 {
+	if x != nil {
+		return x.Iteration
+	}
+	return 0
+}
+
+func (x *JobStatus) GetBestValue() float64 {
+	if x != nil {
+		return x.BestValue
+	}
+	return 0
+}
+
+func (x *JobStatus) GetEvaluations() int64 {
+	if x != nil {
+		return x.Evaluations
+	}
+	return 0
+}
+
+func (x *JobStatus) GetResult() *OptimizationReply {
+	if x != nil {
+		return x.Result
+	}
+	return nil
+}
+
+func (x *JobStatus) GetError() string {
+	if x != nil {
+		return x.Error
+	}
+	return ""
+}
+
+// Задача острова: multi-start из его доли стартовых точек общей
+// последовательности (номера island, island + islands, ...)
+type IslandTask struct {
+	state         protoimpl.MessageState `protogen:"open.v1"`
+	Problem       *OptimizationRequest   `protobuf:"bytes,1,opt,name=problem,proto3" json:"problem,omitempty"`
+	Island        int32                  `protobuf:"varint,2,opt,name=island,proto3" json:"island,omitempty"`
+	Islands       int32                  `protobuf:"varint,3,opt,name=islands,proto3" json:"islands,omitempty"`
+	Starts        int32                  `protobuf:"varint,4,opt,name=starts,proto3" json:"starts,omitempty"`
+	Seed          uint64                 `protobuf:"varint,5,opt,name=seed,proto3" json:"seed,omitempty"`
+	Radius        float64                `protobuf:"fixed64,6,opt,name=radius,proto3" json:"radius,omitempty"`
+	unknownFields protoimpl.UnknownFields
+	sizeCache     protoimpl.SizeCache
+}
+
+func (x *IslandTask) Reset() {
+	*x = IslandTask{}
+	mi := &file_optimizator_proto_msgTypes[8]
+	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+	ms.StoreMessageInfo(mi)
+}
+
+func (x *IslandTask) String() string {
+	return protoimpl.X.MessageStringOf(x)
+}
+
+func (*IslandTask) ProtoMessage() {}
+
+func (x *IslandTask) ProtoReflect() protoreflect.Message {
+	mi := &file_optimizator_proto_msgTypes[8]
+	if x != nil {
+		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+		if ms.LoadMessageInfo() == nil {
+			ms.StoreMessageInfo(mi)
+		}
+		return ms
+	}
+	return mi.MessageOf(x)
+}
+
+// Deprecated: Use IslandTask.ProtoReflect.Descriptor instead.
+func (*IslandTask) Descriptor() ([]byte, []int) {
+	return file_optimizator_proto_rawDescGZIP(), []int{8}
+}
+
+func (x *IslandTask) GetProblem() *OptimizationRequest {
+	if x != nil {
+		return x.Problem
+	}
+	return nil
+}
+
+func (x *IslandTask) GetIsland() int32 {
+	if x != nil {
+		return x.Island
+	}
+	return 0
+}
+
+func (x *IslandTask) GetIslands() int32 {
+	if x != nil {
+		return x.Islands
+	}
+	return 0
+}
+
+func (x *IslandTask) GetStarts() int32 {
+	if x != nil {
+		return x.Starts
+	}
+	return 0
+}
+
+func (x *IslandTask) GetSeed() uint64 {
+	if x != nil {
+		return x.Seed
+	}
+	return 0
+}
+
+func (x *IslandTask) GetRadius() float64 {
+	if x != nil {
+		return x.Radius
+	}
+	return 0
+}
+
+// Точка с именами переменных: порядок переменных у экземпляров может различаться
+type IslandPoint struct {
+	state         protoimpl.MessageState `protogen:"open.v1"`
+	Names         []string               `protobuf:"bytes,1,rep,name=names,proto3" json:"names,omitempty"`
+	Point         []float64              `protobuf:"fixed64,2,rep,packed,name=point,proto3" json:"point,omitempty"`
+	Value         float64                `protobuf:"fixed64,3,opt,name=value,proto3" json:"value,omitempty"`
+	unknownFields protoimpl.UnknownFields
+	sizeCache     protoimpl.SizeCache
+}
+
+func (x *IslandPoint) Reset() {
+	*x = IslandPoint{}
+	mi := &file_optimizator_proto_msgTypes[9]
+	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+	ms.StoreMessageInfo(mi)
+}
+
+func (x *IslandPoint) String() string {
+	return protoimpl.X.MessageStringOf(x)
+}
+
+func (*IslandPoint) ProtoMessage() {}
+
+func (x *IslandPoint) ProtoReflect() protoreflect.Message {
+	mi := &file_optimizator_proto_msgTypes[9]
+	if x != nil {
+		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+		if ms.LoadMessageInfo() == nil {
+			ms.StoreMessageInfo(mi)
+		}
+		return ms
+	}
+	return mi.MessageOf(x)
+}
+
+// Deprecated: Use IslandPoint.ProtoReflect.Descriptor instead.
+func (*IslandPoint) Descriptor() ([]byte, []int) {
+	return file_optimizator_proto_rawDescGZIP(), []int{9}
+}
+
+func (x *IslandPoint) GetNames() []string {
+	if x != nil {
+		return x.Names
+	}
+	return nil
+}
+
+func (x *IslandPoint) GetPoint() []float64 {
+	if x != nil {
+		return x.Point
+	}
+	return nil
+}
+
+func (x *IslandPoint) GetValue() float64 {
+	if x != nil {
+		return x.Value
+	}
+	return 0
+}
+
+// Первое сообщение потока Island - task, следующие - migrant: лучшая
+// точка других островов
+type IslandMessage struct {
+	state         protoimpl.MessageState `protogen:"open.v1"`
+	Task          *IslandTask            `protobuf:"bytes,1,opt,name=task,proto3" json:"task,omitempty"`
+	Migrant       *IslandPoint           `protobuf:"bytes,2,opt,name=migrant,proto3" json:"migrant,omitempty"`
+	unknownFields protoimpl.UnknownFields
+	sizeCache     protoimpl.SizeCache
+}
+
+func (x *IslandMessage) Reset() {
+	*x = IslandMessage{}
+	mi := &file_optimizator_proto_msgTypes[10]
+	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+	ms.StoreMessageInfo(mi)
+}
+
+func (x *IslandMessage) String() string {
+	return protoimpl.X.MessageStringOf(x)
+}
+
+func (*IslandMessage) ProtoMessage() {}
+
+func (x *IslandMessage) ProtoReflect() protoreflect.Message {
+	mi := &file_optimizator_proto_msgTypes[10]
+	if x != nil {
+		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+		if ms.LoadMessageInfo() == nil {
+			ms.StoreMessageInfo(mi)
+		}
+		return ms
+	}
+	return mi.MessageOf(x)
+}
+
+// Deprecated: Use IslandMessage.ProtoReflect.Descriptor instead.
+func (*IslandMessage) Descriptor() ([]byte, []int) {
+	return file_optimizator_proto_rawDescGZIP(), []int{10}
+}
+
+func (x *IslandMessage) GetTask() *IslandTask {
+	if x != nil {
+		return x.Task
+	}
+	return nil
+}
+
+func (x *IslandMessage) GetMigrant() *IslandPoint {
+	if x != nil {
+		return x.Migrant
+	}
+	return nil
+}
+
+// Ход острова: лучшая точка его запусков; done - доля выполнена
+type IslandReport struct {
+	state         protoimpl.MessageState `protogen:"open.v1"`
+	Starts        int32                  `protobuf:"varint,1,opt,name=starts,proto3" json:"starts,omitempty"`
+	Best          *IslandPoint           `protobuf:"bytes,2,opt,name=best,proto3" json:"best,omitempty"`
+	Done          bool                   `protobuf:"varint,3,opt,name=done,proto3" json:"done,omitempty"`
+	unknownFields protoimpl.UnknownFields
+	sizeCache     protoimpl.SizeCache
+}
+
+func (x *IslandReport) Reset() {
+	*x = IslandReport{}
+	mi := &file_optimizator_proto_msgTypes[11]
+	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+	ms.StoreMessageInfo(mi)
+}
+
+func (x *IslandReport) String() string {
+	return protoimpl.X.MessageStringOf(x)
+}
+
+func (*IslandReport) ProtoMessage() {}
+
+func (x *IslandReport) ProtoReflect() protoreflect.Message {
+	mi := &file_optimizator_proto_msgTypes[11]
+	if x != nil {
+		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+		if ms.LoadMessageInfo() == nil {
+			ms.StoreMessageInfo(mi)
+		}
+		return ms
+	}
+	return mi.MessageOf(x)
+}
+
+// Deprecated: Use IslandReport.ProtoReflect.Descriptor instead.
+func (*IslandReport) Descriptor() ([]byte, []int) {
+	return file_optimizator_proto_rawDescGZIP(), []int{11}
+}
+
+func (x *IslandReport) GetStarts() int32 {
+	if x != nil {
+		return x.Starts
+	}
+	return 0
+}
+
+func (x *IslandReport) GetBest() *IslandPoint {
+	if x != nil {
+		return x.Best
+	}
+	return nil
+}
+
+func (x *IslandReport) GetDone() bool {
+	if x != nil {
+		return x.Done
+	}
+	return false
+}
+
 var File_optimizator_proto protoreflect.FileDescriptor
 
 const file_optimizator_proto_rawDesc = "" +
@@ -200,10 +782,58 @@ const file_optimizator_proto_rawDesc = "" +
 	"\x05value\x18\x02 \x01(\x03R\x05value\"m\n" +
 	"\x11OptimizationReply\x122\n" +
 	"\bVariable\x18\x01 \x03(\v2\x16.optimization.VariableR\bVariable\x12$\n" +
-	"\rfunctionValue\x18\x02 \x01(\x01R\rfunctionValue2\x9e\x01\n" +
+	"\rfunctionValue\x18\x02 \x01(\x01R\rfunctionValue\"\xc5\x01\n" +
+	"\x14OptimizationProgress\x12\x1c\n" +
+	"\titeration\x18\x01 \x01(\x03R\titeration\x12\x1c\n" +
+	"\tbestValue\x18\x02 \x01(\x01R\tbestValue\x12\x16\n" +
+	"\x06spread\x18\x03 \x01(\x01R\x06spread\x12 \n" +
+	"\vevaluations\x18\x04 \x01(\x03R\vevaluations\x127\n" +
+	"\x06result\x18\x05 \x01(\v2\x1f.optimization.OptimizationReplyR\x06result\"M\n" +
+	"\fBatchRequest\x12=\n" +
+	"\bproblems\x18\x01 \x03(\v2!.optimization.OptimizationRequestR\bproblems\"p\n" +
+	"\vBatchResult\x12\x14\n" +
+	"\x05index\x18\x01 \x01(\x05R\x05index\x125\n" +
+	"\x05reply\x18\x02 \x01(\v2\x1f.optimization.OptimizationReplyR\x05reply\x12\x14\n" +
+	"\x05error\x18\x03 \x01(\tR\x05error\"\x1c\n" +
+	"\n" +
+	"JobRequest\x12\x0e\n" +
+	"\x02id\x18\x01 \x01(\tR\x02id\"\xde\x01\n" +
+	"\tJobStatus\x12\x0e\n" +
+	"\x02id\x18\x01 \x01(\tR\x02id\x12\x14\n" +
+	"\x05state\x18\x02 \x01(\tR\x05state\x12\x1c\n" +
+	"\titeration\x18\x03 \x01(\x03R\titeration\x12\x1c\n" +
+	"\tbestValue\x18\x04 \x01(\x01R\tbestValue\x12 \n" +
+	"\vevaluations\x18\x05 \x01(\x03R\vevaluations\x127\n" +
+	"\x06result\x18\x06 \x01(\v2\x1f.optimization.OptimizationReplyR\x06result\x12\x14\n" +
+	"\x05error\x18\a \x01(\tR\x05error\"\xbf\x01\n" +
+	"\n" +
+	"IslandTask\x12;\n" +
+	"\aproblem\x18\x01 \x01(\v2!.optimization.OptimizationRequestR\aproblem\x12\x16\n" +
+	"\x06island\x18\x02 \x01(\x05R\x06island\x12\x18\n" +
+	"\aislands\x18\x03 \x01(\x05R\aislands\x12\x16\n" +
+	"\x06starts\x18\x04 \x01(\x05R\x06starts\x12\x12\n" +
+	"\x04seed\x18\x05 \x01(\x04R\x04seed\x12\x16\n" +
+	"\x06radius\x18\x06 \x01(\x01R\x06radius\"O\n" +
+	"\vIslandPoint\x12\x14\n" +
+	"\x05names\x18\x01 \x03(\tR\x05names\x12\x14\n" +
+	"\x05point\x18\x02 \x03(\x01R\x05point\x12\x14\n" +
+	"\x05value\x18\x03 \x01(\x01R\x05value\"r\n" +
+	"\rIslandMessage\x12,\n" +
+	"\x04task\x18\x01 \x01(\v2\x18.optimization.IslandTaskR\x04task\x123\n" +
+	"\amigrant\x18\x02 \x01(\v2\x19.optimization.IslandPointR\amigrant\"i\n" +
+	"\fIslandReport\x12\x16\n" +
+	"\x06starts\x18\x01 \x01(\x05R\x06starts\x12-\n" +
+	"\x04best\x18\x02 \x01(\v2\x19.optimization.IslandPointR\x04best\x12\x12\n" +
+	"\x04done\x18\x03 \x01(\bR\x04done2\xe0\x04\n" +
 	"\fOptimization\x128\n" +
 	"\x04Ping\x12\x16.google.protobuf.Empty\x1a\x16.google.protobuf.Empty\"\x00\x12T\n" +
-	"\fOptimization\x12!.optimization.OptimizationRequest\x1a\x1f.optimization.OptimizationReply\"\x00B\x04Z\x02./b\x06proto3"
+	"\fOptimization\x12!.optimization.OptimizationRequest\x1a\x1f.optimization.OptimizationReply\"\x00\x12_\n" +
+	"\x12OptimizationStream\x12!.optimization.OptimizationRequest\x1a\".optimization.OptimizationProgress\"\x000\x01\x12J\n" +
+	"\rOptimizeBatch\x12\x1a.optimization.BatchRequest\x1a\x19.optimization.BatchResult\"\x000\x01\x12I\n" +
+	"\tSubmitJob\x12!.optimization.OptimizationRequest\x1a\x17.optimization.JobStatus\"\x00\x12=\n" +
+	"\x06GetJob\x12\x18.optimization.JobRequest\x1a\x17.optimization.JobStatus\"\x00\x12@\n" +
+	"\tCancelJob\x12\x18.optimization.JobRequest\x1a\x17.optimization.JobStatus\"\x00\x12G\n" +
+	"\x06Island\x12\x1b.optimization.IslandMessage\x1a\x1a.optimization.IslandReport\"\x00(\x010\x01B\x04Z\x02./b\x06proto3"
 
 var (
 	file_optimizator_proto_rawDescOnce sync.Once
@@ -217,24 +847,53 @@ func file_optimizator_proto_rawDescGZIP() []byte {
 	return file_optimizator_proto_rawDescData
 }
 
-var file_optimizator_proto_msgTypes = make([]protoimpl.MessageInfo, 3)
+var file_optimizator_proto_msgTypes = make([]protoimpl.MessageInfo, 12)
 var file_optimizator_proto_goTypes = []any{
-	(*OptimizationRequest)(nil), // 0: optimization.OptimizationRequest
-	(*Variable)(nil),            // 1: optimization.Variable
-	(*OptimizationReply)(nil),   // 2: optimization.OptimizationReply
-	(*emptypb.Empty)(nil),       // 3: google.protobuf.Empty
+	(*OptimizationRequest)(nil),  // 0: optimization.OptimizationRequest
+	(*Variable)(nil),             // 1: optimization.Variable
+	(*OptimizationReply)(nil),    // 2: optimization.OptimizationReply
+	(*OptimizationProgress)(nil), // 3: optimization.OptimizationProgress
+	(*BatchRequest)(nil),         // 4: optimization.BatchRequest
+	(*BatchResult)(nil),          // 5: optimization.BatchResult
+	(*JobRequest)(nil),           // 6: optimization.JobRequest
+	(*JobStatus)(nil),            // 7: optimization.JobStatus
+	(*IslandTask)(nil),           // 8: optimization.IslandTask
+	(*IslandPoint)(nil),          // 9: optimization.IslandPoint
+	(*IslandMessage)(nil),        // 10: optimization.IslandMessage
+	(*IslandReport)(nil),         // 11: optimization.IslandReport
+	(*emptypb.Empty)(nil),        // 12: google.protobuf.Empty
 }
 var file_optimizator_proto_depIdxs = []int32{
-	1, // 0: optimization.OptimizationReply.Variable:type_name -> optimization.Variable
-	3, // 1: optimization.Optimization.Ping:input_type -> google.protobuf.Empty
-	0, // 2: optimization.Optimization.Optimization:input_type -> optimization.OptimizationRequest
-	3, // 3: optimization.Optimization.Ping:output_type -> google.protobuf.Empty
-	2, // 4: optimization.Optimization.Optimization:output_type -> optimization.OptimizationReply
-	3, // [3:5] is the sub-list for method output_type
-	1, // [1:3] is the sub-list for method input_type
-	1, // [1:1] is the sub-list for extension type_name
-	1, // [1:1] is the sub-list for extension extendee
-	0, // [0:1] is the sub-list for field type_name
+	1,  // 0: optimization.OptimizationReply.Variable:type_name -> optimization.Variable
+	2,  // 1: optimization.OptimizationProgress.result:type_name -> optimization.OptimizationReply
+	0,  // 2: optimization.BatchRequest.problems:type_name -> optimization.OptimizationRequest
+	2,  // 3: optimization.BatchResult.reply:type_name -> optimization.OptimizationReply
+	2,  // 4: optimization.JobStatus.result:type_name -> optimization.OptimizationReply
+	0,  // 5: optimization.IslandTask.problem:type_name -> optimization.OptimizationRequest
+	8,  // 6: optimization.IslandMessage.task:type_name -> optimization.IslandTask
+	9,  // 7: optimization.IslandMessage.migrant:type_name -> optimization.IslandPoint
+	9,  // 8: optimization.IslandReport.best:type_name -> optimization.IslandPoint
+	12, // 9: optimization.Optimization.Ping:input_type -> google.protobuf.Empty
+	0,  // 10: optimization.Optimization.Optimization:input_type -> optimization.OptimizationRequest
+	0,  // 11: optimization.Optimization.OptimizationStream:input_type -> optimization.OptimizationRequest
+	4,  // 12: optimization.Optimization.OptimizeBatch:input_type -> optimization.BatchRequest
+	0,  // 13: optimization.Optimization.SubmitJob:input_type -> optimization.OptimizationRequest
+	6,  // 14: optimization.Optimization.GetJob:input_type -> optimization.JobRequest
+	6,  // 15: optimization.Optimization.CancelJob:input_type -> optimization.JobRequest
+	10, // 16: optimization.Optimization.Island:input_type -> optimization.IslandMessage
+	12, // 17: optimization.Optimization.Ping:output_type -> google.protobuf.Empty
+	2,  // 18: optimization.Optimization.Optimization:output_type -> optimization.OptimizationReply
+	3,  // 19: optimization.Optimization.OptimizationStream:output_type -> optimization.OptimizationProgress
+	5,  // 20: optimization.Optimization.OptimizeBatch:output_type -> optimization.BatchResult
+	7,  // 21: optimization.Optimization.SubmitJob:output_type -> optimization.JobStatus
+	7,  // 22: optimization.Optimization.GetJob:output_type -> optimization.JobStatus
+	7,  // 23: optimization.Optimization.CancelJob:output_type -> optimization.JobStatus
+	11, // 24: optimization.Optimization.Island:output_type -> optimization.IslandReport
+	17, // [17:25] is the sub-list for method output_type
+	9,  // [9:17] is the sub-list for method input_type
+	9,  // [9:9] is the sub-list for extension type_name
+	9,  // [9:9] is the sub-list for extension extendee
+	0,  // [0:9] is the sub-list for field type_name
 }
 
 func init() { file_optimizator_proto_init() }
@@ -248,7 +907,7 @@ func file_optimizator_proto_init() {
 			GoPackagePath: reflect.TypeOf(x{}).PkgPath(),
 			RawDescriptor: unsafe.Slice(unsafe.StringData(file_optimizator_proto_rawDesc), len(file_optimizator_proto_rawDesc)),
 			NumEnums:      0,
-			NumMessages:   3,
+			NumMessages:   12,
 			NumExtensions: 0,
 			NumServices:   1,
 		},
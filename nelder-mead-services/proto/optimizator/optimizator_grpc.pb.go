@@ -20,8 +20,14 @@ import (
 const _ = grpc.SupportPackageIsVersion9
 
 const (
-	Optimization_Ping_FullMethodName         = "/optimization.Optimization/Ping"
-	Optimization_Optimization_FullMethodName = "/optimization.Optimization/Optimization"
+	Optimization_Ping_FullMethodName               = "/optimization.Optimization/Ping"
+	Optimization_Optimization_FullMethodName       = "/optimization.Optimization/Optimization"
+	Optimization_OptimizationStream_FullMethodName = "/optimization.Optimization/OptimizationStream"
+	Optimization_OptimizeBatch_FullMethodName      = "/optimization.Optimization/OptimizeBatch"
+	Optimization_SubmitJob_FullMethodName          = "/optimization.Optimization/SubmitJob"
+	Optimization_GetJob_FullMethodName             = "/optimization.Optimization/GetJob"
+	Optimization_CancelJob_FullMethodName          = "/optimization.Optimization/CancelJob"
+	Optimization_Island_FullMethodName             = "/optimization.Optimization/Island"
 )
 
 // OptimizationClient is the client API for Optimization service.
@@ -30,6 +36,12 @@ const (
 type OptimizationClient interface {
 	Ping(ctx context.Context, in *emptypb.Empty, opts ...grpc.CallOption) (*emptypb.Empty, error)
 	Optimization(ctx context.Context, in *OptimizationRequest, opts ...grpc.CallOption) (*OptimizationReply, error)
+	OptimizationStream(ctx context.Context, in *OptimizationRequest, opts ...grpc.CallOption) (grpc.ServerStreamingClient[OptimizationProgress], error)
+	OptimizeBatch(ctx context.Context, in *BatchRequest, opts ...grpc.CallOption) (grpc.ServerStreamingClient[BatchResult], error)
+	SubmitJob(ctx context.Context, in *OptimizationRequest, opts ...grpc.CallOption) (*JobStatus, error)
+	GetJob(ctx context.Context, in *JobRequest, opts ...grpc.CallOption) (*JobStatus, error)
+	CancelJob(ctx context.Context, in *JobRequest, opts ...grpc.CallOption) (*JobStatus, error)
+	Island(ctx context.Context, opts ...grpc.CallOption) (grpc.BidiStreamingClient[IslandMessage, IslandReport], error)
 }
 
 type optimizationClient struct {
@@ -60,12 +72,99 @@ func (c *optimizationClient) Optimization(ctx context.Context, in *OptimizationR
 	return out, nil
 }
 
+func (c *optimizationClient) OptimizationStream(ctx context.Context, in *OptimizationRequest, opts ...grpc.CallOption) (grpc.ServerStreamingClient[OptimizationProgress], error) {
+	cOpts := append([]grpc.CallOption{grpc.StaticMethod()}, opts...)
+	stream, err := c.cc.NewStream(ctx, &Optimization_ServiceDesc.Streams[0], Optimization_OptimizationStream_FullMethodName, cOpts...)
+	if err != nil {
+		return nil, err
+	}
+	x := &grpc.GenericClientStream[OptimizationRequest, OptimizationProgress]{ClientStream: stream}
+	if err := x.ClientStream.SendMsg(in); err != nil {
+		return nil, err
+	}
+	if err := x.ClientStream.CloseSend(); err != nil {
+		return nil, err
+	}
+	return x, nil
+}
+
+// This type alias is provided for backwards compatibility with existing code that references the prior non-generic stream type by name.
+type Optimization_OptimizationStreamClient = grpc.ServerStreamingClient[OptimizationProgress]
+
+func (c *optimizationClient) OptimizeBatch(ctx context.Context, in *BatchRequest, opts ...grpc.CallOption) (grpc.ServerStreamingClient[BatchResult], error) {
+	cOpts := append([]grpc.CallOption{grpc.StaticMethod()}, opts...)
+	stream, err := c.cc.NewStream(ctx, &Optimization_ServiceDesc.Streams[1], Optimization_OptimizeBatch_FullMethodName, cOpts...)
+	if err != nil {
+		return nil, err
+	}
+	x := &grpc.GenericClientStream[BatchRequest, BatchResult]{ClientStream: stream}
+	if err := x.ClientStream.SendMsg(in); err != nil {
+		return nil, err
+	}
+	if err := x.ClientStream.CloseSend(); err != nil {
+		return nil, err
+	}
+	return x, nil
+}
+
+// This type alias is provided for backwards compatibility with existing code that references the prior non-generic stream type by name.
+type Optimization_OptimizeBatchClient = grpc.ServerStreamingClient[BatchResult]
+
+func (c *optimizationClient) SubmitJob(ctx context.Context, in *OptimizationRequest, opts ...grpc.CallOption) (*JobStatus, error) {
+	cOpts := append([]grpc.CallOption{grpc.StaticMethod()}, opts...)
+	out := new(JobStatus)
+	err := c.cc.Invoke(ctx, Optimization_SubmitJob_FullMethodName, in, out, cOpts...)
+	if err != nil {
+		return nil, err
+	}
+	return out, nil
+}
+
+func (c *optimizationClient) GetJob(ctx context.Context, in *JobRequest, opts ...grpc.CallOption) (*JobStatus, error) {
+	cOpts := append([]grpc.CallOption{grpc.StaticMethod()}, opts...)
+	out := new(JobStatus)
+	err := c.cc.Invoke(ctx, Optimization_GetJob_FullMethodName, in, out, cOpts...)
+	if err != nil {
+		return nil, err
+	}
+	return out, nil
+}
+
+func (c *optimizationClient) CancelJob(ctx context.Context, in *JobRequest, opts ...grpc.CallOption) (*JobStatus, error) {
+	cOpts := append([]grpc.CallOption{grpc.StaticMethod()}, opts...)
+	out := new(JobStatus)
+	err := c.cc.Invoke(ctx, Optimization_CancelJob_FullMethodName, in, out, cOpts...)
+	if err != nil {
+		return nil, err
+	}
+	return out, nil
+}
+
+func (c *optimizationClient) Island(ctx context.Context, opts ...grpc.CallOption) (grpc.BidiStreamingClient[IslandMessage, IslandReport], error) {
+	cOpts := append([]grpc.CallOption{grpc.StaticMethod()}, opts...)
+	stream, err := c.cc.NewStream(ctx, &Optimization_ServiceDesc.Streams[2], Optimization_Island_FullMethodName, cOpts...)
+	if err != nil {
+		return nil, err
+	}
+	x := &grpc.GenericClientStream[IslandMessage, IslandReport]{ClientStream: stream}
+	return x, nil
+}
+
+// This type alias is provided for backwards compatibility with existing code that references the prior non-generic stream type by name.
+type Optimization_IslandClient = grpc.BidiStreamingClient[IslandMessage, IslandReport]
+
 // OptimizationServer is the server API for Optimization service.
 // All implementations must embed UnimplementedOptimizationServer
 // for forward compatibility.
 type OptimizationServer interface {
 	Ping(context.Context, *emptypb.Empty) (*emptypb.Empty, error)
 	Optimization(context.Context, *OptimizationRequest) (*OptimizationReply, error)
+	OptimizationStream(*OptimizationRequest, grpc.ServerStreamingServer[OptimizationProgress]) error
+	OptimizeBatch(*BatchRequest, grpc.ServerStreamingServer[BatchResult]) error
+	SubmitJob(context.Context, *OptimizationRequest) (*JobStatus, error)
+	GetJob(context.Context, *JobRequest) (*JobStatus, error)
+	CancelJob(context.Context, *JobRequest) (*JobStatus, error)
+	Island(grpc.BidiStreamingServer[IslandMessage, IslandReport]) error
 	mustEmbedUnimplementedOptimizationServer()
 }
 
@@ -82,6 +181,24 @@ func (UnimplementedOptimizationServer) Ping(context.Context, *emptypb.Empty) (*e
 func (UnimplementedOptimizationServer) Optimization(context.Context, *OptimizationRequest) (*OptimizationReply, error) {
 	return nil, status.Errorf(codes.Unimplemented, "method Optimization not implemented")
 }
+func (UnimplementedOptimizationServer) OptimizationStream(*OptimizationRequest, grpc.ServerStreamingServer[OptimizationProgress]) error {
+	return status.Errorf(codes.Unimplemented, "method OptimizationStream not implemented")
+}
+func (UnimplementedOptimizationServer) OptimizeBatch(*BatchRequest, grpc.ServerStreamingServer[BatchResult]) error {
+	return status.Errorf(codes.Unimplemented, "method OptimizeBatch not implemented")
+}
+func (UnimplementedOptimizationServer) SubmitJob(context.Context, *OptimizationRequest) (*JobStatus, error) {
+	return nil, status.Errorf(codes.Unimplemented, "method SubmitJob not implemented")
+}
+func (UnimplementedOptimizationServer) GetJob(context.Context, *JobRequest) (*JobStatus, error) {
+	return nil, status.Errorf(codes.Unimplemented, "method GetJob not implemented")
+}
+func (UnimplementedOptimizationServer) CancelJob(context.Context, *JobRequest) (*JobStatus, error) {
+	return nil, status.Errorf(codes.Unimplemented, "method CancelJob not implemented")
+}
+func (UnimplementedOptimizationServer) Island(grpc.BidiStreamingServer[IslandMessage, IslandReport]) error {
+	return status.Errorf(codes.Unimplemented, "method Island not implemented")
+}
 func (UnimplementedOptimizationServer) mustEmbedUnimplementedOptimizationServer() {}
 func (UnimplementedOptimizationServer) testEmbeddedByValue()                      {}
 
@@ -139,6 +256,89 @@ func _Optimization_Optimization_Handler(srv interface{}, ctx context.Context, de
 	return interceptor(ctx, in, info, handler)
 }
 
+func _Optimization_OptimizationStream_Handler(srv interface{}, stream grpc.ServerStream) error {
+	m := new(OptimizationRequest)
+	if err := stream.RecvMsg(m); err != nil {
+		return err
+	}
+	return srv.(OptimizationServer).OptimizationStream(m, &grpc.GenericServerStream[OptimizationRequest, OptimizationProgress]{ServerStream: stream})
+}
+
+// This type alias is provided for backwards compatibility with existing code that references the prior non-generic stream type by name.
+type Optimization_OptimizationStreamServer = grpc.ServerStreamingServer[OptimizationProgress]
+
+func _Optimization_OptimizeBatch_Handler(srv interface{}, stream grpc.ServerStream) error {
+	m := new(BatchRequest)
+	if err := stream.RecvMsg(m); err != nil {
+		return err
+	}
+	return srv.(OptimizationServer).OptimizeBatch(m, &grpc.GenericServerStream[BatchRequest, BatchResult]{ServerStream: stream})
+}
+
+// This type alias is provided for backwards compatibility with existing code that references the prior non-generic stream type by name.
+type Optimization_OptimizeBatchServer = grpc.ServerStreamingServer[BatchResult]
+
+func _Optimization_SubmitJob_Handler(srv interface{}, ctx context.Context, dec func(interface{}) error, interceptor grpc.UnaryServerInterceptor) (interface{}, error) {
+	in := new(OptimizationRequest)
+	if err := dec(in); err != nil {
+		return nil, err
+	}
+	if interceptor == nil {
+		return srv.(OptimizationServer).SubmitJob(ctx, in)
+	}
+	info := &grpc.UnaryServerInfo{
+		Server:     srv,
+		FullMethod: Optimization_SubmitJob_FullMethodName,
+	}
+	handler := func(ctx context.Context, req interface{}) (interface{}, error) {
+		return srv.(OptimizationServer).SubmitJob(ctx, req.(*OptimizationRequest))
+	}
+	return interceptor(ctx, in, info, handler)
+}
+
+func _Optimization_GetJob_Handler(srv interface{}, ctx context.Context, dec func(interface{}) error, interceptor grpc.UnaryServerInterceptor) (interface{}, error) {
+	in := new(JobRequest)
+	if err := dec(in); err != nil {
+		return nil, err
+	}
+	if interceptor == nil {
+		return srv.(OptimizationServer).GetJob(ctx, in)
+	}
+	info := &grpc.UnaryServerInfo{
+		Server:     srv,
+		FullMethod: Optimization_GetJob_FullMethodName,
+	}
+	handler := func(ctx context.Context, req interface{}) (interface{}, error) {
+		return srv.(OptimizationServer).GetJob(ctx, req.(*JobRequest))
+	}
+	return interceptor(ctx, in, info, handler)
+}
+
+func _Optimization_CancelJob_Handler(srv interface{}, ctx context.Context, dec func(interface{}) error, interceptor grpc.UnaryServerInterceptor) (interface{}, error) {
+	in := new(JobRequest)
+	if err := dec(in); err != nil {
+		return nil, err
+	}
+	if interceptor == nil {
+		return srv.(OptimizationServer).CancelJob(ctx, in)
+	}
+	info := &grpc.UnaryServerInfo{
+		Server:     srv,
+		FullMethod: Optimization_CancelJob_FullMethodName,
+	}
+	handler := func(ctx context.Context, req interface{}) (interface{}, error) {
+		return srv.(OptimizationServer).CancelJob(ctx, req.(*JobRequest))
+	}
+	return interceptor(ctx, in, info, handler)
+}
+
+func _Optimization_Island_Handler(srv interface{}, stream grpc.ServerStream) error {
+	return srv.(OptimizationServer).Island(&grpc.GenericServerStream[IslandMessage, IslandReport]{ServerStream: stream})
+}
+
+// This type alias is provided for backwards compatibility with existing code that references the prior non-generic stream type by name.
+type Optimization_IslandServer = grpc.BidiStreamingServer[IslandMessage, IslandReport]
+
 // Optimization_ServiceDesc is the grpc.ServiceDesc for Optimization service.
 // It's only intended for direct use with grpc.RegisterService,
 // and not to be introspected or modified (even as a copy)
@@ -154,7 +354,36 @@ var Optimization_ServiceDesc = grpc.ServiceDesc{
 			MethodName: "Optimization",
 			Handler:    _Optimization_Optimization_Handler,
 		},
+		{
+			MethodName: "SubmitJob",
+			Handler:    _Optimization_SubmitJob_Handler,
+		},
+		{
+			MethodName: "GetJob",
+			Handler:    _Optimization_GetJob_Handler,
+		},
+		{
+			MethodName: "CancelJob",
+			Handler:    _Optimization_CancelJob_Handler,
+		},
+	},
+	Streams: []grpc.StreamDesc{
+		{
+			StreamName:    "OptimizationStream",
+			Handler:       _Optimization_OptimizationStream_Handler,
+			ServerStreams: true,
+		},
+		{
+			StreamName:    "OptimizeBatch",
+			Handler:       _Optimization_OptimizeBatch_Handler,
+			ServerStreams: true,
+		},
+		{
+			StreamName:    "Island",
+			Handler:       _Optimization_Island_Handler,
+			ServerStreams: true,
+			ClientStreams: true,
+		},
 	},
-	Streams:  []grpc.StreamDesc{},
 	Metadata: "optimizator.proto",
 }
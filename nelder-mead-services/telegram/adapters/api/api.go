@@ -2,9 +2,11 @@ package api
 
 import (
 	"awesomeProject2/telegram/core"
+	"bytes"
 	"context"
 	"encoding/json"
 	"fmt"
+	"io"
 	"log/slog"
 	"net/http"
 	"net/url"
@@ -59,3 +61,48 @@ func (c *APIClient) Optimization(ctx context.Context, function string, tolerance
 
 	return result, nil
 }
+
+func (c *APIClient) SubmitJob(ctx context.Context, function string, tolerance float64, iter int) (core.Job, error) {
+	body, err := json.Marshal(map[string]any{"function": function, "tolerance": tolerance, "iter": iter})
+	if err != nil {
+		return core.Job{}, err
+	}
+	return c.doJob(ctx, http.MethodPost, "/api/jobs", bytes.NewReader(body), http.StatusAccepted)
+}
+
+func (c *APIClient) Job(ctx context.Context, id string) (core.Job, error) {
+	return c.doJob(ctx, http.MethodGet, "/api/jobs/"+url.PathEscape(id), nil, http.StatusOK)
+}
+
+func (c *APIClient) CancelJob(ctx context.Context, id string) (core.Job, error) {
+	return c.doJob(ctx, http.MethodDelete, "/api/jobs/"+url.PathEscape(id), nil, http.StatusOK)
+}
+
+func (c *APIClient) doJob(ctx context.Context, method, path string, body io.Reader, expected int) (core.Job, error) {
+	req, err := http.NewRequestWithContext(ctx, method, c.baseURL+path, body)
+	if err != nil {
+		return core.Job{}, fmt.Errorf("create request failed: %w", err)
+	}
+	if body != nil {
+		req.Header.Set("Content-Type", "application/json")
+	}
+
+	resp, err := c.httpClient.Do(req)
+	if err != nil {
+		return core.Job{}, fmt.Errorf("API request failed: %w", err)
+	}
+	defer resp.Body.Close()
+
+	if resp.StatusCode == http.StatusNotFound {
+		return core.Job{}, core.ErrJobNotFound
+	}
+	if resp.StatusCode != expected {
+		return core.Job{}, fmt.Errorf("unexpected status code: %d", resp.StatusCode)
+	}
+
+	var job core.Job
+	if err := json.NewDecoder(resp.Body).Decode(&job); err != nil {
+		return core.Job{}, fmt.Errorf("decode response failed: %w", err)
+	}
+	return job, nil
+}
@@ -1,9 +1,19 @@
 package rest
 
-const msgHelp = `Я умею находить оптимум у функций с помощью метода Нелдера-Мида`
+const msgHelp = `Я умею находить оптимум у функций с помощью метода Нелдера-Мида
+
+/opt - новая задача, результат придет сообщением
+/cancel - отменить выполняемую задачу`
 
 const msgHello = "Привет! 👾\n\n" + msgHelp
 
 const (
 	msgUnknownCommand = "Непонятная команда 🤔"
+	msgJobAccepted    = "Задача принята, пришлю результат, когда он будет готов ⏳"
+	msgJobBusy        = "Предыдущая задача еще выполняется, дождитесь ее или отмените: /cancel"
+	msgJobCancelling  = "Отменяю задачу..."
+	msgNoJob          = "Нет выполняемой задачи"
+	msgJobCancelled   = "Задача отменена"
+	msgJobFailed      = "Не удалось найти оптимум: "
+	msgJobLost        = "Задача потеряна сервисом оптимизации, отправьте ее заново: /opt"
 )
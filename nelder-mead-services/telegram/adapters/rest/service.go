@@ -3,33 +3,76 @@ package rest
 import (
 	"awesomeProject2/telegram/core"
 	"context"
+	"errors"
 	"fmt"
 	"log/slog"
 	"strconv"
 	"strings"
 	"sync"
+	"time"
 )
 
+// firstPoll - задержка первого опроса задачи, дальше интервал удваивается
+// до pollInterval: короткие задачи отвечают быстро, долгие не нагружают API
+const firstPoll = 200 * time.Millisecond
+
+// Handler ведет диалоги чатов. Оптимизация не выполняется в обработчике:
+// задача отправляется в API фоновой, результат приходит отдельным сообщением,
+// так что медленная задача одного чата не задерживает остальные.
 type Handler struct {
-	apiClient  core.APIClient
-	tgClint    core.TelegramClient
-	userStates map[int64]*core.UserState
-	stateMu    sync.RWMutex
-	log        *slog.Logger
+	apiClient    core.APIClient
+	tgClint      core.TelegramClient
+	chats        map[int64]*chat
+	chatsMu      sync.Mutex
+	pollInterval time.Duration
+	log          *slog.Logger
+}
+
+// chat - состояние одного чата под собственной блокировкой
+type chat struct {
+	mu    sync.Mutex
+	state *core.UserState // Диалог ввода задачи, nil - нет
+	job   string          // Выполняемая задача, "" - нет
+}
+
+func New(apiClient core.APIClient, tgClient core.TelegramClient, logger *slog.Logger, pollInterval time.Duration) *Handler {
+	return &Handler{
+		apiClient:    apiClient,
+		tgClint:      tgClient,
+		chats:        make(map[int64]*chat),
+		pollInterval: max(pollInterval, firstPoll),
+		log:          logger,
+	}
 }
 
-func New(apiClient core.APIClient, tgClient core.TelegramClient, logger *slog.Logger) *Handler {
-	return &Handler{apiClient: apiClient, tgClint: tgClient, log: logger}
+func (h *Handler) chat(chatID int64) *chat {
+	h.chatsMu.Lock()
+	defer h.chatsMu.Unlock()
+	c, ok := h.chats[chatID]
+	if !ok {
+		c = &chat{}
+		h.chats[chatID] = c
+	}
+	return c
 }
 
 func (h *Handler) HandleCommand(ctx context.Context, cmd string, chatID int64) error {
 	switch cmd {
 	case "/opt":
-		h.stateMu.Lock()
-		h.userStates[chatID] = &core.UserState{Step: "function"}
-		h.stateMu.Unlock()
+		c := h.chat(chatID)
+		c.mu.Lock()
+		busy := c.job != ""
+		if !busy {
+			c.state = &core.UserState{Step: "function"}
+		}
+		c.mu.Unlock()
+		if busy {
+			return h.tgClint.SendMessage(ctx, chatID, msgJobBusy)
+		}
 
 		return h.tgClint.SendMessage(ctx, chatID, "Введите вашу функцию")
+	case "/cancel":
+		return h.cancelJob(ctx, chatID)
 	case "/help":
 		return h.sendHelp(ctx, chatID)
 	case "/start":
@@ -40,11 +83,12 @@ func (h *Handler) HandleCommand(ctx context.Context, cmd string, chatID int64) e
 }
 
 func (h *Handler) HandleRegularMessage(ctx context.Context, text string, chatID int64) error {
-	h.stateMu.Lock()
-	defer h.stateMu.Unlock()
+	c := h.chat(chatID)
+	c.mu.Lock()
+	defer c.mu.Unlock()
 
-	state, exists := h.userStates[chatID]
-	if !exists {
+	state := c.state
+	if state == nil {
 		return h.sendUnknownCommand(ctx, chatID)
 	}
 
@@ -75,18 +119,90 @@ func (h *Handler) HandleRegularMessage(ctx context.Context, text string, chatID
 			return h.tgClint.SendMessage(ctx, chatID, "Введите число больше 0")
 		}
 		state.Iter = iter
-		defer delete(h.userStates, chatID)
+		c.state = nil
+		if c.job != "" {
+			return h.tgClint.SendMessage(ctx, chatID, msgJobBusy)
+		}
 
-		results, err := h.apiClient.Optimization(ctx, state.Function, state.Tolerance, state.Iter)
+		job, err := h.apiClient.SubmitJob(ctx, state.Function, state.Tolerance, state.Iter)
 		if err != nil {
-			return fmt.Errorf("search failed: %w", err)
+			return fmt.Errorf("job submission failed: %w", err)
 		}
-		return h.sendOptimizationResults(ctx, chatID, results)
+		c.job = job.ID
+		go h.awaitJob(ctx, chatID, c, job.ID)
+		return h.tgClint.SendMessage(ctx, chatID, msgJobAccepted)
 	default:
 		return h.sendUnknownCommand(ctx, chatID)
 
 	}
 }
+
+func (h *Handler) cancelJob(ctx context.Context, chatID int64) error {
+	c := h.chat(chatID)
+	c.mu.Lock()
+	id := c.job
+	c.mu.Unlock()
+	if id == "" {
+		return h.tgClint.SendMessage(ctx, chatID, msgNoJob)
+	}
+	// Итог отмены сообщит awaitJob
+	if _, err := h.apiClient.CancelJob(ctx, id); err != nil && !errors.Is(err, core.ErrJobNotFound) {
+		return fmt.Errorf("job cancellation failed: %w", err)
+	}
+	return h.tgClint.SendMessage(ctx, chatID, msgJobCancelling)
+}
+
+// awaitJob опрашивает задачу до завершения и отправляет результат в чат.
+// Ошибки опроса повторяются: задача переживает перезапуск сервисов.
+func (h *Handler) awaitJob(ctx context.Context, chatID int64, c *chat, id string) {
+	delay := firstPoll
+	var job core.Job
+	for {
+		select {
+		case <-ctx.Done():
+			return
+		case <-time.After(delay):
+		}
+		delay = min(2*delay, h.pollInterval)
+
+		var err error
+		job, err = h.apiClient.Job(ctx, id)
+		if errors.Is(err, core.ErrJobNotFound) {
+			break
+		}
+		if err != nil {
+			h.log.Error("job poll failed", "job", id, "error", err)
+			continue
+		}
+		if job.Finished() {
+			break
+		}
+	}
+
+	c.mu.Lock()
+	if c.job == id {
+		c.job = ""
+	}
+	c.mu.Unlock()
+
+	var err error
+	switch {
+	case job.State == "done" && job.Result != nil:
+		err = h.sendOptimizationResults(ctx, chatID, *job.Result)
+	case job.State == "cancelled" && job.Result != nil:
+		err = h.tgClint.SendMessage(ctx, chatID, msgJobCancelled+", лучшая найденная точка:\n"+formatResultsHTML(*job.Result))
+	case job.State == "cancelled":
+		err = h.tgClint.SendMessage(ctx, chatID, msgJobCancelled)
+	case job.State == "failed":
+		err = h.tgClint.SendMessage(ctx, chatID, msgJobFailed+job.Error)
+	default:
+		err = h.tgClint.SendMessage(ctx, chatID, msgJobLost)
+	}
+	if err != nil {
+		h.log.Error("cannot send job result", "job", id, "error", err)
+	}
+}
+
 func (h *Handler) sendOptimizationResults(ctx context.Context, chatId int64, result core.OptimizationResult) error {
 	msg := formatResultsHTML(result)
 	return h.tgClint.SendMessage(ctx, chatId, msg)
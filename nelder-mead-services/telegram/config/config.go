@@ -3,12 +3,16 @@ package config
 import (
 	"github.com/ilyakaznacheev/cleanenv"
 	"log"
+	"time"
 )
 
 type Config struct {
 	LogLevel  string `yaml:"log_level" env:"LOG_LEVEL" env-default:"DEBUG"`
 	TgToken   string `yaml:"tg_token" env:"TG_TOKEN"`
 	APIClient string `yaml:"api_client" env:"API_CLIENT"`
+
+	// Наибольший интервал опроса фоновой задачи
+	PollInterval time.Duration `yaml:"poll_interval" env:"POLL_INTERVAL" env-default:"2s"`
 }
 
 func MustLoad(configPath string) Config {
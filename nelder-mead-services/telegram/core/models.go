@@ -8,6 +8,19 @@ type OptimizationResult struct {
 	FunctionValue float64 `json:"function_value"`
 }
 
+// Job - фоновая задача оптимизации в API: queued, running, done, failed,
+// cancelled. Result задан для done и для cancelled с найденной к отмене точкой.
+type Job struct {
+	ID     string              `json:"id"`
+	State  string              `json:"state"`
+	Result *OptimizationResult `json:"result"`
+	Error  string              `json:"error"`
+}
+
+func (j Job) Finished() bool {
+	return j.State == "done" || j.State == "failed" || j.State == "cancelled"
+}
+
 type TelegramUpdate struct {
 	UpdateID int64            `json:"update_id"`
 	Message  *TelegramMessage `json:"message"`
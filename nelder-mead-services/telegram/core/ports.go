@@ -4,6 +4,9 @@ import "context"
 
 type APIClient interface {
 	Optimization(ctx context.Context, function string, tolerance float64, iter int) (OptimizationResult, error)
+	SubmitJob(ctx context.Context, function string, tolerance float64, iter int) (Job, error)
+	Job(ctx context.Context, id string) (Job, error)
+	CancelJob(ctx context.Context, id string) (Job, error)
 }
 
 type TelegramClient interface {
@@ -35,7 +35,7 @@ func main() {
 	tgClient := telegram.NewBotClient(tgToken)
 	apiClient := api.New("http://"+cfg.APIClient, log)
 
-	handler := rest.New(apiClient, tgClient, log)
+	handler := rest.New(apiClient, tgClient, log, cfg.PollInterval)
 
 	ctx, cancel := signal.NotifyContext(
 		context.Background(),
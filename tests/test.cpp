@@ -1,6 +1,18 @@
 #include "C:\Users\adsim\for work and studing\projects\nelder-mead\nelder_mead.h"
 #include "pch.h"
+#include "../nelder-mead-services/optimization/core/expression.h"
+#include "../nelder-mead-services/optimization/core/decomposition.h"
+#include "../nelder-mead-services/optimization/core/polish.h"
+#include "../nelder-mead-services/optimization/core/branch_bound.h"
+#include "../nelder-mead-services/optimization/core/racing.h"
+#include "../nelder-mead-services/optimization/core/screen.h"
+#include "../nelder-mead-services/optimization/core/worker_pool.h"
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <iostream>
 #include <iomanip>
@@ -221,6 +233,785 @@ TEST_F(NelderMeadTest, NearOptimumStart) {
     run_optimization_test(" ( )", quadratic, expected, initial, 1e-8);
 }
 
+TEST_F(NelderMeadTest, IncrementalExpressionEvaluation) {
+    char error[128] = { 0 };
+    ExprProgram* program = expr_compile(
+        "(x1-1)^2 + (x2-x1)^2*100 + sin(x3)*x4 + (x5+2)^2 - x3/x5", error, sizeof(error));
+    ASSERT_NE(program, nullptr) << error;
+    ASSERT_EQ(expr_dimension(program), 5);
+
+    ExprEvaluator* base = expr_evaluator_create(program);
+    ExprEvaluator* full = expr_evaluator_create(program);
+
+    double x0[] = { 1.0, 1.0, 1.0, 1.0, 1.0 };
+    expr_objective(x0, 5, base);
+
+    //      x0  
+    for (int i = 0; i < 5; ++i) {
+        double x[5];
+        std::copy(x0, x0 + 5, x);
+        x[i] *= 1.05;
+        double delta_value = expr_objective_delta(x, 5, &i, 1, base);
+        EXPECT_NEAR(delta_value, expr_objective(x, 5, full), 1e-12) << " " << i;
+    }
+
+    double x[] = { 0.5, 2.0, 1.0, -1.0, 3.0 };
+    int changed[] = { 0, 1, 3, 4 };
+    EXPECT_NEAR(expr_objective_delta(x, 5, changed, 4, base), expr_objective(x, 5, full), 1e-12);
+
+    double x_inc[] = { 1.0, 1.0, 1.0, 1.0, 1.0 };
+    double x_ref[] = { 1.0, 1.0, 1.0, 1.0, 1.0 };
+    double value_inc = 0.0, value_ref = 0.0;
+    EXPECT_EQ(nelder_mead_optimize_incremental(expr_objective, expr_objective_delta, x_inc, 5, &params, base, &value_inc), 0);
+    EXPECT_EQ(nelder_mead_optimize(expr_objective, x_ref, 5, &params, full, &value_ref), 0);
+    EXPECT_NEAR(value_inc, value_ref, 1e-6);
+
+    expr_evaluator_free(base);
+    expr_evaluator_free(full);
+    expr_program_free(program);
+}
+
+TEST_F(NelderMeadTest, SeparableDecomposition) {
+    //    
+    const char* source =
+        "(x1-1)^2 + (x2-x1)^2 + (x3-2)^2 + (x4-x3)^2 + (x5-3)^2 + (x6-x5)^2 +"
+        "(x7+1)^2 + (x8-x7)^2 + (x9+2)^2 + (x10-x9)^2";
+    char error[128] = { 0 };
+    ExprProgram* program = expr_compile(source, error, sizeof(error));
+    ASSERT_NE(program, nullptr) << error;
+    EXPECT_EQ(expr_component_count(program), 5);
+
+    double x[10];
+    std::fill(x, x + 10, 1.0);
+    double final_value = 0.0;
+    EXPECT_EQ(nelder_mead_optimize_separable(program, x, 10, &params, &final_value), 0);
+
+    const double expected[] = { 1, 1, 2, 2, 3, 3, -1, -1, -2, -2 };
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_NEAR(x[i], expected[i], 1e-2) << "x" << i + 1;
+    }
+    EXPECT_NEAR(final_value, 0.0, 1e-4);
+
+    expr_program_free(program);
+}
+
+TEST_F(NelderMeadTest, BlockCoordinateChainedRosenbrock) {
+    //   :  i   x_i  x_{i+1}
+    const int n = 20;
+    std::ostringstream source;
+    for (int i = 1; i < n; ++i) {
+        if (i > 1) source << " + ";
+        source << "100*(x" << i + 1 << "-x" << i << "^2)^2 + (1-x" << i << ")^2";
+    }
+    char error[128] = { 0 };
+    ExprProgram* program = expr_compile(source.str().c_str(), error, sizeof(error));
+    ASSERT_NE(program, nullptr) << error;
+    EXPECT_EQ(expr_component_count(program), 1);
+    EXPECT_EQ(expr_max_term_variables(program), 2);
+
+    double x[n] = { 0 };
+    double final_value = 0.0;
+    params.tolerance = 1e-12;
+    BlockParams block_params = create_default_block_params();
+    block_params.max_sweeps = 2000;
+    EXPECT_EQ(nelder_mead_optimize_blocks(program, x, n, &params, &block_params, &final_value), 0);
+
+    std::cout << "  : " << final_value << "\n";
+    EXPECT_LT(final_value, 1e-2);
+    EXPECT_NEAR(x[0], 1.0, 1e-2);
+
+    expr_program_free(program);
+}
+
+TEST_F(NelderMeadTest, IndexedSumConstructs) {
+    //           
+    char error[128] = { 0 };
+    ExprProgram* loop = expr_compile("sum(i, 1, 9, 100*(x[i+1]-x[i]^2)^2 + (1-x[i])^2)", error, sizeof(error));
+    ASSERT_NE(loop, nullptr) << error;
+    std::ostringstream unrolled_source;
+    for (int i = 1; i < 10; ++i) {
+        if (i > 1) unrolled_source << " + ";
+        unrolled_source << "100*(x" << i + 1 << "-x" << i << "^2)^2 + (1-x" << i << ")^2";
+    }
+    ExprProgram* unrolled = expr_compile(unrolled_source.str().c_str(), error, sizeof(error));
+    ASSERT_NE(unrolled, nullptr) << error;
+    ASSERT_EQ(expr_dimension(loop), 10);
+    EXPECT_LT(expr_node_count(loop), expr_node_count(unrolled));
+    EXPECT_EQ(expr_max_term_variables(loop), 2);
+
+    //       ,    
+    double x_loop[10], x_unrolled[10];
+    for (int i = 0; i < 10; ++i) {
+        x_loop[i] = 0.1 * std::atoi(expr_variable_name(loop, i) + 1) - 0.3;
+        x_unrolled[i] = 0.1 * std::atoi(expr_variable_name(unrolled, i) + 1) - 0.3;
+    }
+    ExprEvaluator* base = expr_evaluator_create(loop);
+    ExprEvaluator* full = expr_evaluator_create(unrolled);
+    double value = expr_objective(x_loop, 10, base);
+    EXPECT_NEAR(value, expr_objective(x_unrolled, 10, full), 1e-9);
+
+    ExprEvaluator* check = expr_evaluator_create(loop);
+    for (int i = 0; i < 10; ++i) {
+        double x[10];
+        std::copy(x_loop, x_loop + 10, x);
+        x[i] += 0.25;
+        EXPECT_NEAR(expr_objective_delta(x, 10, &i, 1, base), expr_objective(x, 10, check), 1e-9) << " " << i;
+    }
+
+    //    
+    ExprProgram* nested = expr_compile("prod(i, 1, 3, x[i]) + sum(i, 1, 2, sum(j, 1, 2, j*x[i]*x[j+2]))", error, sizeof(error));
+    ASSERT_NE(nested, nullptr) << error;
+    ExprProgram* nested_unrolled = expr_compile("x1*x2*x3 + x1*x3 + 2*x1*x4 + x2*x3 + 2*x2*x4", error, sizeof(error));
+    ASSERT_NE(nested_unrolled, nullptr) << error;
+    ExprEvaluator* nested_eval = expr_evaluator_create(nested);
+    ExprEvaluator* nested_ref = expr_evaluator_create(nested_unrolled);
+    double y[] = { 0.5, -1.5, 2.0, 3.0 };
+    EXPECT_NEAR(expr_objective(y, 4, nested_eval), expr_objective(y, 4, nested_ref), 1e-12);
+
+    EXPECT_EQ(expr_compile("sum(i, 1, x1, x[i])", error, sizeof(error)), nullptr);
+    EXPECT_EQ(expr_compile("sum(i, 1, 3, x[i/2])", error, sizeof(error)), nullptr);
+
+    //       
+    ExprProgram* separable = expr_compile("sum(i, 1, 6, (x[i]-i)^2)", error, sizeof(error));
+    ASSERT_NE(separable, nullptr) << error;
+    EXPECT_EQ(expr_component_count(separable), 6);
+    double z[6] = { 0 };
+    double final_value = 0.0;
+    EXPECT_EQ(nelder_mead_optimize_separable(separable, z, 6, &params, &final_value), 0);
+    for (int i = 0; i < 6; ++i) {
+        EXPECT_NEAR(z[i], std::atoi(expr_variable_name(separable, i) + 1), 1e-2);
+    }
+
+    expr_evaluator_free(base);
+    expr_evaluator_free(full);
+    expr_evaluator_free(check);
+    expr_evaluator_free(nested_eval);
+    expr_evaluator_free(nested_ref);
+    expr_program_free(loop);
+    expr_program_free(unrolled);
+    expr_program_free(nested);
+    expr_program_free(nested_unrolled);
+    expr_program_free(separable);
+}
+
+TEST_F(NelderMeadTest, CompiledExpressionCache) {
+    expr_cache_configure(2, 1 << 20);
+    ExprCacheStats before = expr_cache_stats();
+
+    // ,    ,      
+    char error[128] = { 0 };
+    ExprProgram* first = expr_compile_cached("(x1 - 2)^2 + 3*x2*x2", error, sizeof(error));
+    ASSERT_NE(first, nullptr) << error;
+    ExprProgram* second = expr_compile_cached("x2*x2*3.0+(X1-2.)^2", error, sizeof(error));
+    ASSERT_NE(second, nullptr) << error;
+    ExprCacheStats after = expr_cache_stats();
+    EXPECT_EQ(after.misses - before.misses, 1);
+    EXPECT_EQ(after.hits - before.hits, 1);
+    EXPECT_STREQ(expr_variable_name(second, 0), "x1");
+
+    //    ,     
+    expr_program_free(expr_compile_cached("x1 + x2", error, sizeof(error)));
+    expr_program_free(expr_compile_cached("x1 * x2", error, sizeof(error)));
+    after = expr_cache_stats();
+    EXPECT_EQ(after.entries, 2);
+    EXPECT_GE(after.evictions - before.evictions, 1);
+
+    ExprEvaluator* evaluator = expr_evaluator_create(first);
+    double x[] = { 2.0, 1.0 };
+    EXPECT_DOUBLE_EQ(expr_objective(x, 2, evaluator), 3.0);
+    expr_evaluator_free(evaluator);
+
+    EXPECT_EQ(expr_compile_cached("x1 + ", error, sizeof(error)), nullptr);
+
+    expr_program_free(first);
+    expr_program_free(second);
+    expr_cache_configure(256, 1 << 20);
+}
+
+TEST_F(NelderMeadTest, GradientPolish) {
+    char error[128] = { 0 };
+    ExprProgram* program = expr_compile(
+        "(x1-2)^2*exp(x3/4) + sin(x2)*x3 + sqrt(x1^2+1)/x4 + log(x4) + sum(i, 1, 3, (x[i+1]-x[i]^2)^2)",
+        error, sizeof(error));
+    ASSERT_NE(program, nullptr) << error;
+    ASSERT_EQ(expr_dimension(program), 4);
+    ExprEvaluator* evaluator = expr_evaluator_create(program);
+
+    //      ,  -   
+    double x[] = { 0.7, -1.2, 0.4, 1.5 };
+    double gradient[4];
+    double value = expr_objective_gradient(x, 4, gradient, evaluator);
+    EXPECT_DOUBLE_EQ(value, expr_objective(x, 4, evaluator));
+    for (int i = 0; i < 4; ++i) {
+        const double h = 1e-6;
+        double plus[4], minus[4];
+        std::copy(x, x + 4, plus);
+        std::copy(x, x + 4, minus);
+        plus[i] += h;
+        minus[i] -= h;
+        double numeric = (expr_objective(plus, 4, evaluator) - expr_objective(minus, 4, evaluator)) / (2 * h);
+        EXPECT_NEAR(gradient[i], numeric, 1e-6 * (1.0 + fabs(numeric))) << "x" << i + 1;
+    }
+    double direction[] = { 0.5, -1.0, 2.0, 0.25 };
+    double derivative = 0.0;
+    expr_objective_directional(x, 4, direction, &derivative, evaluator);
+    double expected = 0.0;
+    for (int i = 0; i < 4; ++i) expected += gradient[i] * direction[i];
+    EXPECT_NEAR(derivative, expected, 1e-12 * (1.0 + fabs(expected)));
+    expr_evaluator_free(evaluator);
+    expr_program_free(program);
+
+    //   ,   NearOptimumStart:       
+    ExprProgram* quadratic = expr_compile("(x1-2)^2 + (x2-3)^2", error, sizeof(error));
+    ASSERT_NE(quadratic, nullptr) << error;
+    ExprEvaluator* quadratic_evaluator = expr_evaluator_create(quadratic);
+    double point[] = { 2.1, 2.9 };
+    double final_value = 0.0;
+    params.tolerance = 1e-4;
+    PolishParams polish_params = create_default_polish_params();
+    EXPECT_EQ(nelder_mead_optimize_polished(expr_objective, expr_objective_gradient, point, 2,
+                                            &params, &polish_params, quadratic_evaluator, &final_value), 0);
+    EXPECT_NEAR(point[0], 2.0, 1e-8);
+    EXPECT_NEAR(point[1], 3.0, 1e-8);
+    EXPECT_LT(final_value, 1e-16);
+    expr_evaluator_free(quadratic_evaluator);
+    expr_program_free(quadratic);
+
+    // :   ,      
+    ExprProgram* rosenbrock = expr_compile("sum(i, 1, 5, 100*(x[i+1]-x[i]^2)^2 + (1-x[i])^2)", error, sizeof(error));
+    ASSERT_NE(rosenbrock, nullptr) << error;
+    ExprEvaluator* rosenbrock_evaluator = expr_evaluator_create(rosenbrock);
+    double start[6] = { 0.5, 0.5, 0.5, 0.5, 0.5, 0.5 };
+    EXPECT_EQ(nelder_mead_optimize(expr_objective, start, 6, &params, rosenbrock_evaluator, &final_value), 0);
+    double coarse = final_value;
+    EXPECT_EQ(lbfgs_polish(expr_objective_gradient, expr_objective_directional, start, 6,
+                           &polish_params, rosenbrock_evaluator, &final_value), 0);
+    EXPECT_LE(final_value, coarse);
+    for (int i = 0; i < 6; ++i) EXPECT_NEAR(start[i], 1.0, 1e-6);
+    expr_evaluator_free(rosenbrock_evaluator);
+    expr_program_free(rosenbrock);
+}
+
+TEST_F(NelderMeadTest, BranchAndBoundRastrigin) {
+    //  :      
+    char error[128] = { 0 };
+    ExprProgram* program = expr_compile(
+        "sum(i, 1, 3, x[i]^2 - 10*cos(2*pi*x[i])) + 30", error, sizeof(error));
+    ASSERT_NE(program, nullptr) << error;
+
+    double lower[] = { -4.3, -3.1, -5.0 };
+    double upper[] = { 6.1, 5.7, 4.2 };
+    double x[] = { 3.9, -2.2, 2.1 };
+    double final_value = 0.0;
+    BranchBoundParams bb_params = create_default_branch_bound_params();
+    EXPECT_EQ(nelder_mead_optimize_branch_bound(program, x, 3, lower, upper, &params, &bb_params, &final_value), 0);
+
+    std::cout << "  : " << final_value << "\n";
+    EXPECT_LT(final_value, 1e-3);
+    for (int i = 0; i < 3; ++i) EXPECT_NEAR(x[i], 0.0, 1e-2);
+
+    //  :          
+    ExprEvaluator* evaluator = expr_evaluator_create(program);
+    double local[] = { 3.9, -2.2, 2.1 };
+    double local_value = 0.0;
+    nelder_mead_optimize(expr_objective, local, 3, &params, evaluator, &local_value);
+    EXPECT_GT(local_value, 1.0);
+
+    expr_evaluator_free(evaluator);
+    expr_program_free(program);
+}
+
+
+static std::atomic<int> pool_jobs_done(0);
+
+static void count_job(OptimizationJob* job) {
+    ++pool_jobs_done;
+}
+
+TEST_F(NelderMeadTest, WorkerPoolJobs) {
+    char error[128] = { 0 };
+    ExprProgram* program = expr_compile("(x1-3)^2 + (x2+1)^2 + x1*x2/10", error, sizeof(error));
+    ASSERT_NE(program, nullptr) << error;
+
+    WorkerPoolParams pool_params = create_default_worker_pool_params();
+    pool_params.workers = 3;
+    pool_params.queue_limit = 64;
+    WorkerPool* pool = worker_pool_create(&pool_params);
+    ASSERT_NE(pool, nullptr);
+    EXPECT_EQ(worker_pool_size(pool), 3);
+    EXPECT_GE(available_cpus(), 1);
+
+    const int jobs = 32;
+    std::vector<OptimizationJob> batch(jobs);
+    std::vector<std::vector<double>> points(jobs);
+    pool_jobs_done = 0;
+    for (int k = 0; k < jobs; ++k) {
+        points[k] = { 1.0 + k, -1.0 - k };
+        OptimizationJob& job = batch[k];
+        job = OptimizationJob();
+        job.program = program;
+        job.x = points[k].data();
+        job.mode = JOB_INCREMENTAL;
+        job.params = params;
+        job.polish = k % 2;
+        job.polish_params = create_default_polish_params();
+        job.tag = k;
+        ASSERT_EQ(worker_pool_submit(pool, &job, count_job), 0);
+    }
+
+    //      
+    worker_pool_free(pool);
+    EXPECT_EQ(pool_jobs_done.load(), jobs);
+
+    ExprEvaluator* evaluator = expr_evaluator_create(program);
+    double expected[] = { 1.0, 1.0 };
+    double expected_value = 0.0;
+    nelder_mead_optimize(expr_objective, expected, 2, &params, evaluator, &expected_value);
+    for (int k = 0; k < jobs; ++k) {
+        EXPECT_EQ(batch[k].status, 0);
+        EXPECT_NEAR(batch[k].final_value, expected_value, 1e-5);
+        EXPECT_LE(batch[k].final_value, batch[k].unpolished_value);
+    }
+
+    expr_evaluator_free(evaluator);
+    expr_program_free(program);
+}
+
+static std::mutex fan_out_mutex;
+static std::vector<std::thread::id> fan_out_threads;
+static std::atomic<int> fan_out_parts(0);
+static int fan_out_limit = 0;
+
+//        (done   )
+static void fan_out(OptimizationJob* job) {
+    const int parts = 8;
+    fan_out_limit = worker_pool_parallelism(parts);
+    std::atomic<int> next(0);
+    worker_pool_parallel(parts, [&](int) {
+        for (int k = next++; k < parts; k = next++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            ++fan_out_parts;
+            std::lock_guard<std::mutex> lock(fan_out_mutex);
+            if (std::find(fan_out_threads.begin(), fan_out_threads.end(), std::this_thread::get_id()) == fan_out_threads.end()) {
+                fan_out_threads.push_back(std::this_thread::get_id());
+            }
+        }
+    });
+}
+
+TEST_F(NelderMeadTest, PoolParallelism) {
+    char error[128] = { 0 };
+    ExprProgram* program = expr_compile("(x1-1)^2 + (x2+1)^2", error, sizeof(error));
+    ASSERT_NE(program, nullptr) << error;
+
+    WorkerPoolParams pool_params = create_default_worker_pool_params();
+    pool_params.workers = 3;
+    WorkerPool* pool = worker_pool_create(&pool_params);
+    ASSERT_NE(pool, nullptr);
+    EXPECT_EQ(worker_pool_parallelism(8), std::min(8, available_cpus()));
+
+    std::vector<double> x(2, 0.0);
+    OptimizationJob job = OptimizationJob();
+    job.program = program;
+    job.x = x.data();
+    job.params = params;
+    fan_out_threads.clear();
+    fan_out_parts = 0;
+    //    
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_EQ(worker_pool_submit(pool, &job, fan_out), 0);
+    while (fan_out_parts < 8) std::this_thread::yield();
+    worker_pool_free(pool);
+
+    //      ,     
+    EXPECT_EQ(fan_out_limit, 3);
+    EXPECT_EQ(fan_out_parts.load(), 8);
+    EXPECT_GT(fan_out_threads.size(), 1u);
+    EXPECT_LE(fan_out_threads.size(), 3u);
+
+    expr_program_free(program);
+}
+
+TEST_F(NelderMeadTest, WorkerPoolAdmission) {
+    char error[128] = { 0 };
+    ExprProgram* program = expr_compile("(x1-1)^2 + (x2-2)^2 + (x3-3)^2", error, sizeof(error));
+    ASSERT_NE(program, nullptr) << error;
+
+    std::vector<double> cheap_x(3, 0.0), costly_x(3, 0.0), rejected_x(3, 0.0);
+    OptimizationJob cheap = OptimizationJob();
+    cheap.program = program;
+    cheap.x = cheap_x.data();
+    cheap.params = params;
+    cheap.params.max_iter = 100;
+    OptimizationJob costly = cheap;
+    costly.x = costly_x.data();
+    costly.params.max_iter = 10000;
+    OptimizationJob rejected = cheap;
+    rejected.x = rejected_x.data();
+    rejected.params.max_iter = 1000000;
+
+    double cheap_cost = worker_pool_job_cost(&cheap);
+    EXPECT_GT(cheap_cost, 0.0);
+    EXPECT_DOUBLE_EQ(worker_pool_job_cost(&costly), cheap_cost * 100);
+
+    WorkerPoolParams pool_params = create_default_worker_pool_params();
+    pool_params.workers = 1;
+    pool_params.defer_cost = cheap_cost * 10;
+    pool_params.max_job_cost = cheap_cost * 1000;
+    WorkerPool* pool = worker_pool_create(&pool_params);
+    ASSERT_NE(pool, nullptr);
+
+    EXPECT_EQ(worker_pool_submit(pool, &cheap, nullptr), 0);
+    EXPECT_EQ(worker_pool_submit(pool, &costly, nullptr), 0);
+    EXPECT_EQ(worker_pool_submit(pool, &rejected, nullptr), -2);
+    EXPECT_EQ(cheap.priority, JOB_INTERACTIVE);
+    EXPECT_EQ(costly.priority, JOB_BATCH);
+
+    worker_pool_free(pool);
+    expr_program_free(program);
+    EXPECT_NEAR(costly_x[2], 3.0, 1e-3);
+    EXPECT_EQ(rejected_x[2], 0.0);
+}
+
+static std::mutex completion_mutex;
+static std::vector<uintptr_t> completion_order;
+
+static void record_completion(OptimizationJob* job) {
+    std::lock_guard<std::mutex> lock(completion_mutex);
+    completion_order.push_back(job->tag);
+}
+
+TEST_F(NelderMeadTest, PreemptibleJobs) {
+    char error[128] = { 0 };
+    ExprProgram* long_program = expr_compile(
+        "sum(i, 1, 29, 100*(x[i+1] - x[i]^2)^2 + (1 - x[i])^2)", error, sizeof(error));
+    ASSERT_NE(long_program, nullptr) << error;
+    ExprProgram* short_program = expr_compile("(x1-1)^2 + (x2+1)^2", error, sizeof(error));
+    ASSERT_NE(short_program, nullptr) << error;
+
+    OptimizationParams long_params = params;
+    long_params.tolerance = 0.0;
+    long_params.max_iter = 20000;
+
+    // :     
+    std::vector<double> reference(30, 0.5);
+    double reference_value = 0.0;
+    ExprEvaluator* evaluator = expr_evaluator_create(long_program);
+    nelder_mead_optimize_incremental(expr_objective, expr_objective_delta, reference.data(), 30,
+                                     &long_params, evaluator, &reference_value);
+    expr_evaluator_free(evaluator);
+
+    WorkerPoolParams pool_params = create_default_worker_pool_params();
+    pool_params.workers = 1;
+    pool_params.defer_cost = 0.0;
+    pool_params.time_slice = 1e-4;
+    WorkerPool* pool = worker_pool_create(&pool_params);
+    ASSERT_NE(pool, nullptr);
+
+    completion_order.clear();
+    std::vector<double> long_x(30, 0.5);
+    OptimizationJob long_job = OptimizationJob();
+    long_job.program = long_program;
+    long_job.x = long_x.data();
+    long_job.params = long_params;
+    long_job.tag = 0;
+    ASSERT_EQ(worker_pool_submit(pool, &long_job, record_completion), 0);
+
+    const int shorts = 8;
+    std::vector<OptimizationJob> short_jobs(shorts);
+    std::vector<std::vector<double>> short_x(shorts, std::vector<double>(2, 0.0));
+    for (int k = 0; k < shorts; ++k) {
+        short_jobs[k] = OptimizationJob();
+        short_jobs[k].program = short_program;
+        short_jobs[k].x = short_x[k].data();
+        short_jobs[k].params = params;
+        short_jobs[k].tag = k + 1;
+        ASSERT_EQ(worker_pool_submit(pool, &short_jobs[k], record_completion), 0);
+    }
+
+    worker_pool_free(pool);
+    ASSERT_EQ(completion_order.size(), static_cast<size_t>(shorts + 1));
+
+    //      ,     
+    EXPECT_EQ(completion_order.back(), 0u);
+    EXPECT_EQ(long_job.status, 0);
+    EXPECT_EQ(long_job.final_value, reference_value);
+    for (int i = 0; i < 30; ++i) EXPECT_EQ(long_x[i], reference[i]);
+    for (int k = 0; k < shorts; ++k) EXPECT_NEAR(short_jobs[k].final_value, 0.0, 1e-5);
+
+    //           
+    pool = worker_pool_create(&pool_params);
+    ASSERT_NE(pool, nullptr);
+    completion_order.clear();
+    std::fill(long_x.begin(), long_x.end(), 0.5);
+    ASSERT_EQ(worker_pool_submit(pool, &long_job, record_completion), 0);
+    std::vector<double> background_x(2, 0.0);
+    OptimizationJob background = OptimizationJob();
+    background.program = short_program;
+    background.x = background_x.data();
+    background.params = params;
+    background.priority = JOB_BATCH;
+    background.tag = 1;
+    ASSERT_EQ(worker_pool_submit(pool, &background, record_completion), 0);
+
+    worker_pool_free(pool);
+    ASSERT_EQ(completion_order.size(), 2u);
+    EXPECT_EQ(completion_order.front(), 0u);
+    EXPECT_EQ(long_job.final_value, reference_value);
+    EXPECT_NEAR(background.final_value, 0.0, 1e-5);
+
+    expr_program_free(short_program);
+    expr_program_free(long_program);
+}
+
+TEST_F(NelderMeadTest, LaneBatch) {
+    char error[128] = { 0 };
+    ExprProgram* programs[2] = {
+        expr_compile("(x1-1)^2 + 3*(x2+2)^2", error, sizeof(error)),
+        expr_compile("100*(x2-x1^2)^2 + (1-x1)^2", error, sizeof(error))
+    };
+    ASSERT_NE(programs[0], nullptr) << error;
+    ASSERT_NE(programs[1], nullptr) << error;
+
+    const int lanes = 6;
+    std::vector<OptimizationJob> jobs(lanes);
+    std::vector<std::vector<double>> points(lanes);
+    for (int k = 0; k < lanes; ++k) {
+        points[k] = { 0.5 * k, -0.25 * k };
+        jobs[k] = OptimizationJob();
+        jobs[k].program = programs[k % 2];
+        jobs[k].x = points[k].data();
+        jobs[k].params = params;
+        jobs[k].tag = k;
+        jobs[k].next = k + 1 < lanes ? &jobs[k + 1] : nullptr;
+    }
+
+    WorkerPoolParams pool_params = create_default_worker_pool_params();
+    pool_params.workers = 1;
+    WorkerPool* pool = worker_pool_create(&pool_params);
+    ASSERT_NE(pool, nullptr);
+    completion_order.clear();
+    ASSERT_EQ(worker_pool_submit_batch(pool, &jobs[0], record_completion), 0);
+    WorkerPoolStats stats;
+    do {
+        std::this_thread::yield();
+        stats = worker_pool_stats(pool);
+    } while (stats.completed < lanes);
+    EXPECT_EQ(stats.batches, 1);
+    EXPECT_EQ(stats.admitted, lanes);
+    worker_pool_free(pool);
+    EXPECT_EQ(completion_order.size(), static_cast<size_t>(lanes));
+
+    //       ,    
+    for (int k = 0; k < lanes; ++k) {
+        ExprEvaluator* evaluator = expr_evaluator_create(programs[k % 2]);
+        double x[] = { 0.5 * k, -0.25 * k };
+        double value = 0.0;
+        nelder_mead_optimize_incremental(expr_objective, expr_objective_delta, x, 2, &params, evaluator, &value);
+        EXPECT_EQ(jobs[k].status, 0);
+        EXPECT_EQ(jobs[k].final_value, value);
+        EXPECT_EQ(points[k][0], x[0]);
+        EXPECT_EQ(points[k][1], x[1]);
+        expr_evaluator_free(evaluator);
+    }
+
+    expr_program_free(programs[0]);
+    expr_program_free(programs[1]);
+}
+
+struct ProgressLog {
+    std::vector<NelderMeadProgress> reports;
+    double stop_below;
+};
+
+int record_progress(const NelderMeadProgress* progress, void* context) {
+    ProgressLog* log = static_cast<ProgressLog*>(context);
+    log->reports.push_back(*progress);
+    return progress->best_value < log->stop_below;
+}
+
+//      
+double observed_run(ExprEvaluator* evaluator, double* x, int n, const OptimizationParams& params, const ProgressParams& progress) {
+    NelderMeadState* state = nelder_mead_start(expr_objective, expr_objective_delta, x, n, &params, evaluator);
+    nelder_mead_observe(state, &progress);
+    while (!nelder_mead_step(state, params.max_iter)) {
+    }
+    double value = nelder_mead_best(state, x);
+    nelder_mead_free(state);
+    return value;
+}
+
+TEST_F(NelderMeadTest, ProgressHook) {
+    char error[128] = { 0 };
+    ExprProgram* program = expr_compile("100*(x2-x1^2)^2 + (1-x1)^2", error, sizeof(error));
+    ASSERT_NE(program, nullptr) << error;
+    ExprEvaluator* evaluator = expr_evaluator_create(program);
+    params.tolerance = 1e-12;
+
+    double plain[] = { -1.2, 1.0 };
+    double plain_value = 0.0;
+    nelder_mead_optimize_incremental(expr_objective, expr_objective_delta, plain, 2, &params, evaluator, &plain_value);
+
+    //     
+    ProgressLog log;
+    log.stop_below = -1.0;
+    ProgressParams observer = { record_progress, &log, 10 };
+    double x[] = { -1.2, 1.0 };
+    double value = observed_run(evaluator, x, 2, params, observer);
+    EXPECT_EQ(value, plain_value);
+    EXPECT_EQ(x[0], plain[0]);
+    EXPECT_EQ(x[1], plain[1]);
+    ASSERT_FALSE(log.reports.empty());
+    for (size_t i = 0; i < log.reports.size(); ++i) {
+        EXPECT_EQ(log.reports[i].iteration, 10 * static_cast<int>(i + 1));
+        if (i > 0) {
+            EXPECT_LE(log.reports[i].best_value, log.reports[i - 1].best_value);
+            EXPECT_GT(log.reports[i].evaluations, log.reports[i - 1].evaluations);
+        }
+    }
+
+    //      
+    ProgressLog early;
+    early.stop_below = 1e-2;
+    observer.context = &early;
+    double y[] = { -1.2, 1.0 };
+    value = observed_run(evaluator, y, 2, params, observer);
+    ASSERT_FALSE(early.reports.empty());
+    EXPECT_LT(value, 1e-2);
+    EXPECT_EQ(value, early.reports.back().best_value);
+    EXPECT_LT(early.reports.size(), log.reports.size());
+
+    expr_evaluator_free(evaluator);
+    expr_program_free(program);
+}
+
+int snapshot_at_200(const NelderMeadProgress* progress, void* context) {
+    if (progress->iteration != 200) return 0;
+    std::vector<double>* snapshot = static_cast<std::vector<double>*>(context);
+    nelder_mead_snapshot(progress->state, snapshot->data());
+    return 1;
+}
+
+TEST_F(NelderMeadTest, SnapshotResume) {
+    char error[128] = { 0 };
+    ExprProgram* program = expr_compile("100*(x2-x1^2)^2 + (1-x1)^2 + (x3-2)^2", error, sizeof(error));
+    ASSERT_NE(program, nullptr) << error;
+    ExprEvaluator* evaluator = expr_evaluator_create(program);
+    params.tolerance = 1e-12;
+
+    double plain[] = { -1.2, 1.0, 0.0 };
+    double plain_value = 0.0;
+    nelder_mead_optimize_incremental(expr_objective, expr_objective_delta, plain, 3, &params, evaluator, &plain_value);
+
+    //    200-    
+    std::vector<double> snapshot(nelder_mead_snapshot_size(3));
+    ProgressParams interrupt = { snapshot_at_200, &snapshot, 1 };
+    double x[] = { -1.2, 1.0, 0.0 };
+    observed_run(evaluator, x, 3, params, interrupt);
+    EXPECT_EQ(snapshot[0], 200);
+
+    //         ,    
+    double resumed[] = { 0.0, 0.0, 0.0 };
+    OptimizationJob job = OptimizationJob();
+    job.program = program;
+    job.x = resumed;
+    job.params = params;
+    job.snapshot = snapshot.data();
+
+    WorkerPoolParams pool_params = create_default_worker_pool_params();
+    pool_params.workers = 1;
+    WorkerPool* pool = worker_pool_create(&pool_params);
+    ASSERT_NE(pool, nullptr);
+    completion_order.clear();
+    ASSERT_EQ(worker_pool_submit(pool, &job, record_completion), 0);
+    worker_pool_free(pool);
+    ASSERT_EQ(completion_order.size(), 1u);
+    EXPECT_EQ(job.status, 0);
+    EXPECT_EQ(job.final_value, plain_value);
+    for (int i = 0; i < 3; ++i) EXPECT_EQ(resumed[i], plain[i]);
+
+    expr_evaluator_free(evaluator);
+    expr_program_free(program);
+}
+
+//     :    
+//   ,   
+double evaluations_to_solution(ExprProgram* program, int n, const RacingParams& race, const OptimizationParams& params) {
+    double lower[] = { -5.12, -5.12, -5.12 };
+    double upper[] = { 5.12, 5.12, 5.12 };
+    long long evaluations = 0;
+    int solved = 0;
+    for (unsigned long long seed = 1; seed <= 20; ++seed) {
+        RacingParams seeded = race;
+        seeded.seed = seed;
+        OptimizationParams local = params;
+        double x[] = { 3.3, 3.3, 3.3 };
+        double value = 0.0;
+        RacingStats stats = RacingStats();
+        EXPECT_EQ(nelder_mead_optimize_racing(program, x, n, lower, upper, &local, &seeded, &value, &stats), 0);
+        evaluations += stats.evaluations;
+        if (value < 1e-3) ++solved;
+    }
+    return solved ? static_cast<double>(evaluations) / solved : std::numeric_limits<double>::infinity();
+}
+
+TEST_F(NelderMeadTest, RacingMultiStart) {
+    const char* functions[] = {
+        "sum(i, 1, 2, x[i]^2 - 10*cos(2*pi*x[i])) + 20",
+        "-20*exp(-0.2*sqrt(sum(i, 1, 3, x[i]^2)/3)) - exp(sum(i, 1, 3, cos(2*pi*x[i]))/3) + 20 + exp(1)",
+    };
+    const int dimensions[] = { 2, 3 };
+    params.tolerance = 1e-8;
+
+    for (int f = 0; f < 2; ++f) {
+        char error[128] = { 0 };
+        ExprProgram* program = expr_compile(functions[f], error, sizeof(error));
+        ASSERT_NE(program, nullptr) << error;
+
+        //  multi-start:   16      
+        RacingParams naive = create_default_racing_params();
+        naive.gap = -1.0;
+        naive.max_starts = naive.starts;
+        RacingParams racing = create_default_racing_params();
+
+        double naive_cost = evaluations_to_solution(program, dimensions[f], naive, params);
+        double racing_cost = evaluations_to_solution(program, dimensions[f], racing, params);
+        std::cout << "  " << functions[f] << ":    " << racing_cost
+                  << " ( multi-start " << naive_cost << ")\n";
+        EXPECT_LT(racing_cost, naive_cost);
+
+        expr_program_free(program);
+    }
+}
+
+TEST_F(NelderMeadTest, ScreenDesigns) {
+    char error[128] = { 0 };
+    ExprProgram* program = expr_compile("(x1-0.3)^2 + (x2+0.2)^2 + log(x3+1)", error, sizeof(error));
+    ASSERT_NE(program, nullptr) << error;
+
+    //      log:      
+    double lower[] = { -1.0, -1.0, -2.0 };
+    double upper[] = { 1.0, 1.0, 1.0 };
+    const int designs[] = { SCREEN_SOBOL, SCREEN_LATIN_HYPERCUBE };
+    for (int design : designs) {
+        ScreenParams screen = create_default_screen_params();
+        screen.design = design;
+        double points[8 * 3];
+        double values[8];
+        ASSERT_EQ(expr_screen(program, 3, lower, upper, &screen, 8, points, values), 8);
+        for (int i = 1; i < 8; ++i) EXPECT_LE(values[i - 1], values[i]);
+        for (int i = 0; i < 8; ++i) EXPECT_GT(points[i * 3 + 2], -1.0);
+        EXPECT_LT(values[0], -1.0);
+    }
+
+    //   k:   
+    ScreenParams small = create_default_screen_params();
+    small.samples = 4;
+    double points[8 * 3];
+    double values[8];
+    EXPECT_LE(expr_screen(program, 3, lower, upper, &small, 8, points, values), 4);
+    expr_program_free(program);
+}
 
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);